@@ -0,0 +1,98 @@
+#ifndef AUTO_EXPOSURE_H
+#define AUTO_EXPOSURE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader_c.h>
+
+#include <cmath>
+
+// The exposure buffer as the tone mapping shaders read it, a std140 uniform block:
+//     layout (std140) uniform AutoExposure { float adaptedExposure; float averageLuminance; };
+struct AutoExposureData {
+    float Exposure;
+    float AverageLuminance; // of the pixels between the percentiles, the exposure adapts towards Key / AverageLuminance
+    float Padding[2];
+};
+
+// Adapts the exposure to the brightness of an HDR color buffer without ever reading anything back to the CPU.
+// Every update, a first compute shader builds a 256 bin histogram of the buffer's log2 luminance, each work group
+// in shared memory before adding it to the global histogram. A single work group of a second compute shader then
+// averages the bins between the LowPercentile and HighPercentile (ignoring black pixels as well as the darkest
+// and brightest ones) and moves the exposure a step towards the one mapping that average to Key. The exposure
+// stays in a buffer, which the tone mapping reads as a uniform block.
+class AutoExposure
+{
+public:
+    float MinLogLuminance, MaxLogLuminance; // luminance range of the histogram, in log2
+    float LowPercentile, HighPercentile;    // fractions of the (non black) pixels the average is taken between
+    float Key;                              // exposed value of the average luminance
+    float AdaptationSpeed;                  // per second; the exposure covers 1 - e^-1 of the way in 1 / speed seconds
+
+    // constructor takes the sample's copies of the histogram and average compute shaders
+    // ------------------------------------------------------------------------
+    AutoExposure(const char *histogramPath, const char *averagePath)
+        : MinLogLuminance(-10.0f), MaxLogLuminance(6.0f), LowPercentile(0.5f), HighPercentile(0.95f), Key(0.18f),
+          AdaptationSpeed(1.5f), histogramShader(histogramPath), averageShader(averagePath), firstUpdate(true)
+    {
+        unsigned int bins[256] = { 0 };
+        glGenBuffers(1, &histogramBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(bins), bins, GL_DYNAMIC_COPY);
+        AutoExposureData data = { 1.0f, Key, { 0.0f, 0.0f } };
+        glGenBuffers(1, &exposureBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposureBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(data), &data, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        histogramShader.use();
+        histogramShader.setInt("hdrBuffer", 0);
+    }
+    void Delete()
+    {
+        glDeleteBuffers(1, &histogramBuffer);
+        glDeleteBuffers(1, &exposureBuffer);
+        glDeleteProgram(histogramShader.ID);
+        glDeleteProgram(averageShader.ID);
+    }
+    // measures hdrTexture and adapts the exposure; the first update sets it right away
+    // ------------------------------------------------------------------------
+    void Update(unsigned int hdrTexture, unsigned int width, unsigned int height, float deltaTime)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, histogramBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, exposureBuffer);
+
+        histogramShader.use();
+        histogramShader.setFloat("minLogLuminance", MinLogLuminance);
+        histogramShader.setFloat("inverseLogLuminanceRange", 1.0f / (MaxLogLuminance - MinLogLuminance));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hdrTexture);
+        glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        averageShader.use();
+        averageShader.setFloat("minLogLuminance", MinLogLuminance);
+        averageShader.setFloat("logLuminanceRange", MaxLogLuminance - MinLogLuminance);
+        averageShader.setFloat("lowPercentile", LowPercentile);
+        averageShader.setFloat("highPercentile", HighPercentile);
+        averageShader.setFloat("key", Key);
+        averageShader.setFloat("adaptation", firstUpdate ? 1.0f : 1.0f - std::exp(-deltaTime * AdaptationSpeed));
+        glDispatchCompute(1, 1, 1);
+        // the exposure is read as a uniform block, the histogram (cleared by the average shader) by the next update
+        glMemoryBarrier(GL_UNIFORM_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        firstUpdate = false;
+    }
+    // binds the exposure buffer for the tone mapping's AutoExposure uniform block
+    // ------------------------------------------------------------------------
+    void Bind(unsigned int uniformBlockBinding) const
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, uniformBlockBinding, exposureBuffer);
+    }
+
+private:
+    ComputeShader histogramShader, averageShader;
+    unsigned int histogramBuffer, exposureBuffer;
+    bool firstUpdate;
+};
+#endif
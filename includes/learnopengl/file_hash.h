@@ -0,0 +1,30 @@
+#ifndef FILE_HASH_H
+#define FILE_HASH_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Hashes the contents of source files, so the caches built from them on disk can tell whether they're stale
+class FileHash
+{
+public:
+    // 64 bit FNV-1a hash of a file's contents; 0 if the file can't be read
+    // ------------------------------------------------------------------------
+    static uint64_t Hash(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return 0;
+        uint64_t hash = 14695981039346656037ull;
+        char buffer[1 << 16];
+        while (file)
+        {
+            file.read(buffer, sizeof(buffer));
+            for (std::streamsize i = 0; i < file.gcount(); ++i)
+                hash = (hash ^ (unsigned char)buffer[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+#endif
@@ -0,0 +1,118 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Defines the g-buffer layouts used by the deferred samples
+enum GBuffer_Layout {
+    GBUFFER_STANDARD, // position (RGBA16F), normal (RGBA16F), albedo + specular (RGBA8) and depth
+    GBUFFER_COMPACT   // octahedral encoded normal (RG16), albedo + specular (RGBA8) and depth; position is reconstructed from depth
+};
+
+// A single render target of a g-buffer layout
+struct GBufferTarget {
+    const char  *Name;
+    GLenum       Attachment;
+    GLenum       InternalFormat;
+    GLenum       Format;
+    GLenum       Type;
+    unsigned int BytesPerPixel;
+};
+
+// A g-buffer framebuffer with its targets created from a layout descriptor, so the
+// geometry and lighting passes only have to agree on the layout to switch between them.
+class GBuffer
+{
+public:
+    unsigned int ID;
+    GBuffer_Layout Layout;
+    unsigned int Width, Height;
+    // texture of each target; Position is 0 in the compact layout
+    unsigned int Position, Normal, AlbedoSpec, Depth;
+
+    // constructor creates the framebuffer and all targets of the layout
+    // ------------------------------------------------------------------------
+    GBuffer(unsigned int width, unsigned int height, GBuffer_Layout layout = GBUFFER_STANDARD)
+        : Layout(layout), Width(width), Height(height), Position(0), Normal(0), AlbedoSpec(0), Depth(0)
+    {
+        glGenFramebuffers(1, &ID);
+        glBindFramebuffer(GL_FRAMEBUFFER, ID);
+        std::vector<unsigned int> attachments;
+        for (const GBufferTarget &target : Targets(layout))
+        {
+            unsigned int texture;
+            glGenTextures(1, &texture);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, target.InternalFormat, width, height, 0, target.Format, target.Type, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, target.Attachment, GL_TEXTURE_2D, texture, 0);
+            if (target.Attachment != GL_DEPTH_ATTACHMENT)
+                attachments.push_back(target.Attachment);
+            textureOf(target.Name) = texture;
+        }
+        // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering
+        glDrawBuffers((GLsizei)attachments.size(), &attachments[0]);
+        // finally check if framebuffer is complete
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Framebuffer not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    // deletes the framebuffer and its textures
+    // ------------------------------------------------------------------------
+    void Delete()
+    {
+        unsigned int textures[] = { Position, Normal, AlbedoSpec, Depth };
+        for (unsigned int texture : textures)
+            if (texture != 0)
+                glDeleteTextures(1, &texture);
+        glDeleteFramebuffers(1, &ID);
+    }
+    // memory footprint of a single pixel over all targets
+    // ------------------------------------------------------------------------
+    unsigned int BytesPerPixel() const
+    {
+        unsigned int bytes = 0;
+        for (const GBufferTarget &target : Targets(Layout))
+            bytes += target.BytesPerPixel;
+        return bytes;
+    }
+    // the layout descriptor: all targets of a layout, the depth target last
+    // ------------------------------------------------------------------------
+    static std::vector<GBufferTarget> Targets(GBuffer_Layout layout)
+    {
+        if (layout == GBUFFER_COMPACT)
+        {
+            return {
+                { "normal",     GL_COLOR_ATTACHMENT0, GL_RG16,              GL_RG,              GL_UNSIGNED_SHORT, 4 },
+                { "albedoSpec", GL_COLOR_ATTACHMENT1, GL_RGBA8,             GL_RGBA,            GL_UNSIGNED_BYTE,  4 },
+                { "depth",      GL_DEPTH_ATTACHMENT,  GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT,          4 },
+            };
+        }
+        return {
+            { "position",   GL_COLOR_ATTACHMENT0, GL_RGBA16F,           GL_RGBA,            GL_FLOAT,         8 },
+            { "normal",     GL_COLOR_ATTACHMENT1, GL_RGBA16F,           GL_RGBA,            GL_FLOAT,         8 },
+            { "albedoSpec", GL_COLOR_ATTACHMENT2, GL_RGBA8,             GL_RGBA,            GL_UNSIGNED_BYTE, 4 },
+            { "depth",      GL_DEPTH_ATTACHMENT,  GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT,         4 },
+        };
+    }
+
+private:
+    unsigned int &textureOf(const std::string &name)
+    {
+        if (name == "position")
+            return Position;
+        if (name == "normal")
+            return Normal;
+        if (name == "albedoSpec")
+            return AlbedoSpec;
+        return Depth;
+    }
+};
+#endif
@@ -0,0 +1,345 @@
+#ifndef IBL_BAKER_H
+#define IBL_BAKER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <learnopengl/ibl_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Bakes the image based lighting data on the CPU without an OpenGL context. Every step mirrors the shaders of
+// the PBR samples (equirectangular_to_cubemap, irradiance_convolution, prefilter and brdf) with the same sample
+// patterns, and each result is rounded to half floats like the GPU's RGB16F render targets, so the output only
+// differs from a GPU bake in the texture filtering (e.g. seamless cubemap filtering across face edges).
+class IBLBaker
+{
+public:
+    // hdr is the equirectangular environment (bottom row first, as loaded with stbi_set_flip_vertically_on_load)
+    // ------------------------------------------------------------------------
+    static IBLData Bake(const float *hdr, int width, int height, int channels, const IBLSettings &settings, unsigned int threadCount = 0)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        IBLBaker baker(threadCount);
+        IBLData data;
+
+        // equirectangular map to environment cubemap (+ mipmaps)
+        Cubemap environment(settings.EnvironmentSize, IBLCache::MipLevelCount(settings.EnvironmentSize));
+        std::vector<glm::vec3> equirect((size_t)width * height);
+        for (size_t i = 0; i < equirect.size(); ++i)
+            equirect[i] = quantize(glm::vec3(hdr[i * channels], hdr[i * channels + 1], hdr[i * channels + 2]));
+        baker.renderFaces(environment, 0, [&](const glm::vec3 &N) {
+            return sampleEquirectangular(equirect, width, height, N);
+        });
+        for (uint32_t mip = 1; mip < environment.MipLevels; ++mip)
+            environment.Downsample(mip);
+
+        // diffuse irradiance convolution; the shader's implicit derivatives select the environment mip that matches
+        // the irradiance map's texel size
+        Cubemap irradiance(settings.IrradianceSize, 1);
+        const float irradianceLod = std::log2((float)settings.EnvironmentSize / settings.IrradianceSize);
+        baker.renderFaces(irradiance, 0, [&](const glm::vec3 &N) {
+            glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+            const glm::vec3 right = glm::normalize(glm::cross(up, N));
+            up = glm::normalize(glm::cross(N, right));
+            const float sampleDelta = 0.025f;
+            glm::vec3 result(0.0f);
+            float nrSamples = 0.0f;
+            for (float phi = 0.0f; phi < 2.0f * PI; phi += sampleDelta)
+            {
+                for (float theta = 0.0f; theta < 0.5f * PI; theta += sampleDelta)
+                {
+                    const glm::vec3 tangentSample(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+                    const glm::vec3 sampleVec = tangentSample.x * right + tangentSample.y * up + tangentSample.z * N;
+                    result += environment.Sample(sampleVec, irradianceLod) * std::cos(theta) * std::sin(theta);
+                    nrSamples++;
+                }
+            }
+            return PI * result * (1.0f / nrSamples);
+        });
+
+        // specular pre-filter convolution, one roughness per mip
+        Cubemap prefilter(settings.PrefilterSize, settings.PrefilterMipLevels);
+        for (uint32_t mip = 0; mip < settings.PrefilterMipLevels; ++mip)
+        {
+            const float roughness = (float)mip / (float)(settings.PrefilterMipLevels - 1);
+            baker.renderFaces(prefilter, mip, [&](const glm::vec3 &N) {
+                const glm::vec3 V = N;
+                glm::vec3 result(0.0f);
+                float totalWeight = 0.0f;
+                for (uint32_t i = 0; i < settings.SampleCount; ++i)
+                {
+                    const glm::vec3 H = importanceSampleGGX(hammersley(i, settings.SampleCount), N, roughness);
+                    const glm::vec3 L = glm::normalize(2.0f * glm::dot(V, H) * H - V);
+                    const float NdotL = std::max(glm::dot(N, L), 0.0f);
+                    if (NdotL > 0.0f)
+                    {
+                        const float D = distributionGGX(N, H, roughness);
+                        const float NdotH = std::max(glm::dot(N, H), 0.0f);
+                        const float HdotV = std::max(glm::dot(H, V), 0.0f);
+                        const float pdf = D * NdotH / (4.0f * HdotV) + 0.0001f;
+                        const float resolution = (float)settings.EnvironmentSize;
+                        const float saTexel = 4.0f * PI / (6.0f * resolution * resolution);
+                        const float saSample = 1.0f / (float(settings.SampleCount) * pdf + 0.0001f);
+                        const float mipLevel = roughness == 0.0f ? 0.0f : 0.5f * std::log2(saSample / saTexel);
+                        result += environment.Sample(L, mipLevel) * NdotL;
+                        totalWeight += NdotL;
+                    }
+                }
+                return result / totalWeight;
+            });
+        }
+
+        // BRDF integration map
+        data.BrdfLUT.Allocate(settings.BrdfLUTSize, 1, 1, 2);
+        std::vector<uint16_t> &lut = data.BrdfLUT.Level(0, 0);
+        const uint32_t lutSize = settings.BrdfLUTSize;
+        baker.parallelFor(lutSize, [&](uint32_t y) {
+            for (uint32_t x = 0; x < lutSize; ++x)
+            {
+                const glm::vec2 brdf = integrateBRDF((x + 0.5f) / lutSize, (y + 0.5f) / lutSize, settings.SampleCount);
+                lut[((size_t)y * lutSize + x) * 2 + 0] = glm::packHalf1x16(brdf.x);
+                lut[((size_t)y * lutSize + x) * 2 + 1] = glm::packHalf1x16(brdf.y);
+            }
+        });
+
+        environment.Store(data.Environment);
+        irradiance.Store(data.Irradiance);
+        prefilter.Store(data.Prefilter);
+        return data;
+    }
+
+    // direction through a point (uv in [0, 1]) of a cubemap face, following the OpenGL cube map face selection table
+    // ------------------------------------------------------------------------
+    static glm::vec3 FaceToDirection(uint32_t face, const glm::vec2 &uv)
+    {
+        const float sc = 2.0f * uv.x - 1.0f, tc = 2.0f * uv.y - 1.0f;
+        glm::vec3 direction;
+        switch (face)
+        {
+        case 0:  direction = glm::vec3( 1.0f,  -tc,  -sc); break; // +X
+        case 1:  direction = glm::vec3(-1.0f,  -tc,   sc); break; // -X
+        case 2:  direction = glm::vec3(   sc, 1.0f,   tc); break; // +Y
+        case 3:  direction = glm::vec3(   sc,-1.0f,  -tc); break; // -Y
+        case 4:  direction = glm::vec3(   sc,  -tc, 1.0f); break; // +Z
+        default: direction = glm::vec3(  -sc,  -tc,-1.0f); break; // -Z
+        }
+        return glm::normalize(direction);
+    }
+
+private:
+    static constexpr float PI = 3.14159265359f;
+
+    // float cubemap with its mip chain; level (face, mip) is at Levels[face * MipLevels + mip]
+    struct Cubemap {
+        uint32_t Size, MipLevels;
+        std::vector<std::vector<glm::vec3>> Levels;
+
+        Cubemap(uint32_t size, uint32_t mipLevels) : Size(size), MipLevels(mipLevels), Levels(6 * mipLevels)
+        {
+            for (uint32_t face = 0; face < 6; ++face)
+                for (uint32_t mip = 0; mip < mipLevels; ++mip)
+                    Levels[face * mipLevels + mip].resize((size_t)MipSize(mip) * MipSize(mip));
+        }
+        uint32_t MipSize(uint32_t mip) const
+        {
+            return std::max(Size >> mip, 1u);
+        }
+        // box filters the previous mip like glGenerateMipmap
+        void Downsample(uint32_t mip)
+        {
+            const uint32_t size = MipSize(mip), parentSize = MipSize(mip - 1);
+            for (uint32_t face = 0; face < 6; ++face)
+            {
+                const std::vector<glm::vec3> &parent = Levels[face * MipLevels + mip - 1];
+                std::vector<glm::vec3> &level = Levels[face * MipLevels + mip];
+                for (uint32_t y = 0; y < size; ++y)
+                {
+                    for (uint32_t x = 0; x < size; ++x)
+                    {
+                        const uint32_t x0 = std::min(2 * x, parentSize - 1), x1 = std::min(2 * x + 1, parentSize - 1);
+                        const uint32_t y0 = std::min(2 * y, parentSize - 1), y1 = std::min(2 * y + 1, parentSize - 1);
+                        level[y * size + x] = quantize(0.25f * (parent[y0 * parentSize + x0] + parent[y0 * parentSize + x1] +
+                                                                parent[y1 * parentSize + x0] + parent[y1 * parentSize + x1]));
+                    }
+                }
+            }
+        }
+        // trilinear lookup (clamped to each face's edges)
+        glm::vec3 Sample(const glm::vec3 &direction, float lod) const
+        {
+            lod = glm::clamp(lod, 0.0f, (float)(MipLevels - 1));
+            const uint32_t mip0 = (uint32_t)lod, mip1 = std::min(mip0 + 1, MipLevels - 1);
+            uint32_t face;
+            glm::vec2 uv;
+            directionToFace(direction, face, uv);
+            return glm::mix(sampleFace(face, mip0, uv), sampleFace(face, mip1, uv), lod - (float)mip0);
+        }
+        glm::vec3 sampleFace(uint32_t face, uint32_t mip, const glm::vec2 &uv) const
+        {
+            const std::vector<glm::vec3> &level = Levels[face * MipLevels + mip];
+            const int size = (int)MipSize(mip);
+            const float x = uv.x * size - 0.5f, y = uv.y * size - 0.5f;
+            const int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+            const float fx = x - x0, fy = y - y0;
+            auto texel = [&](int tx, int ty) {
+                return level[glm::clamp(ty, 0, size - 1) * size + glm::clamp(tx, 0, size - 1)];
+            };
+            return glm::mix(glm::mix(texel(x0, y0), texel(x0 + 1, y0), fx), glm::mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx), fy);
+        }
+        void Store(IBLImage &image) const
+        {
+            image.Allocate(Size, 6, MipLevels, 3);
+            for (size_t i = 0; i < Levels.size(); ++i)
+                for (size_t j = 0; j < Levels[i].size(); ++j)
+                    for (int c = 0; c < 3; ++c)
+                        image.Levels[i][j * 3 + c] = glm::packHalf1x16(Levels[i][j][c]);
+        }
+    };
+
+    unsigned int threadCount;
+
+    IBLBaker(unsigned int threadCount) : threadCount(threadCount) { }
+
+    // runs fn(i) for i in [0, count) over all threads
+    template <typename Function>
+    void parallelFor(uint32_t count, const Function &fn) const
+    {
+        std::atomic<uint32_t> next(0);
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&]() {
+                for (uint32_t i = next++; i < count; i = next++)
+                    fn(i);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    }
+    // evaluates fn(direction) for the center of each texel of a cubemap mip (one row per job)
+    template <typename Function>
+    void renderFaces(Cubemap &cubemap, uint32_t mip, const Function &fn) const
+    {
+        const uint32_t size = cubemap.MipSize(mip);
+        parallelFor(6 * size, [&](uint32_t row) {
+            const uint32_t face = row / size, y = row % size;
+            std::vector<glm::vec3> &level = cubemap.Levels[face * cubemap.MipLevels + mip];
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const glm::vec2 uv((x + 0.5f) / size, (y + 0.5f) / size);
+                level[y * size + x] = quantize(fn(FaceToDirection(face, uv)));
+            }
+        });
+    }
+
+    // rounds to the precision of the half float render targets
+    static glm::vec3 quantize(const glm::vec3 &v)
+    {
+        return glm::vec3(glm::unpackHalf1x16(glm::packHalf1x16(v.x)), glm::unpackHalf1x16(glm::packHalf1x16(v.y)), glm::unpackHalf1x16(glm::packHalf1x16(v.z)));
+    }
+    // direction to cubemap face coordinates (the inverse of FaceToDirection)
+    static void directionToFace(const glm::vec3 &d, uint32_t &face, glm::vec2 &uv)
+    {
+        const glm::vec3 a = glm::abs(d);
+        float sc, tc, ma;
+        if (a.x >= a.y && a.x >= a.z)
+        {
+            face = d.x > 0.0f ? 0 : 1;
+            sc = d.x > 0.0f ? -d.z : d.z; tc = -d.y; ma = a.x;
+        }
+        else if (a.y >= a.z)
+        {
+            face = d.y > 0.0f ? 2 : 3;
+            sc = d.x; tc = d.y > 0.0f ? d.z : -d.z; ma = a.y;
+        }
+        else
+        {
+            face = d.z > 0.0f ? 4 : 5;
+            sc = d.z > 0.0f ? d.x : -d.x; tc = -d.y; ma = a.z;
+        }
+        uv = glm::vec2(0.5f * (sc / ma + 1.0f), 0.5f * (tc / ma + 1.0f));
+    }
+    // bilinear lookup of the equirectangular map (clamp to edge)
+    static glm::vec3 sampleEquirectangular(const std::vector<glm::vec3> &map, int width, int height, const glm::vec3 &v)
+    {
+        const glm::vec2 uv = glm::vec2(std::atan2(v.z, v.x), std::asin(v.y)) * glm::vec2(0.1591f, 0.3183f) + 0.5f;
+        const float x = uv.x * width - 0.5f, y = uv.y * height - 0.5f;
+        const int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+        const float fx = x - x0, fy = y - y0;
+        auto texel = [&](int tx, int ty) {
+            return map[(size_t)glm::clamp(ty, 0, height - 1) * width + glm::clamp(tx, 0, width - 1)];
+        };
+        return glm::mix(glm::mix(texel(x0, y0), texel(x0 + 1, y0), fx), glm::mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx), fy);
+    }
+
+    // the functions below are C++ versions of the ones in the prefilter and brdf shaders
+    // ------------------------------------------------------------------------
+    static float distributionGGX(const glm::vec3 &N, const glm::vec3 &H, float roughness)
+    {
+        const float a = roughness * roughness;
+        const float a2 = a * a;
+        const float NdotH = std::max(glm::dot(N, H), 0.0f);
+        const float denom = NdotH * NdotH * (a2 - 1.0f) + 1.0f;
+        return a2 / (PI * denom * denom);
+    }
+    static float radicalInverse_VdC(uint32_t bits)
+    {
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        return float(bits) * 2.3283064365386963e-10f; // / 0x100000000
+    }
+    static glm::vec2 hammersley(uint32_t i, uint32_t N)
+    {
+        return glm::vec2(float(i) / float(N), radicalInverse_VdC(i));
+    }
+    static glm::vec3 importanceSampleGGX(const glm::vec2 &Xi, const glm::vec3 &N, float roughness)
+    {
+        const float a = roughness * roughness;
+        const float phi = 2.0f * PI * Xi.x;
+        const float cosTheta = std::sqrt((1.0f - Xi.y) / (1.0f + (a * a - 1.0f) * Xi.y));
+        const float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+        const glm::vec3 H(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+        const glm::vec3 up = std::abs(N.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+        const glm::vec3 tangent = glm::normalize(glm::cross(up, N));
+        const glm::vec3 bitangent = glm::cross(N, tangent);
+        return glm::normalize(tangent * H.x + bitangent * H.y + N * H.z);
+    }
+    static float geometrySchlickGGX(float NdotV, float roughness)
+    {
+        const float k = (roughness * roughness) / 2.0f;
+        return NdotV / (NdotV * (1.0f - k) + k);
+    }
+    static glm::vec2 integrateBRDF(float NdotV, float roughness, uint32_t sampleCount)
+    {
+        const glm::vec3 V(std::sqrt(1.0f - NdotV * NdotV), 0.0f, NdotV);
+        const glm::vec3 N(0.0f, 0.0f, 1.0f);
+        float A = 0.0f, B = 0.0f;
+        for (uint32_t i = 0; i < sampleCount; ++i)
+        {
+            const glm::vec3 H = importanceSampleGGX(hammersley(i, sampleCount), N, roughness);
+            const glm::vec3 L = glm::normalize(2.0f * glm::dot(V, H) * H - V);
+            const float NdotL = std::max(L.z, 0.0f);
+            const float NdotH = std::max(H.z, 0.0f);
+            const float VdotH = std::max(glm::dot(V, H), 0.0f);
+            if (NdotL > 0.0f)
+            {
+                const float G = geometrySchlickGGX(std::max(NdotV, 0.0f), roughness) * geometrySchlickGGX(NdotL, roughness);
+                const float G_Vis = (G * VdotH) / (NdotH * NdotV);
+                const float Fc = std::pow(1.0f - VdotH, 5.0f);
+                A += (1.0f - Fc) * G_Vis;
+                B += Fc * G_Vis;
+            }
+        }
+        return glm::vec2(A, B) / float(sampleCount);
+    }
+};
+#endif
@@ -0,0 +1,212 @@
+#ifndef IBL_CACHE_H
+#define IBL_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/file_hash.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Parameters of the image based lighting precomputation; a cache is only valid for the settings it was baked with
+struct IBLSettings {
+    uint32_t EnvironmentSize    = 512;  // face size of the environment cubemap (mipmapped down to 1x1)
+    uint32_t IrradianceSize     = 32;   // face size of the irradiance cubemap
+    uint32_t PrefilterSize      = 128;  // face size of the first mip of the pre-filter cubemap
+    uint32_t PrefilterMipLevels = 5;    // roughness 0.0 to 1.0 spread over these mip levels
+    uint32_t BrdfLUTSize        = 512;  // size of the 2D BRDF integration map
+    uint32_t SampleCount        = 1024; // importance samples per texel of the pre-filter map and the BRDF LUT
+};
+
+// A cubemap (6 faces) or 2D texture (1 face) with its mip chain as half floats, stored as OpenGL expects
+// the data of each glTexImage2D call: level (face, mip) is at Levels[face * MipLevels + mip].
+struct IBLImage {
+    uint32_t Size = 0, Faces = 0, MipLevels = 0, Channels = 0;
+    std::vector<std::vector<uint16_t>> Levels;
+
+    void Allocate(uint32_t size, uint32_t faces, uint32_t mipLevels, uint32_t channels)
+    {
+        Size = size; Faces = faces; MipLevels = mipLevels; Channels = channels;
+        Levels.assign(faces * mipLevels, std::vector<uint16_t>());
+        for (uint32_t face = 0; face < faces; ++face)
+            for (uint32_t mip = 0; mip < mipLevels; ++mip)
+                Levels[face * mipLevels + mip].resize((size_t)MipSize(mip) * MipSize(mip) * channels);
+    }
+    uint32_t MipSize(uint32_t mip) const
+    {
+        return Size >> mip > 0 ? Size >> mip : 1;
+    }
+    std::vector<uint16_t> &Level(uint32_t face, uint32_t mip) { return Levels[face * MipLevels + mip]; }
+    const std::vector<uint16_t> &Level(uint32_t face, uint32_t mip) const { return Levels[face * MipLevels + mip]; }
+};
+
+// All precomputed data of an environment
+struct IBLData {
+    IBLImage Environment; // RGB cubemap, full mip chain
+    IBLImage Irradiance;  // RGB cubemap
+    IBLImage Prefilter;   // RGB cubemap, PrefilterMipLevels mips
+    IBLImage BrdfLUT;     // RG 2D texture
+};
+
+// OpenGL textures of the precomputed data
+struct IBLMaps {
+    unsigned int EnvCubemap, IrradianceMap, PrefilterMap, BrdfLUT;
+};
+
+// Reads and writes the precomputed IBL data of an HDR environment to disk, so the samples don't have to
+// convolute the environment at every startup. The cache is a binary file holding a small header (magic,
+// version, hash of the HDR file and the bake settings) followed by each image and its half float mip chain.
+// A cache whose hash or settings don't match is considered stale and has to be baked again.
+class IBLCache
+{
+public:
+    // loads a cache; returns false if it doesn't exist, is corrupt or was baked from another source or with other settings
+    // ------------------------------------------------------------------------
+    static bool Load(const std::string &path, uint64_t sourceHash, const IBLSettings &settings, IBLData &data)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        Header header;
+        file.read((char*)&header, sizeof(header));
+        if (!file || memcmp(header.Magic, "IBLC", 4) != 0 || header.Version != VERSION)
+        {
+            std::cout << "ERROR::IBL_CACHE: Invalid cache file: " << path << std::endl;
+            return false;
+        }
+        if (header.SourceHash != sourceHash || memcmp(&header.Settings, &settings, sizeof(IBLSettings)) != 0)
+            return false;
+        IBLImage *images[] = { &data.Environment, &data.Irradiance, &data.Prefilter, &data.BrdfLUT };
+        for (IBLImage *image : images)
+        {
+            uint32_t layout[4];
+            file.read((char*)layout, sizeof(layout));
+            if (!file)
+                break;
+            image->Allocate(layout[0], layout[1], layout[2], layout[3]);
+            for (auto &level : image->Levels)
+                file.read((char*)level.data(), level.size() * sizeof(uint16_t));
+        }
+        if (!file)
+        {
+            std::cout << "ERROR::IBL_CACHE: Cache file is truncated: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    // writes a cache
+    // ------------------------------------------------------------------------
+    static bool Save(const std::string &path, uint64_t sourceHash, const IBLSettings &settings, const IBLData &data)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::IBL_CACHE: Failed to write cache file: " << path << std::endl;
+            return false;
+        }
+        Header header;
+        memcpy(header.Magic, "IBLC", 4);
+        header.Version = VERSION;
+        header.SourceHash = sourceHash;
+        header.Settings = settings;
+        file.write((const char*)&header, sizeof(header));
+        const IBLImage *images[] = { &data.Environment, &data.Irradiance, &data.Prefilter, &data.BrdfLUT };
+        for (const IBLImage *image : images)
+        {
+            uint32_t layout[4] = { image->Size, image->Faces, image->MipLevels, image->Channels };
+            file.write((const char*)layout, sizeof(layout));
+            for (const auto &level : image->Levels)
+                file.write((const char*)level.data(), level.size() * sizeof(uint16_t));
+        }
+        return (bool)file;
+    }
+    // creates the OpenGL textures of the precomputed data
+    // ------------------------------------------------------------------------
+    static IBLMaps Upload(const IBLData &data)
+    {
+        IBLMaps maps;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        maps.EnvCubemap    = uploadImage(data.Environment);
+        maps.IrradianceMap = uploadImage(data.Irradiance);
+        maps.PrefilterMap  = uploadImage(data.Prefilter);
+        maps.BrdfLUT       = uploadImage(data.BrdfLUT);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        return maps;
+    }
+    // reads the textures of maps baked on the GPU back, so they can be written to the cache
+    // ------------------------------------------------------------------------
+    static IBLData Readback(const IBLMaps &maps, const IBLSettings &settings)
+    {
+        IBLData data;
+        data.Environment.Allocate(settings.EnvironmentSize, 6, MipLevelCount(settings.EnvironmentSize), 3);
+        data.Irradiance.Allocate(settings.IrradianceSize, 6, 1, 3);
+        data.Prefilter.Allocate(settings.PrefilterSize, 6, settings.PrefilterMipLevels, 3);
+        data.BrdfLUT.Allocate(settings.BrdfLUTSize, 1, 1, 2);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        readbackImage(maps.EnvCubemap, data.Environment);
+        readbackImage(maps.IrradianceMap, data.Irradiance);
+        readbackImage(maps.PrefilterMap, data.Prefilter);
+        readbackImage(maps.BrdfLUT, data.BrdfLUT);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        return data;
+    }
+    // number of mips of a full mip chain
+    static uint32_t MipLevelCount(uint32_t size)
+    {
+        uint32_t levels = 1;
+        while (size > 1)
+        {
+            size /= 2;
+            levels++;
+        }
+        return levels;
+    }
+
+private:
+    static const uint32_t VERSION = 1;
+    struct Header {
+        char        Magic[4];
+        uint32_t    Version;
+        uint64_t    SourceHash;
+        IBLSettings Settings;
+    };
+
+    static GLenum target(const IBLImage &image, uint32_t face)
+    {
+        return image.Faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+    }
+    static unsigned int uploadImage(const IBLImage &image)
+    {
+        const GLenum type = image.Faces == 6 ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+        const GLenum internalFormat = image.Channels == 3 ? GL_RGB16F : GL_RG16F;
+        const GLenum format = image.Channels == 3 ? GL_RGB : GL_RG;
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(type, texture);
+        for (uint32_t face = 0; face < image.Faces; ++face)
+            for (uint32_t mip = 0; mip < image.MipLevels; ++mip)
+                glTexImage2D(target(image, face), mip, internalFormat, image.MipSize(mip), image.MipSize(mip), 0, format, GL_HALF_FLOAT, image.Level(face, mip).data());
+        glTexParameteri(type, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(type, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(type, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(type, GL_TEXTURE_MIN_FILTER, image.MipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(type, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // the pre-filter map only has a partial mip chain
+        glTexParameteri(type, GL_TEXTURE_MAX_LEVEL, image.MipLevels - 1);
+        return texture;
+    }
+    static void readbackImage(unsigned int texture, IBLImage &image)
+    {
+        const GLenum type = image.Faces == 6 ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+        const GLenum format = image.Channels == 3 ? GL_RGB : GL_RG;
+        glBindTexture(type, texture);
+        for (uint32_t face = 0; face < image.Faces; ++face)
+            for (uint32_t mip = 0; mip < image.MipLevels; ++mip)
+                glGetTexImage(target(image, face), mip, format, GL_HALF_FLOAT, image.Level(face, mip).data());
+    }
+};
+#endif
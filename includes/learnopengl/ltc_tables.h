@@ -0,0 +1,111 @@
+#ifndef LTC_TABLES_H
+#define LTC_TABLES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// OpenGL textures of the linearly transformed cosine tables
+struct LTCTextures {
+    unsigned int LTC1; // inverse M
+    unsigned int LTC2; // GGX norm, fresnel, 0 (unused), sphere for horizon clipping
+};
+
+// Reads and writes the precomputed LTC tables of the area light samples (Heitz et al. 2016) as a binary file,
+// so they don't have to be compiled into every sample as a header of raw floats. The file holds a small header
+// (magic, version, table size) followed by both 64x64 RGBA tables as half floats, which is also the format they
+// are uploaded in. The tables are written by 7.area_lights/3.ltc_pack.
+class LTCTables
+{
+public:
+    static const uint32_t SIZE = 64;
+    static const uint32_t CHANNELS = 4;
+
+    // writes both tables of SIZE * SIZE RGBA floats
+    // ------------------------------------------------------------------------
+    static bool Save(const std::string &path, const float *ltc1, const float *ltc2)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::LTC_TABLES: Could not write file: " << path << std::endl;
+            return false;
+        }
+        Header header;
+        memcpy(header.Magic, "LTCT", 4);
+        header.Version = VERSION;
+        header.Size = SIZE;
+        header.Channels = CHANNELS;
+        file.write((const char*)&header, sizeof(header));
+        const float *tables[] = { ltc1, ltc2 };
+        std::vector<uint16_t> halves(SIZE * SIZE * CHANNELS);
+        for (const float *table : tables)
+        {
+            for (size_t i = 0; i < halves.size(); ++i)
+                halves[i] = glm::packHalf1x16(table[i]);
+            file.write((const char*)halves.data(), halves.size() * sizeof(uint16_t));
+        }
+        return (bool)file;
+    }
+    // loads both tables into RGBA16F textures; returns false if the file doesn't exist or is corrupt
+    // ------------------------------------------------------------------------
+    static bool Load(const std::string &path, LTCTextures &textures)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::LTC_TABLES: Could not open file: " << path << std::endl;
+            return false;
+        }
+        Header header;
+        file.read((char*)&header, sizeof(header));
+        if (!file || memcmp(header.Magic, "LTCT", 4) != 0 || header.Version != VERSION || header.Size != SIZE || header.Channels != CHANNELS)
+        {
+            std::cout << "ERROR::LTC_TABLES: Invalid file: " << path << std::endl;
+            return false;
+        }
+        std::vector<uint16_t> ltc1(SIZE * SIZE * CHANNELS), ltc2(SIZE * SIZE * CHANNELS);
+        file.read((char*)ltc1.data(), ltc1.size() * sizeof(uint16_t));
+        file.read((char*)ltc2.data(), ltc2.size() * sizeof(uint16_t));
+        if (!file)
+        {
+            std::cout << "ERROR::LTC_TABLES: File is truncated: " << path << std::endl;
+            return false;
+        }
+        textures.LTC1 = createTexture(ltc1.data());
+        textures.LTC2 = createTexture(ltc2.data());
+        return true;
+    }
+
+private:
+    static const uint32_t VERSION = 1;
+    struct Header {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t Size;
+        uint32_t Channels;
+    };
+
+    static unsigned int createTexture(const uint16_t *data)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        // a sized float format: the tables hold negative values an unsized GL_RGBA texture would clamp
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SIZE, SIZE, 0, GL_RGBA, GL_HALF_FLOAT, data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+};
+#endif
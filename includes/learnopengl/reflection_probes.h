@@ -0,0 +1,286 @@
+#ifndef REFLECTION_PROBES_H
+#define REFLECTION_PROBES_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/shader_c.h>
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// A cubemap capturing the scene around a point. Objects sample the probes near them instead of the skybox.
+struct ReflectionProbe {
+    glm::vec3 Position;
+    unsigned int Cubemap;     // the last complete capture, pre-filtered for every roughness mip; what objects sample
+    unsigned int NextStep;    // update step done next: steps 0 to 5 capture the faces, the ones after filter the mips
+    unsigned int LastRefresh; // frame the last capture completed
+    bool Valid;               // whether Cubemap holds a complete capture yet
+};
+
+// Statistics of the current frame, plus running totals
+struct ReflectionProbeStats {
+    unsigned int FacesCaptured;   // faces rendered this frame
+    unsigned int MipsFiltered;    // pre-filter mips computed this frame
+    unsigned int ProbesRefreshed; // probes whose capture completed this frame
+    unsigned long long TotalFacesCaptured;
+    unsigned long long TotalMipsFiltered;
+    unsigned long long TotalProbesRefreshed;
+};
+
+// Keeps a set of reflection probes up to date without ever re-rendering all of them in one frame. Every frame
+// at most FaceBudget update steps are spent, a step being either the capture of a single cubemap face or the
+// GGX pre-filtering of one roughness mip (all faces) of the capture, by the compute pre-filter of the IBL
+// specular sample (2.2.1.prefilter.cs). The probe that is refreshed next is the one with the highest priority:
+// how many frames ago it was refreshed, divided by its distance to the camera, so nearby probes update often and
+// far away ones only occasionally. Only one probe is updated at a time, so the capture and the cubemap the mips
+// are filtered into are shared by all probes; once the last mip is filtered the latter is swapped with the
+// probe's cubemap, so objects never see a half updated probe.
+class ReflectionProbeManager
+{
+public:
+    unsigned int Resolution;
+    unsigned int MipLevels;  // pre-filtered mips, roughness 0 to 1 (at most 5, the pre-filter's limit)
+    unsigned int FaceBudget; // update steps per frame
+    float Near, Far;
+
+    // constructor takes the sample's copy of the compute pre-filter and creates the shared capture targets;
+    // probes are added with AddProbe
+    // ------------------------------------------------------------------------
+    ReflectionProbeManager(const char *prefilterPath, unsigned int resolution = 128, unsigned int faceBudget = 1, float nearPlane = 0.1f, float farPlane = 100.0f)
+        : Resolution(resolution), MipLevels(1), FaceBudget(faceBudget), Near(nearPlane), Far(farPlane), prefilterShader(prefilterPath),
+          captureMipLevels(1), frame(0), current(-1), stats()
+    {
+        for (unsigned int size = resolution; size > 1; size /= 2)
+            captureMipLevels++;
+        MipLevels = std::min(captureMipLevels, 5u);
+
+        // the capture keeps its full mip chain, the pre-filter samples it at the mip matching each sample's
+        // solid angle
+        glGenTextures(1, &captureCubemap);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, captureCubemap);
+        glTexStorage2D(GL_TEXTURE_CUBE_MAP, captureMipLevels, GL_RGBA16F, resolution, resolution);
+        setCubemapParameters();
+        filterCubemap = createCubemap();
+
+        prefilterShader.use();
+        prefilterShader.setInt("environmentMap", 0);
+        prefilterShader.setFloat("environmentResolution", (float)resolution);
+        prefilterShader.setInt("prefilterSize", resolution);
+        prefilterShader.setInt("mipLevels", MipLevels);
+        prefilterShader.setInt("baseSampleCount", 16);
+        prefilterShader.setInt("maxSampleCount", 256);
+
+        glGenFramebuffers(1, &captureFBO);
+        glGenRenderbuffers(1, &captureRBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, resolution, resolution);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    void Delete()
+    {
+        for (auto &probe : probes)
+            glDeleteTextures(1, &probe.Cubemap);
+        probes.clear();
+        glDeleteTextures(1, &captureCubemap);
+        glDeleteTextures(1, &filterCubemap);
+        glDeleteProgram(prefilterShader.ID);
+        glDeleteRenderbuffers(1, &captureRBO);
+        glDeleteFramebuffers(1, &captureFBO);
+    }
+    // adds a probe; it's captured over the next frames and sampled once complete
+    // ------------------------------------------------------------------------
+    unsigned int AddProbe(const glm::vec3 &position)
+    {
+        ReflectionProbe probe;
+        probe.Position = position;
+        probe.Cubemap = createCubemap();
+        probe.NextStep = 0;
+        probe.LastRefresh = 0;
+        probe.Valid = false;
+        probes.push_back(probe);
+        return (unsigned int)probes.size() - 1;
+    }
+    const ReflectionProbe &Probe(unsigned int index) const { return probes[index]; }
+    unsigned int ProbeCount() const { return (unsigned int)probes.size(); }
+
+    // spends this frame's budget on the probes. renderScene(view, projection) draws everything that should
+    // show up in the reflections into the bound framebuffer; the viewport is already set. The previously
+    // bound framebuffer and viewport are not restored.
+    // ------------------------------------------------------------------------
+    template <typename RenderFunction>
+    void Update(const glm::vec3 &cameraPos, RenderFunction renderScene)
+    {
+        frame++;
+        stats.FacesCaptured = stats.MipsFiltered = stats.ProbesRefreshed = 0;
+        for (unsigned int step = 0; step < FaceBudget && !probes.empty(); ++step)
+        {
+            // a started capture is always finished first, so all its faces are from (nearly) the same moment
+            if (current < 0)
+                current = selectProbe(cameraPos);
+            ReflectionProbe &probe = probes[current];
+            if (probe.NextStep < 6)
+            {
+                captureFace(probe, probe.NextStep, renderScene);
+                probe.NextStep++;
+                stats.FacesCaptured++;
+                stats.TotalFacesCaptured++;
+                continue;
+            }
+            // a pre-filter step: one roughness mip, then the filtered cubemap replaces the sampled one
+            unsigned int mip = probe.NextStep - 6;
+            filterMip(mip);
+            probe.NextStep++;
+            stats.MipsFiltered++;
+            stats.TotalMipsFiltered++;
+            if (mip + 1 == MipLevels)
+            {
+                // the next fragment shaders sample what the pre-filter wrote to its images
+                glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+                std::swap(probe.Cubemap, filterCubemap);
+                probe.NextStep = 0;
+                probe.LastRefresh = frame;
+                probe.Valid = true;
+                current = -1;
+                stats.ProbesRefreshed++;
+                stats.TotalProbesRefreshed++;
+            }
+        }
+    }
+    // the two nearest complete probes of a position and the weight of the first one, based on the inverse
+    // distances; probeB is -1 if only one probe is available and both are -1 if there's none
+    // ------------------------------------------------------------------------
+    void Nearest(const glm::vec3 &position, int &probeA, int &probeB, float &weightA) const
+    {
+        probeA = probeB = -1;
+        float distanceA = 0.0f, distanceB = 0.0f;
+        for (unsigned int i = 0; i < probes.size(); ++i)
+        {
+            if (!probes[i].Valid)
+                continue;
+            const float distance = glm::length(probes[i].Position - position);
+            if (probeA < 0 || distance < distanceA)
+            {
+                probeB = probeA;
+                distanceB = distanceA;
+                probeA = i;
+                distanceA = distance;
+            }
+            else if (probeB < 0 || distance < distanceB)
+            {
+                probeB = i;
+                distanceB = distance;
+            }
+        }
+        if (probeB < 0)
+            weightA = 1.0f;
+        else
+            weightA = distanceB / glm::max(distanceA + distanceB, 0.0001f);
+    }
+    ReflectionProbeStats Stats() const
+    {
+        return stats;
+    }
+
+private:
+    std::vector<ReflectionProbe> probes;
+    ComputeShader prefilterShader;
+    unsigned int captureCubemap, captureMipLevels;
+    unsigned int filterCubemap; // the mips are filtered into this, then it's swapped with the probe's cubemap
+    unsigned int captureFBO, captureRBO;
+    unsigned int frame;
+    int current; // probe whose capture is in progress, -1 if none
+    ReflectionProbeStats stats;
+
+    // a pre-filtered cubemap; immutable storage, as the pre-filter writes its mips as images
+    unsigned int createCubemap()
+    {
+        unsigned int cubemap;
+        glGenTextures(1, &cubemap);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+        glTexStorage2D(GL_TEXTURE_CUBE_MAP, MipLevels, GL_RGBA16F, Resolution, Resolution);
+        setCubemapParameters();
+        return cubemap;
+    }
+    static void setCubemapParameters()
+    {
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    // work groups of the pre-filter covering all faces of a mip
+    unsigned int mipGroups(unsigned int mip) const
+    {
+        unsigned int tiles = (std::max(Resolution >> mip, 1u) + 7) / 8;
+        return 6 * tiles * tiles;
+    }
+    // pre-filters one mip of the capture into filterCubemap; the pre-filter lays out the work groups of all mips
+    // after each other, so a mip is the range of groups after those of the mips before it
+    void filterMip(unsigned int mip)
+    {
+        // the capture's own mip chain, which the pre-filter samples from, once all faces are in
+        if (mip == 0)
+        {
+            glBindTexture(GL_TEXTURE_CUBE_MAP, captureCubemap);
+            glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+        }
+        unsigned int firstGroup = 0;
+        for (unsigned int i = 0; i < mip; ++i)
+            firstGroup += mipGroups(i);
+        prefilterShader.use();
+        glUniform1ui(glGetUniformLocation(prefilterShader.ID, "firstGroup"), firstGroup);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, captureCubemap);
+        glBindImageTexture(mip, filterCubemap, mip, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute(mipGroups(mip), 1, 1);
+    }
+    int selectProbe(const glm::vec3 &cameraPos) const
+    {
+        int best = 0;
+        float bestPriority = -1.0f;
+        for (unsigned int i = 0; i < probes.size(); ++i)
+        {
+            // probes that were never captured go first
+            const float age = probes[i].Valid ? float(frame - probes[i].LastRefresh) : 1e6f;
+            const float priority = age / glm::max(glm::length(probes[i].Position - cameraPos), 1.0f);
+            if (priority > bestPriority)
+            {
+                best = i;
+                bestPriority = priority;
+            }
+        }
+        return best;
+    }
+    template <typename RenderFunction>
+    void captureFace(const ReflectionProbe &probe, unsigned int face, RenderFunction &renderScene)
+    {
+        // same face orientations as the capture views of the PBR samples
+        static const glm::vec3 directions[6] = {
+            glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(-1.0f,  0.0f,  0.0f),
+            glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 0.0f, -1.0f,  0.0f),
+            glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 0.0f,  0.0f, -1.0f)
+        };
+        static const glm::vec3 ups[6] = {
+            glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f),
+            glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f,  0.0f, -1.0f),
+            glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)
+        };
+        const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, Near, Far);
+        const glm::mat4 view = glm::lookAt(probe.Position, probe.Position + directions[face], ups[face]);
+        glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, captureCubemap, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::REFLECTION_PROBES: Capture framebuffer is not complete!" << std::endl;
+        glViewport(0, 0, Resolution, Resolution);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        renderScene(view, projection);
+    }
+};
+#endif
@@ -0,0 +1,376 @@
+#ifndef SDF_FONT_H
+#define SDF_FONT_H
+
+#include <glm/glm.hpp>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <learnopengl/file_hash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Holds the metrics of a single distance field glyph. All sizes are in pixels at
+// SDFFont::GlyphSize and include the spread border around the glyph.
+struct SDFGlyph {
+    unsigned int Codepoint;
+    glm::ivec2   Size;      // size of the distance field bitmap
+    glm::ivec2   Bearing;   // offset from baseline to left/top of the distance field bitmap
+    unsigned int Advance;   // horizontal offset to advance to next glyph (in 1/64th pixels)
+    glm::ivec2   Offset;    // top-left position of the glyph inside the atlas
+};
+
+// Generates a single-channel signed distance field atlas from the outlines of a
+// FreeType font. Glyph outlines are rasterized at a multiple of the field
+// resolution, after which an exact euclidean distance transform (computed on
+// worker threads) is sampled down to the field resolution. Since distances scale
+// linearly, one atlas renders sharp text at any size. Generated atlases are
+// cached on disk so the (relatively expensive) generation only runs once.
+class SDFFont
+{
+public:
+    // the pixel (em) size distance fields are generated at
+    unsigned int GlyphSize;
+    // the maximum distance (in pixels at GlyphSize) that is encoded in the field
+    unsigned int Spread;
+    // width and height of the atlas
+    unsigned int AtlasSize;
+    // generated glyphs, every loaded range in codepoint order
+    std::vector<SDFGlyph> Glyphs;
+    // the atlas' distance values, 0.5 (128) lies exactly on the outline
+    std::vector<unsigned char> Pixels;
+
+    SDFFont(unsigned int glyphSize = 32, unsigned int spread = 4, unsigned int atlasSize = 512)
+        : GlyphSize(glyphSize), Spread(spread), AtlasSize(atlasSize), ft(nullptr), face(nullptr), penX(0), penY(0), rowHeight(0)
+    {
+    }
+    ~SDFFont()
+    {
+        if (face)
+            FT_Done_Face(face);
+        if (ft)
+            FT_Done_FreeType(ft);
+    }
+    SDFFont(const SDFFont&) = delete;
+    SDFFont &operator=(const SDFFont&) = delete;
+
+    // loads the distance fields of [first, first + count) from the cache file or, if the cache
+    // is missing or stale, generates them and writes the cache. The font stays open so glyphs
+    // outside of the range can be added later with AddGlyph.
+    bool Load(const std::string &font, unsigned int first, unsigned int count, const std::string &cachePath)
+    {
+        Glyphs.clear();
+        penX = penY = rowHeight = 0;
+        Pixels.assign(AtlasSize * AtlasSize, 0);
+        if (!ft && FT_Init_FreeType(&ft))
+        {
+            std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+            ft = nullptr;
+            return false;
+        }
+        if (face)
+            FT_Done_Face(face);
+        if (FT_New_Face(ft, font.c_str(), 0, &face))
+        {
+            std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+            face = nullptr;
+            return false;
+        }
+        FT_Set_Pixel_Sizes(face, 0, GlyphSize * UPSCALE);
+
+        unsigned long long key = cacheKey(font, first, count);
+        if (loadCache(cachePath, key))
+            return true;
+
+        std::vector<unsigned int> codepoints;
+        for (unsigned int c = first; c < first + count; ++c)
+            codepoints.push_back(c);
+        generate(codepoints);
+        saveCache(cachePath, key);
+        return true;
+    }
+
+    // generates and packs a single glyph that wasn't part of the loaded range. Returns false if
+    // the glyph couldn't be loaded or the atlas is full.
+    bool AddGlyph(unsigned int codepoint, SDFGlyph &glyph)
+    {
+        if (!face)
+            return false;
+        size_t count = Glyphs.size();
+        generate(std::vector<unsigned int>(1, codepoint));
+        if (Glyphs.size() == count)
+            return false;
+        glyph = Glyphs.back();
+        return true;
+    }
+
+private:
+    // factor by which outlines are rasterized above GlyphSize to compute accurate distances
+    static constexpr unsigned int UPSCALE = 8;
+    static constexpr unsigned int CACHE_MAGIC = 0x46445353; // "SSDF"
+    static constexpr unsigned int CACHE_VERSION = 1;
+
+    FT_Library ft;
+    FT_Face face;
+    unsigned int penX, penY, rowHeight;
+
+    // a rasterized glyph waiting for its distance field
+    struct Job {
+        SDFGlyph Glyph;
+        std::vector<unsigned char> Field;
+        std::vector<unsigned char> Bitmap; // coverage at GlyphSize * UPSCALE
+        int BitmapWidth, BitmapRows;
+        glm::ivec2 BitmapOffset; // position of the bitmap inside the padded high resolution grid
+    };
+
+    void generate(const std::vector<unsigned int> &codepoints)
+    {
+        // rasterizing goes through the (single threaded) FreeType face...
+        std::vector<Job> jobs;
+        jobs.reserve(codepoints.size());
+        for (unsigned int codepoint : codepoints)
+        {
+            if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+            {
+                std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+                continue;
+            }
+            jobs.push_back(rasterize(codepoint, face->glyph));
+        }
+        // ...while the distance transforms are independent and spread over worker threads
+        std::atomic<size_t> next(0);
+        unsigned int threadCount = std::max(1u, std::min<unsigned int>(std::thread::hardware_concurrency(), static_cast<unsigned int>(jobs.size())));
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            workers.emplace_back([&]() {
+                for (size_t i = next++; i < jobs.size(); i = next++)
+                    computeField(jobs[i]);
+            });
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+        // finally pack the fields into the atlas (tallest first packs shelves more tightly)
+        std::vector<Job*> order;
+        for (Job &job : jobs)
+            order.push_back(&job);
+        std::stable_sort(order.begin(), order.end(), [](const Job *a, const Job *b) { return a->Glyph.Size.y > b->Glyph.Size.y; });
+        size_t firstNew = Glyphs.size();
+        for (Job *job : order)
+        {
+            if (!pack(*job))
+            {
+                std::cout << "ERROR::SDFFONT: Glyph atlas is full" << std::endl;
+                continue;
+            }
+            Glyphs.push_back(job->Glyph);
+        }
+        // they were packed tallest first, put the new glyphs back in codepoint order
+        std::stable_sort(Glyphs.begin() + firstNew, Glyphs.end(),
+            [](const SDFGlyph &a, const SDFGlyph &b) { return a.Codepoint < b.Codepoint; });
+    }
+
+    Job rasterize(unsigned int codepoint, FT_GlyphSlot slot)
+    {
+        Job job;
+        job.Glyph.Codepoint = codepoint;
+        job.Glyph.Advance = static_cast<unsigned int>(slot->advance.x / UPSCALE);
+        job.Glyph.Offset = glm::ivec2(0);
+        job.BitmapWidth = slot->bitmap.width;
+        job.BitmapRows = slot->bitmap.rows;
+        if (job.BitmapWidth == 0 || job.BitmapRows == 0)
+        {
+            job.Glyph.Size = glm::ivec2(0);
+            job.Glyph.Bearing = glm::ivec2(0);
+            job.BitmapOffset = glm::ivec2(0);
+            return job;
+        }
+        // align the field's top-left corner to a whole pixel at GlyphSize, with a Spread border
+        int left = static_cast<int>(std::floor(slot->bitmap_left / static_cast<float>(UPSCALE))) - static_cast<int>(Spread);
+        int top = static_cast<int>(std::ceil(slot->bitmap_top / static_cast<float>(UPSCALE))) + static_cast<int>(Spread);
+        job.BitmapOffset = glm::ivec2(slot->bitmap_left - left * static_cast<int>(UPSCALE), top * static_cast<int>(UPSCALE) - slot->bitmap_top);
+        int border = Spread * UPSCALE;
+        job.Glyph.Bearing = glm::ivec2(left, top);
+        job.Glyph.Size = glm::ivec2((job.BitmapOffset.x + job.BitmapWidth + border + UPSCALE - 1) / UPSCALE,
+                                    (job.BitmapOffset.y + job.BitmapRows + border + UPSCALE - 1) / UPSCALE);
+        job.Bitmap.resize(job.BitmapWidth * job.BitmapRows);
+        for (int y = 0; y < job.BitmapRows; ++y)
+            std::copy(slot->bitmap.buffer + y * slot->bitmap.pitch, slot->bitmap.buffer + y * slot->bitmap.pitch + job.BitmapWidth, job.Bitmap.begin() + y * job.BitmapWidth);
+        return job;
+    }
+
+    // 1D squared euclidean distance transform (Felzenszwalb & Huttenlocher)
+    static void distanceTransform1D(const float *f, float *d, int n, int *v, float *z)
+    {
+        int k = 0;
+        v[0] = 0;
+        z[0] = -std::numeric_limits<float>::infinity();
+        z[1] = std::numeric_limits<float>::infinity();
+        for (int q = 1; q < n; ++q)
+        {
+            float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+            while (s <= z[k])
+            {
+                --k;
+                s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = std::numeric_limits<float>::infinity();
+        }
+        k = 0;
+        for (int q = 0; q < n; ++q)
+        {
+            while (z[k + 1] < q)
+                ++k;
+            d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+        }
+    }
+
+    // 2D squared distance transform in place: grid holds 0 for feature pixels and a large value elsewhere
+    static void distanceTransform2D(std::vector<float> &grid, int width, int height)
+    {
+        int n = std::max(width, height);
+        std::vector<float> f(n), d(n), z(n + 1);
+        std::vector<int> v(n);
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y)
+                f[y] = grid[y * width + x];
+            distanceTransform1D(f.data(), d.data(), height, v.data(), z.data());
+            for (int y = 0; y < height; ++y)
+                grid[y * width + x] = d[y];
+        }
+        for (int y = 0; y < height; ++y)
+        {
+            distanceTransform1D(&grid[y * width], d.data(), width, v.data(), z.data());
+            std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+        }
+    }
+
+    void computeField(Job &job) const
+    {
+        int fieldWidth = job.Glyph.Size.x, fieldHeight = job.Glyph.Size.y;
+        if (fieldWidth == 0 || fieldHeight == 0)
+            return;
+        // place the high resolution coverage in the padded grid and threshold it
+        int width = fieldWidth * UPSCALE, height = fieldHeight * UPSCALE;
+        const float far = static_cast<float>(width * width + height * height);
+        std::vector<float> toInside(width * height, far), toOutside(width * height, 0.0f);
+        for (int y = 0; y < job.BitmapRows; ++y)
+        {
+            for (int x = 0; x < job.BitmapWidth; ++x)
+            {
+                if (job.Bitmap[y * job.BitmapWidth + x] < 128)
+                    continue;
+                int index = (y + job.BitmapOffset.y) * width + x + job.BitmapOffset.x;
+                toInside[index] = 0.0f;
+                toOutside[index] = far;
+            }
+        }
+        distanceTransform2D(toInside, width, height);
+        distanceTransform2D(toOutside, width, height);
+        // sample the signed distance at the center of every field pixel (positive inside)
+        job.Field.resize(fieldWidth * fieldHeight);
+        for (int y = 0; y < fieldHeight; ++y)
+        {
+            for (int x = 0; x < fieldWidth; ++x)
+            {
+                int index = (y * UPSCALE + UPSCALE / 2) * width + x * UPSCALE + UPSCALE / 2;
+                float distance = (std::sqrt(toOutside[index]) - std::sqrt(toInside[index])) / UPSCALE;
+                float value = 0.5f + 0.5f * distance / Spread;
+                job.Field[y * fieldWidth + x] = static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    bool pack(Job &job)
+    {
+        unsigned int width = job.Glyph.Size.x, height = job.Glyph.Size.y;
+        if (width == 0 || height == 0)
+            return true;
+        if (penX + width + 1 > AtlasSize)
+        {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        if (penY + height > AtlasSize)
+            return false;
+        job.Glyph.Offset = glm::ivec2(penX, penY);
+        for (unsigned int y = 0; y < height; ++y)
+            std::copy(job.Field.begin() + y * width, job.Field.begin() + (y + 1) * width, Pixels.begin() + (penY + y) * AtlasSize + penX);
+        penX += width + 1;
+        rowHeight = std::max(rowHeight, height);
+        return true;
+    }
+
+    // identifies the font file (a 64 bit FNV-1a hash of its contents) and generation parameters a cache was built with
+    unsigned long long cacheKey(const std::string &font, unsigned int first, unsigned int count) const
+    {
+        unsigned long long key = FileHash::Hash(font);
+        unsigned long long parameters[] = { GlyphSize, Spread, AtlasSize, UPSCALE, first, count };
+        for (unsigned long long parameter : parameters)
+            key = (key ^ parameter) * 1099511628211ull;
+        return key;
+    }
+
+    bool loadCache(const std::string &path, unsigned long long key)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        unsigned int magic = 0, version = 0, glyphCount = 0;
+        unsigned long long storedKey = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+        file.read(reinterpret_cast<char*>(&glyphCount), sizeof(glyphCount));
+        if (!file || magic != CACHE_MAGIC || version != CACHE_VERSION || storedKey != key)
+            return false;
+        std::vector<SDFGlyph> glyphs(glyphCount);
+        file.read(reinterpret_cast<char*>(glyphs.data()), glyphCount * sizeof(SDFGlyph));
+        file.read(reinterpret_cast<char*>(&penX), sizeof(penX));
+        file.read(reinterpret_cast<char*>(&penY), sizeof(penY));
+        file.read(reinterpret_cast<char*>(&rowHeight), sizeof(rowHeight));
+        file.read(reinterpret_cast<char*>(Pixels.data()), Pixels.size());
+        if (!file)
+        {
+            penX = penY = rowHeight = 0;
+            return false;
+        }
+        Glyphs = glyphs;
+        return true;
+    }
+
+    void saveCache(const std::string &path, unsigned long long key) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::SDFFONT: Could not write cache " << path << std::endl;
+            return;
+        }
+        unsigned int glyphCount = static_cast<unsigned int>(Glyphs.size());
+        file.write(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(&glyphCount), sizeof(glyphCount));
+        file.write(reinterpret_cast<const char*>(Glyphs.data()), glyphCount * sizeof(SDFGlyph));
+        file.write(reinterpret_cast<const char*>(&penX), sizeof(penX));
+        file.write(reinterpret_cast<const char*>(&penY), sizeof(penY));
+        file.write(reinterpret_cast<const char*>(&rowHeight), sizeof(rowHeight));
+        file.write(reinterpret_cast<const char*>(Pixels.data()), Pixels.size());
+    }
+};
+
+#endif
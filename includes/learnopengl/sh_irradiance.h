@@ -0,0 +1,106 @@
+#ifndef SH_IRRADIANCE_H
+#define SH_IRRADIANCE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+// Diffuse irradiance of an environment as 9 RGB L2 spherical harmonics coefficients. The environment's radiance is
+// projected onto the SH basis and convolved with the clamped cosine lobe, so evaluating the basis for a normal
+// directly gives the irradiance (divided by PI, matching the irradiance cubemaps of the PBR samples). This replaces
+// a hemisphere convolution per cubemap texel by a single pass over the environment's texels.
+class SHIrradiance
+{
+public:
+    glm::vec3 Coefficients[9];
+
+    // projects an equirectangular environment map (bottom row first, as loaded with stbi_set_flip_vertically_on_load)
+    // ------------------------------------------------------------------------
+    static SHIrradiance FromEquirectangular(const float *hdr, int width, int height, int channels, unsigned int threadCount = 0)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        const float PI = 3.14159265359f;
+        // every thread sums its own band of rows
+        std::vector<std::vector<glm::dvec3>> partial(threadCount, std::vector<glm::dvec3>(9, glm::dvec3(0.0)));
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                float basis[9];
+                for (int y = t; y < height; y += threadCount)
+                {
+                    // inverse of SampleSphericalMap in the equirectangular_to_cubemap shader
+                    const float latitude = ((y + 0.5f) / height - 0.5f) * PI;
+                    // solid angle of a texel in this row
+                    const float dOmega = std::cos(latitude) * (2.0f * PI / width) * (PI / height);
+                    for (int x = 0; x < width; ++x)
+                    {
+                        const float longitude = ((x + 0.5f) / width - 0.5f) * 2.0f * PI;
+                        const glm::vec3 direction(std::cos(latitude) * std::cos(longitude), std::sin(latitude), std::cos(latitude) * std::sin(longitude));
+                        const float *texel = &hdr[((size_t)y * width + x) * channels];
+                        const glm::dvec3 radiance = glm::dvec3(texel[0], texel[1], texel[2]) * (double)dOmega;
+                        Basis(direction, basis);
+                        for (int i = 0; i < 9; ++i)
+                            partial[t][i] += radiance * (double)basis[i];
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        // convolve with the cosine lobe (band factors PI, 2PI/3 and PI/4) and divide by PI
+        const float bandFactor[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+        SHIrradiance sh;
+        for (int i = 0; i < 9; ++i)
+        {
+            glm::dvec3 sum(0.0);
+            for (unsigned int t = 0; t < threadCount; ++t)
+                sum += partial[t][i];
+            sh.Coefficients[i] = glm::vec3(sum) * bandFactor[i];
+        }
+        return sh;
+    }
+    // irradiance (divided by PI) for a normal
+    // ------------------------------------------------------------------------
+    glm::vec3 Evaluate(const glm::vec3 &normal) const
+    {
+        float basis[9];
+        Basis(normal, basis);
+        glm::vec3 result(0.0f);
+        for (int i = 0; i < 9; ++i)
+            result += Coefficients[i] * basis[i];
+        return glm::max(result, glm::vec3(0.0f));
+    }
+    // uploads the coefficients into a uniform buffer as a std140 vec4[9] array
+    // ------------------------------------------------------------------------
+    void Upload(unsigned int ubo) const
+    {
+        glm::vec4 data[9];
+        for (int i = 0; i < 9; ++i)
+            data[i] = glm::vec4(Coefficients[i], 0.0f);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    // real L2 SH basis functions; the shader's evaluation uses the same order and constants
+    // ------------------------------------------------------------------------
+    static void Basis(const glm::vec3 &n, float basis[9])
+    {
+        basis[0] = 0.282095f;
+        basis[1] = 0.488603f * n.y;
+        basis[2] = 0.488603f * n.z;
+        basis[3] = 0.488603f * n.x;
+        basis[4] = 1.092548f * n.x * n.y;
+        basis[5] = 1.092548f * n.y * n.z;
+        basis[6] = 0.315392f * (3.0f * n.z * n.z - 1.0f);
+        basis[7] = 1.092548f * n.x * n.z;
+        basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+    }
+};
+#endif
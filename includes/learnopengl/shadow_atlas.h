@@ -0,0 +1,315 @@
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// A square region of the shadow atlas; Size is 0 if no page could be allocated
+struct ShadowAtlasPage {
+    unsigned int X, Y, Size;
+    // the resolution the light asked for; Size is smaller if the atlas was full
+    unsigned int Requested;
+    // the atlas' release count when a larger page was last tried, so a downsized page only retries once
+    // space was freed
+    unsigned int Releases;
+    // whether the page has to be (re-)rendered this frame
+    bool Dirty;
+};
+
+// Statistics of the current frame
+struct ShadowAtlasStats {
+    unsigned int PagesAllocated;
+    unsigned int PagesRendered;
+    unsigned int PagesCached;
+    unsigned int AllocationFailures;
+    float Occupancy;  // fraction of the atlas' texels covered by pages
+};
+
+// Hands out power of two sized squares of a square area by recursively splitting it in four.
+// Freed squares are merged with their siblings again once all four are free.
+class QuadtreeAllocator
+{
+public:
+    QuadtreeAllocator(unsigned int size, unsigned int minSize) : size(size), minSize(minSize), used(0)
+    {
+        nodes.push_back(Node());
+    }
+    // returns false if there's no free square of the given size left
+    bool Allocate(unsigned int requestedSize, unsigned int &x, unsigned int &y)
+    {
+        if (requestedSize > size || requestedSize < minSize)
+            return false;
+        if (!allocate(0, 0, 0, size, requestedSize, x, y))
+            return false;
+        used += (unsigned long long)requestedSize * requestedSize;
+        return true;
+    }
+    void Free(unsigned int x, unsigned int y, unsigned int freedSize)
+    {
+        if (free(0, 0, 0, size, x, y, freedSize))
+            used -= (unsigned long long)freedSize * freedSize;
+    }
+    float Occupancy() const
+    {
+        return float(double(used) / (double(size) * size));
+    }
+
+private:
+    struct Node {
+        bool Used = false;
+        int  Children = -1; // index of the first of 4 consecutive children, -1 if this is a leaf
+    };
+    std::vector<Node> nodes;
+    std::vector<int> freeChildren; // first index of each unused group of 4 nodes
+    unsigned int size, minSize;
+    unsigned long long used;
+
+    bool allocate(int node, unsigned int nodeX, unsigned int nodeY, unsigned int nodeSize, unsigned int requestedSize, unsigned int &x, unsigned int &y)
+    {
+        if (nodes[node].Used)
+            return false;
+        if (nodeSize == requestedSize)
+        {
+            // only a leaf can be handed out as a whole
+            if (nodes[node].Children != -1)
+                return false;
+            nodes[node].Used = true;
+            x = nodeX;
+            y = nodeY;
+            return true;
+        }
+        if (nodes[node].Children == -1)
+            split(node);
+        const unsigned int half = nodeSize / 2;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (allocate(nodes[node].Children + i, nodeX + (i % 2) * half, nodeY + (i / 2) * half, half, requestedSize, x, y))
+                return true;
+        }
+        merge(node);
+        return false;
+    }
+    bool free(int node, unsigned int nodeX, unsigned int nodeY, unsigned int nodeSize, unsigned int x, unsigned int y, unsigned int freedSize)
+    {
+        if (nodeSize == freedSize)
+        {
+            if (!nodes[node].Used || nodeX != x || nodeY != y)
+                return false;
+            nodes[node].Used = false;
+            return true;
+        }
+        if (nodes[node].Children == -1)
+            return false;
+        const unsigned int half = nodeSize / 2;
+        const int i = (x >= nodeX + half ? 1 : 0) + (y >= nodeY + half ? 2 : 0);
+        const bool freed = free(nodes[node].Children + i, nodeX + (i % 2) * half, nodeY + (i / 2) * half, half, x, y, freedSize);
+        if (freed)
+            merge(node);
+        return freed;
+    }
+    void split(int node)
+    {
+        int first;
+        if (!freeChildren.empty())
+        {
+            first = freeChildren.back();
+            freeChildren.pop_back();
+        }
+        else
+        {
+            first = (int)nodes.size();
+            nodes.resize(nodes.size() + 4);
+        }
+        for (int i = 0; i < 4; ++i)
+            nodes[first + i] = Node();
+        nodes[node].Children = first;
+    }
+    // collapses a node's children back into the node if none of them is in use
+    void merge(int node)
+    {
+        const int first = nodes[node].Children;
+        if (first == -1)
+            return;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (nodes[first + i].Used || nodes[first + i].Children != -1)
+                return;
+        }
+        freeChildren.push_back(first);
+        nodes[node].Children = -1;
+    }
+};
+
+// A single large depth texture shared by the shadow maps of many lights. Every light gets a
+// page with a resolution matching its footprint on screen; pages of lights that didn't change
+// (and whose page didn't move) keep their content so only dirty pages are rendered each frame.
+class ShadowAtlas
+{
+public:
+    unsigned int FBO, DepthMap;
+    unsigned int Resolution, MinPageSize, MaxPageSize;
+
+    // constructor creates the atlas texture and framebuffer
+    // ------------------------------------------------------------------------
+    ShadowAtlas(unsigned int resolution = 4096, unsigned int minPageSize = 64, unsigned int maxPageSize = 1024)
+        : Resolution(resolution), MinPageSize(minPageSize), MaxPageSize(maxPageSize), allocator(resolution, minPageSize), stats()
+    {
+        glGenTextures(1, &DepthMap);
+        glBindTexture(GL_TEXTURE_2D, DepthMap);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, DepthMap, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::SHADOW_ATLAS: Framebuffer is not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    void Delete()
+    {
+        glDeleteFramebuffers(1, &FBO);
+        glDeleteTextures(1, &DepthMap);
+    }
+    // resets the per-frame statistics
+    // ------------------------------------------------------------------------
+    void BeginFrame()
+    {
+        stats.PagesRendered = stats.PagesCached = stats.AllocationFailures = 0;
+    }
+    // page resolution (power of two) for a light covering screenRadius pixels on screen
+    // ------------------------------------------------------------------------
+    unsigned int ResolutionForFootprint(float screenRadius) const
+    {
+        unsigned int resolution = MinPageSize;
+        while (resolution < MaxPageSize && resolution < 2.0f * screenRadius)
+            resolution *= 2;
+        return resolution;
+    }
+    // returns the light's page for this frame. The page is reallocated only if the requested resolution
+    // changes: to a larger page if one fits (the current page is kept if not) or to a smaller one if the
+    // request is at least 4 times smaller. A page that got less than it asked for because the atlas was full
+    // keeps its size and content until other pages are released, then a larger one is tried again.
+    // The page is dirty if it's new, the light changed or the light was invalidated.
+    // ------------------------------------------------------------------------
+    const ShadowAtlasPage &Request(unsigned int light, unsigned int resolution, bool lightChanged)
+    {
+        if (light >= pages.size())
+            pages.resize(light + 1, ShadowAtlasPage{ 0, 0, 0, 0, 0, true });
+        ShadowAtlasPage &page = pages[light];
+        resolution = std::max(MinPageSize, std::min(resolution, MaxPageSize));
+        const bool requestChanged = resolution != page.Requested;
+        page.Requested = resolution;
+        if (page.Size != 0 && requestChanged && resolution * 2 < page.Size)
+            release(page);
+        if (page.Size < resolution && (requestChanged || page.Releases != releases))
+        {
+            // the larger page is allocated before the current one is released, so if none fits the light
+            // keeps what it has
+            unsigned int x, y;
+            for (unsigned int size = resolution; size > page.Size && size >= MinPageSize; size /= 2)
+            {
+                if (allocator.Allocate(size, x, y))
+                {
+                    release(page);
+                    page.X = x;
+                    page.Y = y;
+                    page.Size = size;
+                    page.Dirty = true;
+                    stats.PagesAllocated++;
+                    break;
+                }
+            }
+            page.Releases = releases;
+        }
+        if (page.Size == 0)
+            stats.AllocationFailures++;
+        if (lightChanged)
+            page.Dirty = true;
+        if (page.Size != 0)
+        {
+            if (page.Dirty)
+                stats.PagesRendered++;
+            else
+                stats.PagesCached++;
+        }
+        return page;
+    }
+    // binds the atlas and restricts rendering to the page; clears the page's depth
+    // ------------------------------------------------------------------------
+    void BeginPage(unsigned int light)
+    {
+        const ShadowAtlasPage &page = pages[light];
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glEnable(GL_SCISSOR_TEST);
+        glViewport(page.X, page.Y, page.Size, page.Size);
+        glScissor(page.X, page.Y, page.Size, page.Size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    // marks the page as up to date; call once it has been rendered
+    // ------------------------------------------------------------------------
+    void EndPage(unsigned int light)
+    {
+        pages[light].Dirty = false;
+        glDisable(GL_SCISSOR_TEST);
+    }
+    // offset (xy) and scale (zw) that map a light's [0, 1] shadow map coordinates into the atlas
+    // ------------------------------------------------------------------------
+    glm::vec4 PageRect(unsigned int light) const
+    {
+        if (light >= pages.size() || pages[light].Size == 0)
+            return glm::vec4(0.0f);
+        const ShadowAtlasPage &page = pages[light];
+        return glm::vec4(page.X, page.Y, page.Size, page.Size) / float(Resolution);
+    }
+    // forces a light's (or every light's) page to be re-rendered, e.g. when the casters moved
+    // ------------------------------------------------------------------------
+    void Invalidate(unsigned int light)
+    {
+        if (light < pages.size())
+            pages[light].Dirty = true;
+    }
+    void InvalidateAll()
+    {
+        for (auto &page : pages)
+            page.Dirty = true;
+    }
+    // returns a light's page to the allocator
+    // ------------------------------------------------------------------------
+    void Release(unsigned int light)
+    {
+        if (light < pages.size())
+            release(pages[light]);
+    }
+    ShadowAtlasStats Stats() const
+    {
+        ShadowAtlasStats result = stats;
+        result.Occupancy = allocator.Occupancy();
+        return result;
+    }
+
+private:
+    QuadtreeAllocator allocator;
+    std::vector<ShadowAtlasPage> pages;
+    ShadowAtlasStats stats;
+    unsigned int releases = 0; // number of pages returned to the allocator so far
+
+    void release(ShadowAtlasPage &page)
+    {
+        if (page.Size == 0)
+            return;
+        allocator.Free(page.X, page.Y, page.Size);
+        page.Size = 0;
+        stats.PagesAllocated--;
+        releases++;
+    }
+};
+#endif
@@ -0,0 +1,178 @@
+#ifndef SHADOW_PASS_H
+#define SHADOW_PASS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// A caster instanced into a single layer of a layered shadow map (cascade or cube face)
+struct ShadowInstance {
+    glm::mat4 Model;
+    int       Layer;
+    int       padding[3];
+};
+
+// Builds the depth pass of a layered shadow map. Every caster is culled against the frustum
+// of each layer and only added to the layers it can cast into; afterwards all layers are
+// rendered with a single instanced draw call per mesh (batch). The layer of an instance is
+// read from instance attribute 7 and its model matrix from attributes 3 to 6. The vertex
+// shader writes gl_Layer itself when GL_ARB_shader_viewport_layer_array (or
+// GL_AMD_vertex_shader_layer) is supported, otherwise a pass-through geometry shader
+// routes each triangle to its layer.
+class ShadowPass
+{
+public:
+    // whether the vertex shader can select the layer (if not, use the geometry shader fallback)
+    bool VertexLayer;
+    // statistics of the last pass
+    unsigned int CastersAdded, InstancesAdded;
+
+    // constructor queries the layered rendering support and creates the instance buffer
+    // ------------------------------------------------------------------------
+    ShadowPass(unsigned int batchCount = 1) : CastersAdded(0), InstancesAdded(0), batches(batchCount), bufferCapacity(0)
+    {
+        VertexLayer = hasExtension("GL_ARB_shader_viewport_layer_array") || hasExtension("GL_AMD_vertex_shader_layer");
+        glGenBuffers(1, &instanceVBO);
+    }
+    void Delete()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+    }
+    // starts a new pass for the given layers; layerMatrices holds the view-projection matrix of each
+    // layer and only the layers that are enabled in the (optional) mask receive instances
+    // ------------------------------------------------------------------------
+    void Begin(const std::vector<glm::mat4> &layerMatrices, const std::vector<bool> &layerMask = std::vector<bool>())
+    {
+        layers.clear();
+        for (unsigned int i = 0; i < layerMatrices.size(); ++i)
+        {
+            if (layerMask.empty() || layerMask[i])
+                layers.push_back({ (int)i, frustumPlanes(layerMatrices[i]) });
+        }
+        for (auto &batch : batches)
+            batch.clear();
+        CastersAdded = InstancesAdded = 0;
+    }
+    // adds a caster to every layer its bounding sphere (center and radius in model space) intersects
+    // ------------------------------------------------------------------------
+    void Add(unsigned int batch, const glm::mat4 &model, const glm::vec3 &center, float radius)
+    {
+        const glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+        const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        const float worldRadius = radius * scale;
+        for (const Layer &layer : layers)
+        {
+            if (!sphereInFrustum(layer.Planes, worldCenter, worldRadius))
+                continue;
+            ShadowInstance instance;
+            instance.Model = model;
+            instance.Layer = layer.Index;
+            batches[batch].push_back(instance);
+            InstancesAdded++;
+        }
+        CastersAdded++;
+    }
+    // uploads the instances of all batches; call once after adding all casters
+    // ------------------------------------------------------------------------
+    void Upload()
+    {
+        batchOffsets.clear();
+        size_t count = 0;
+        for (const auto &batch : batches)
+        {
+            batchOffsets.push_back(count);
+            count += batch.size();
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (count > bufferCapacity)
+        {
+            bufferCapacity = std::max(count, bufferCapacity * 2);
+            glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(ShadowInstance), NULL, GL_STREAM_DRAW);
+        }
+        for (unsigned int i = 0; i < batches.size(); ++i)
+        {
+            if (!batches[i].empty())
+                glBufferSubData(GL_ARRAY_BUFFER, batchOffsets[i] * sizeof(ShadowInstance), batches[i].size() * sizeof(ShadowInstance), &batches[i][0]);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // draws all instances of a batch with a mesh (vao with its position at attribute 0) of vertexCount vertices
+    // ------------------------------------------------------------------------
+    void Draw(unsigned int batch, unsigned int vao, unsigned int vertexCount)
+    {
+        if (batches[batch].empty())
+            return;
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        const size_t base = batchOffsets[batch] * sizeof(ShadowInstance);
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            glEnableVertexAttribArray(3 + i);
+            glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(ShadowInstance), (void*)(base + i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + i, 1);
+        }
+        glEnableVertexAttribArray(7);
+        glVertexAttribIPointer(7, 1, GL_INT, sizeof(ShadowInstance), (void*)(base + offsetof(ShadowInstance, Layer)));
+        glVertexAttribDivisor(7, 1);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, (GLsizei)batches[batch].size());
+        // leave the mesh's vao as we found it for regular (non instanced) rendering
+        for (unsigned int i = 3; i <= 7; ++i)
+        {
+            glVertexAttribDivisor(i, 0);
+            glDisableVertexAttribArray(i);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+private:
+    struct Layer {
+        int Index;
+        std::array<glm::vec4, 6> Planes;
+    };
+    std::vector<Layer> layers;
+    std::vector<std::vector<ShadowInstance>> batches;
+    std::vector<size_t> batchOffsets;
+    unsigned int instanceVBO;
+    size_t bufferCapacity;
+
+    static bool hasExtension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+                return true;
+        }
+        return false;
+    }
+    // extracts the 6 frustum planes (normals pointing inwards) of a view-projection matrix
+    static std::array<glm::vec4, 6> frustumPlanes(const glm::mat4 &projview)
+    {
+        const glm::mat4 m = glm::transpose(projview);
+        std::array<glm::vec4, 6> planes = {
+            m[3] + m[0], m[3] - m[0], // left, right
+            m[3] + m[1], m[3] - m[1], // bottom, top
+            m[3] + m[2], m[3] - m[2], // near, far
+        };
+        for (auto &plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        return planes;
+    }
+    static bool sphereInFrustum(const std::array<glm::vec4, 6> &planes, const glm::vec3 &center, float radius)
+    {
+        for (const auto &plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+#endif
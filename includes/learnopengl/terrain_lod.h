@@ -0,0 +1,529 @@
+#ifndef TERRAIN_LOD_H
+#define TERRAIN_LOD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/file_hash.h>
+#include <learnopengl/shader_m.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// A heightmap split into a complete quadtree of chunks, stored on disk so the chunks can be streamed in one at a
+// time. Every node has the same grid of GRID x GRID quads: the leaves sample the heightmap at every pixel, each
+// level above at every second sample of the level below, so a node's vertices are every second vertex of its
+// children. The file holds a header (magic, version, hash of the heightmap file, its size and the level count),
+// the geometric error of every level, a table of all nodes' height bounds, and then every node's heights as bytes.
+// Nodes are indexed level by level, row by row; nodes that would start outside the heightmap don't exist.
+class TerrainPack
+{
+public:
+    static const uint32_t GRID = 64;
+    static const uint32_t VERTICES = GRID + 1;
+    static const uint32_t NODE_SIZE = VERTICES * VERTICES;
+
+    struct NodeBounds {
+        uint8_t MinHeight, MaxHeight;
+    };
+
+    uint32_t Width = 0, Height = 0, Levels = 0;
+    std::vector<float> LevelErrors;     // largest height difference between a level's surface and the heightmap
+    std::vector<NodeBounds> Bounds;     // of every node's samples and all its descendants' samples
+    std::vector<uint32_t> LevelOffsets; // index of every level's first node
+
+    // splits a heightmap (first channel of every pixel) into a pack
+    // ------------------------------------------------------------------------
+    static bool Build(const std::string &path, uint64_t sourceHash, const unsigned char *data, int width, int height, int channels)
+    {
+        TerrainPack pack;
+        pack.setLayout(width, height);
+        auto sample = [&](int u, int v) {
+            u = std::min(std::max(u, 0), width - 1);
+            v = std::min(std::max(v, 0), height - 1);
+            return data[((size_t)v * width + u) * channels];
+        };
+
+        // every level's geometric error: how far its surface, triangulated like the meshes are, is off from the
+        // heightmap at any pixel
+        pack.LevelErrors.assign(pack.Levels, 0.0f);
+        for (uint32_t level = 0; level + 1 < pack.Levels; ++level)
+        {
+            int spacing = pack.spacing(level);
+            float error = 0.0f;
+            for (int v = 0; v < height; ++v)
+            {
+                for (int u = 0; u < width; ++u)
+                {
+                    int u0 = u / spacing * spacing, v0 = v / spacing * spacing;
+                    float fu = float(u - u0) / spacing, fv = float(v - v0) / spacing;
+                    float h00 = sample(u0, v0), h10 = sample(u0 + spacing, v0);
+                    float h01 = sample(u0, v0 + spacing), h11 = sample(u0 + spacing, v0 + spacing);
+                    float surface = fu >= fv ? h00 + fu * (h10 - h00) + fv * (h11 - h10)
+                                             : h00 + fv * (h01 - h00) + fu * (h11 - h01);
+                    error = std::max(error, std::abs(surface - sample(u, v)));
+                }
+            }
+            pack.LevelErrors[level] = error;
+        }
+
+        // the nodes' samples and bounds, leaves first: a leaf samples every pixel it covers, and a node's
+        // bounds also hold its children's, so a node that's culled can't have any finer geometry in view
+        std::vector<uint8_t> heights((size_t)pack.NodeCount() * NODE_SIZE);
+        pack.Bounds.resize(pack.NodeCount());
+        for (int32_t level = (int32_t)pack.Levels - 1; level >= 0; --level)
+        {
+            int spacing = pack.spacing(level);
+            for (uint32_t nv = 0; nv < pack.nodesV(level); ++nv)
+            {
+                for (uint32_t nu = 0; nu < pack.nodesU(level); ++nu)
+                {
+                    uint32_t node = pack.NodeIndex(level, nu, nv);
+                    uint8_t *nodeHeights = &heights[(size_t)node * NODE_SIZE];
+                    NodeBounds bounds = { 255, 0 };
+                    for (uint32_t row = 0; row < VERTICES; ++row)
+                    {
+                        for (uint32_t col = 0; col < VERTICES; ++col)
+                        {
+                            uint8_t h = sample((nu * GRID + col) * spacing, (nv * GRID + row) * spacing);
+                            nodeHeights[row * VERTICES + col] = h;
+                            bounds.MinHeight = std::min(bounds.MinHeight, h);
+                            bounds.MaxHeight = std::max(bounds.MaxHeight, h);
+                        }
+                    }
+                    for (uint32_t child = 0; child < 4 && level + 1 < (int32_t)pack.Levels; ++child)
+                    {
+                        uint32_t cu = nu * 2 + child % 2, cv = nv * 2 + child / 2;
+                        if (!pack.NodeExists(level + 1, cu, cv))
+                            continue;
+                        const NodeBounds &childBounds = pack.Bounds[pack.NodeIndex(level + 1, cu, cv)];
+                        bounds.MinHeight = std::min(bounds.MinHeight, childBounds.MinHeight);
+                        bounds.MaxHeight = std::max(bounds.MaxHeight, childBounds.MaxHeight);
+                    }
+                    pack.Bounds[node] = bounds;
+                }
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::TERRAIN_PACK: Could not write file: " << path << std::endl;
+            return false;
+        }
+        Header header = {};
+        memcpy(header.Magic, "TERR", 4);
+        header.Version = VERSION;
+        header.SourceHash = sourceHash;
+        header.Width = pack.Width;
+        header.Height = pack.Height;
+        header.Levels = pack.Levels;
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)pack.LevelErrors.data(), pack.LevelErrors.size() * sizeof(float));
+        file.write((const char*)pack.Bounds.data(), pack.Bounds.size() * sizeof(NodeBounds));
+        file.write((const char*)heights.data(), heights.size());
+        return (bool)file;
+    }
+    // opens a pack and reads its tables, the heights stay on disk; returns false if it doesn't exist, is corrupt
+    // or was built from another heightmap
+    // ------------------------------------------------------------------------
+    bool Open(const std::string &path, uint64_t sourceHash)
+    {
+        file.open(path, std::ios::binary);
+        if (!file)
+            return false;
+        Header header;
+        file.read((char*)&header, sizeof(header));
+        if (!file || memcmp(header.Magic, "TERR", 4) != 0)
+        {
+            std::cout << "ERROR::TERRAIN_PACK: Invalid file: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        // packs of an older version are rebuilt like stale ones
+        if (header.Version != VERSION || header.SourceHash != sourceHash)
+        {
+            file.close();
+            return false;
+        }
+        setLayout(header.Width, header.Height);
+        if (Levels != header.Levels)
+        {
+            std::cout << "ERROR::TERRAIN_PACK: Invalid file: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        LevelErrors.resize(Levels);
+        Bounds.resize(NodeCount());
+        file.read((char*)LevelErrors.data(), LevelErrors.size() * sizeof(float));
+        file.read((char*)Bounds.data(), Bounds.size() * sizeof(NodeBounds));
+        heightsOffset = file.tellg();
+        if (!file)
+        {
+            std::cout << "ERROR::TERRAIN_PACK: File is truncated: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        return true;
+    }
+    // reads a node's NODE_SIZE heights from disk
+    // ------------------------------------------------------------------------
+    bool ReadNode(uint32_t node, uint8_t *heights)
+    {
+        file.seekg(heightsOffset + (std::streamoff)node * NODE_SIZE);
+        file.read((char*)heights, NODE_SIZE);
+        if (!file)
+        {
+            std::cout << "ERROR::TERRAIN_PACK: Could not read node " << node << std::endl;
+            file.clear();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t NodeCount() const
+    {
+        return LevelOffsets.back();
+    }
+    uint32_t NodeIndex(uint32_t level, uint32_t nu, uint32_t nv) const
+    {
+        return LevelOffsets[level] + nv * nodesU(level) + nu;
+    }
+    // whether a node of the level starts inside the heightmap
+    bool NodeExists(uint32_t level, uint32_t nu, uint32_t nv) const
+    {
+        return nu < nodesU(level) && nv < nodesV(level);
+    }
+    // distance between a level's samples, in pixels
+    int spacing(uint32_t level) const
+    {
+        return 1 << (Levels - 1 - level);
+    }
+    uint32_t nodesU(uint32_t level) const
+    {
+        return (Width - 2) / (GRID * spacing(level)) + 1;
+    }
+    uint32_t nodesV(uint32_t level) const
+    {
+        return (Height - 2) / (GRID * spacing(level)) + 1;
+    }
+
+private:
+    static const uint32_t VERSION = 2;
+    struct Header {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t SourceHash;
+        uint32_t Width, Height, Levels, Padding;
+    };
+    std::ifstream file;
+    std::streamoff heightsOffset = 0;
+
+    // enough levels for the root to cover the heightmap's (width - 1) x (height - 1) quads
+    void setLayout(uint32_t width, uint32_t height)
+    {
+        Width = width;
+        Height = height;
+        Levels = 1;
+        while ((GRID << (Levels - 1)) < std::max(Width, Height) - 1)
+            Levels++;
+        LevelOffsets.assign(1, 0);
+        for (uint32_t level = 0; level < Levels; ++level)
+            LevelOffsets.push_back(LevelOffsets.back() + nodesU(level) * nodesV(level));
+    }
+};
+
+// Statistics of the last frame
+struct TerrainLODStats {
+    unsigned int NodesDrawn;
+    unsigned int VerticesDrawn;
+    unsigned int NodesLoaded;   // streamed in from disk this frame
+    unsigned int NodesResident;
+};
+
+// Draws a TerrainPack with continuous level of detail: every frame the quadtree is walked from the root, nodes
+// outside the view frustum are culled by their bounds and a node is split while the camera is closer than its
+// level's range. A level's range is where its geometric error, projected to the screen, reaches MaxPixelError.
+// The ranges at least double from level to level and are kept well beyond the nodes' size, so neighboring nodes
+// are never more than a level apart. Towards the end of its range every vertex morphs to the height of its
+// parent's surface, so a node has become its parent's shape by the time it's replaced by it and neither
+// switches nor cracks between levels show.
+// Resident nodes live in the slots of one vertex buffer, all sharing a single index buffer of the node grid.
+// Nodes are loaded from disk the first time they're needed, a few per frame; until then their parent is drawn in
+// their place. When all slots are taken, the least recently used node is evicted.
+class TerrainLOD
+{
+public:
+    float MaxPixelError = 2.0f;          // screen-space error the level ranges are computed for
+    unsigned int MaxLoadsPerFrame = 8;   // nodes streamed in per frame
+    float HeightScale, HeightShift;      // world height of a heightmap value h is h * HeightScale - HeightShift
+
+    TerrainLOD(TerrainPack &pack, unsigned int slotCount, float heightScale, float heightShift)
+        : HeightScale(heightScale), HeightShift(heightShift), pack(pack), slotCount(slotCount), frame(0)
+    {
+        slotOfNode.assign(pack.NodeCount(), -1);
+        requested.assign(pack.NodeCount(), false);
+        nodeOfSlot.assign(slotCount, -1);
+        slotLastUsed.assign(slotCount, 0);
+
+        // the node grid, with every quad split along the same diagonal as the geometric error assumes
+        std::vector<uint16_t> indices;
+        for (uint32_t row = 0; row < TerrainPack::GRID; ++row)
+        {
+            for (uint32_t col = 0; col < TerrainPack::GRID; ++col)
+            {
+                uint16_t a = row * TerrainPack::VERTICES + col, b = a + 1;
+                uint16_t c = a + TerrainPack::VERTICES, d = c + 1;
+                uint16_t quad[] = { a, b, d, a, d, c };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+        indexCount = indices.size();
+
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)slotCount * TerrainPack::NODE_SIZE * 2 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        // height and height on the parent's surface
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glGenBuffers(1, &ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+        glBindVertexArray(0);
+
+        // the root level is always resident
+        for (uint32_t node = 0; node < pack.LevelOffsets[1] && node < slotCount; ++node)
+            load(node);
+    }
+    void Delete()
+    {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ibo);
+    }
+    // selects the nodes to draw for the camera and streams in the ones missing
+    // ------------------------------------------------------------------------
+    void Update(const glm::vec3 &cameraPosition, const glm::mat4 &projection, const glm::mat4 &view, float viewportHeight)
+    {
+        frame++;
+        ranges = levelRanges(projection, viewportHeight);
+        glm::mat4 projview = projection * view;
+        std::array<glm::vec4, 6> planes = frustumPlanes(projview);
+
+        selected.clear();
+        requests.clear();
+        for (uint32_t nv = 0; nv < pack.nodesV(0); ++nv)
+            for (uint32_t nu = 0; nu < pack.nodesU(0); ++nu)
+                select(0, nu, nv, cameraPosition, planes);
+
+        // stream in the missing nodes, coarsest first, as the finer ones need them to be reached
+        stats.NodesLoaded = 0;
+        std::sort(requests.begin(), requests.end());
+        for (uint32_t node : requests)
+        {
+            requested[node] = false;
+            if (stats.NodesLoaded < MaxLoadsPerFrame && load(node))
+                stats.NodesLoaded++;
+        }
+
+        stats.NodesDrawn = selected.size();
+        stats.VerticesDrawn = selected.size() * TerrainPack::NODE_SIZE;
+        stats.NodesResident = 0;
+        for (int node : nodeOfSlot)
+            stats.NodesResident += node != -1;
+    }
+    // draws the selected nodes; the shader takes the vertex layout and uniforms of 8.3.cpuheight_lod.vs
+    // ------------------------------------------------------------------------
+    void Draw(Shader &shader, const glm::vec3 &cameraPosition)
+    {
+        shader.setVec3("cameraPosition", cameraPosition);
+        shader.setVec2("terrainMax", worldPosition(pack.Width - 1, pack.Height - 1));
+        glBindVertexArray(vao);
+        for (const Selection &node : selected)
+        {
+            int spacing = pack.spacing(node.Level);
+            uint32_t nodeSpan = TerrainPack::GRID * spacing;
+            shader.setVec2("nodeOrigin", worldPosition(node.U * nodeSpan, node.V * nodeSpan));
+            shader.setFloat("nodeSpacing", (float)spacing);
+            // morphs to the parent's surface over the last part of the parent's range
+            float morphEnd = node.Level > 0 ? ranges[node.Level - 1] : 1e30f;
+            shader.setVec2("morphRange", glm::vec2(morphEnd * MORPH_START, morphEnd));
+            glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_SHORT, 0, slotOfNode[node.Node] * TerrainPack::NODE_SIZE);
+        }
+        glBindVertexArray(0);
+    }
+    const TerrainLODStats &Stats() const
+    {
+        return stats;
+    }
+
+private:
+    // fraction of the range after which the nodes start to morph to their parent
+    static constexpr float MORPH_START = 0.85f;
+
+    struct Selection {
+        uint32_t Node, Level, U, V;
+    };
+    TerrainPack &pack;
+    unsigned int vao, vbo, ibo, indexCount;
+    unsigned int slotCount;
+    std::vector<int> slotOfNode, nodeOfSlot;
+    std::vector<uint64_t> slotLastUsed;
+    std::vector<bool> requested;
+    std::vector<uint32_t> requests;
+    std::vector<Selection> selected;
+    std::vector<float> ranges;
+    uint64_t frame;
+    TerrainLODStats stats = {};
+
+    // world (x, z) of a heightmap pixel, as the original sample places them: rows along x, columns along z
+    glm::vec2 worldPosition(float u, float v) const
+    {
+        return glm::vec2(v - pack.Height / 2.0f, u - pack.Width / 2.0f);
+    }
+    // camera distance up to which every level is split into the next
+    std::vector<float> levelRanges(const glm::mat4 &projection, float viewportHeight) const
+    {
+        // pixels per world unit at distance 1
+        float pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+        float heightSpan = 255.0f * HeightScale;
+        std::vector<float> levelRange(pack.Levels, 0.0f);
+        for (int level = (int)pack.Levels - 2; level >= 0; --level)
+        {
+            float errorRange = pack.LevelErrors[level] * HeightScale * pixelsPerUnit / MaxPixelError;
+            // a node's extent, so a node's neighbors can't be further than a level apart
+            float nodeSpan = float(TerrainPack::GRID * pack.spacing(level));
+            float nodeDiagonal = std::sqrt(2.0f) * nodeSpan + heightSpan;
+            levelRange[level] = std::max(std::max(errorRange, 2.5f * nodeDiagonal), 2.0f * levelRange[level + 1]);
+        }
+        return levelRange;
+    }
+    void select(uint32_t level, uint32_t nu, uint32_t nv, const glm::vec3 &cameraPosition, const std::array<glm::vec4, 6> &planes)
+    {
+        uint32_t node = pack.NodeIndex(level, nu, nv);
+        if (slotOfNode[node] == -1)
+            return;
+        slotLastUsed[slotOfNode[node]] = frame;
+
+        // bounds
+        uint32_t nodeSpan = TerrainPack::GRID * pack.spacing(level);
+        glm::vec2 minXZ = worldPosition(nu * nodeSpan, nv * nodeSpan);
+        glm::vec2 maxXZ = glm::min(worldPosition((nu + 1) * nodeSpan, (nv + 1) * nodeSpan), worldPosition(pack.Width - 1, pack.Height - 1));
+        glm::vec3 boundsMin(minXZ.x, pack.Bounds[node].MinHeight * HeightScale - HeightShift, minXZ.y);
+        glm::vec3 boundsMax(maxXZ.x, pack.Bounds[node].MaxHeight * HeightScale - HeightShift, maxXZ.y);
+        if (!boxInFrustum(planes, boundsMin, boundsMax))
+            return;
+
+        float distance = glm::length(glm::max(glm::max(boundsMin - cameraPosition, cameraPosition - boundsMax), glm::vec3(0.0f)));
+        bool split = level + 1 < pack.Levels && distance < ranges[level];
+        if (split)
+        {
+            // only split once all children are resident, request the ones that aren't
+            for (uint32_t child = 0; child < 4; ++child)
+            {
+                uint32_t cu = nu * 2 + child % 2, cv = nv * 2 + child / 2;
+                if (!pack.NodeExists(level + 1, cu, cv))
+                    continue;
+                uint32_t childNode = pack.NodeIndex(level + 1, cu, cv);
+                if (slotOfNode[childNode] == -1)
+                {
+                    split = false;
+                    if (!requested[childNode])
+                    {
+                        requested[childNode] = true;
+                        requests.push_back(childNode);
+                    }
+                }
+            }
+        }
+        if (!split)
+        {
+            selected.push_back({ node, level, nu, nv });
+            return;
+        }
+        for (uint32_t child = 0; child < 4; ++child)
+        {
+            uint32_t cu = nu * 2 + child % 2, cv = nv * 2 + child / 2;
+            if (pack.NodeExists(level + 1, cu, cv))
+                select(level + 1, cu, cv, cameraPosition, planes);
+        }
+    }
+    // reads a node from disk into a free slot or the least recently used one; false if all slots are in use
+    bool load(uint32_t node)
+    {
+        int slot = -1;
+        for (unsigned int i = 0; i < slotCount; ++i)
+        {
+            // the root level is never evicted, nor is anything used this frame
+            bool evictable = nodeOfSlot[i] == -1 || (nodeOfSlot[i] >= (int)pack.LevelOffsets[1] && slotLastUsed[i] < frame);
+            if (evictable && (slot == -1 || nodeOfSlot[i] == -1 || (nodeOfSlot[slot] != -1 && slotLastUsed[i] < slotLastUsed[slot])))
+                slot = i;
+        }
+        if (slot == -1)
+            return false;
+
+        uint8_t heights[TerrainPack::NODE_SIZE];
+        if (!pack.ReadNode(node, heights))
+            return false;
+        if (nodeOfSlot[slot] != -1)
+            slotOfNode[nodeOfSlot[slot]] = -1;
+        nodeOfSlot[slot] = node;
+        slotOfNode[node] = slot;
+        slotLastUsed[slot] = frame;
+
+        // every vertex's height and its height on the parent's surface: the parent's vertices are the even ones,
+        // the odd ones lie on the parent's edges and diagonals
+        const uint32_t N = TerrainPack::VERTICES;
+        auto h = [&](uint32_t col, uint32_t row) { return heights[row * N + col] * HeightScale - HeightShift; };
+        std::vector<float> vertices(TerrainPack::NODE_SIZE * 2);
+        for (uint32_t row = 0; row < N; ++row)
+        {
+            for (uint32_t col = 0; col < N; ++col)
+            {
+                float height = h(col, row), parentHeight = height;
+                if (col % 2 == 1 && row % 2 == 1)
+                    parentHeight = 0.5f * (h(col - 1, row - 1) + h(col + 1, row + 1));
+                else if (col % 2 == 1)
+                    parentHeight = 0.5f * (h(col - 1, row) + h(col + 1, row));
+                else if (row % 2 == 1)
+                    parentHeight = 0.5f * (h(col, row - 1) + h(col, row + 1));
+                vertices[(row * N + col) * 2] = height;
+                vertices[(row * N + col) * 2 + 1] = parentHeight;
+            }
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)slot * TerrainPack::NODE_SIZE * 2 * sizeof(float), vertices.size() * sizeof(float), vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+    // extracts the 6 frustum planes (normals pointing inwards) of a view-projection matrix
+    static std::array<glm::vec4, 6> frustumPlanes(const glm::mat4 &projview)
+    {
+        glm::mat4 m = glm::transpose(projview);
+        std::array<glm::vec4, 6> planes = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+        for (glm::vec4 &plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        return planes;
+    }
+    static bool boxInFrustum(const std::array<glm::vec4, 6> &planes, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+    {
+        for (const glm::vec4 &plane : planes)
+        {
+            // the corner furthest along the plane's normal
+            glm::vec3 corner(plane.x > 0.0f ? boundsMax.x : boundsMin.x, plane.y > 0.0f ? boundsMax.y : boundsMin.y, plane.z > 0.0f ? boundsMax.z : boundsMin.z);
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,138 @@
+#ifndef TRANSPARENT_SORT_H
+#define TRANSPARENT_SORT_H
+
+#include <glm/glm.hpp>
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Orders transparent objects from farthest to nearest for back to front blending.
+// Every object gets a 32 bit key from its squared distance to the camera, with the float's bits flipped so that
+// comparing them as unsigned integers orders the objects back to front. The (key, index) pairs are sorted by a least
+// significant digit radix sort (4 passes of 8 bits) into a scratch buffer that's reused from frame to frame, so
+// sorting doesn't allocate once the object count settles. The sort is stable, so objects at equal distances are
+// all kept, in the order of their indices.
+// If the camera moved less than CoherenceDistance since the last sort, last frame's order is likely still close
+// to right, so the keys are computed in that order and fixed up by an insertion sort instead. That's linear in the
+// number of objects as long as few of them swap places; once the shifts exceed MaxShiftsPerObject per object the
+// insertion sort gives up and the radix sort is used after all.
+class TransparentSort
+{
+public:
+    float CoherenceDistance;         // camera movement since the last sort, below which its order is reused
+    unsigned int MaxShiftsPerObject; // insertion sort budget, relative to the object count
+
+    TransparentSort() : CoherenceDistance(0.25f), MaxShiftsPerObject(8), incremental(false), sorted(false), lastViewPosition(0.0f)
+    {
+    }
+    // returns the indices of positions ordered from farthest to nearest to viewPosition
+    // ------------------------------------------------------------------------
+    const std::vector<unsigned int>& SortBackToFront(const glm::vec3& viewPosition, const std::vector<glm::vec3>& positions)
+    {
+        size_t count = positions.size();
+        incremental = false;
+        if (sorted && count == order.size() && glm::length(viewPosition - lastViewPosition) < CoherenceDistance)
+        {
+            pairs.resize(count);
+            for (size_t i = 0; i < count; i++)
+                pairs[i] = { backToFrontKey(viewPosition, positions[order[i]]), order[i] };
+            incremental = insertionSort(count * MaxShiftsPerObject);
+        }
+        if (!incremental)
+        {
+            pairs.resize(count);
+            for (size_t i = 0; i < count; i++)
+                pairs[i] = { backToFrontKey(viewPosition, positions[i]), (unsigned int)i };
+            radixSort();
+        }
+
+        order.resize(count);
+        for (size_t i = 0; i < count; i++)
+            order[i] = pairs[i].Index;
+        lastViewPosition = viewPosition;
+        sorted = true;
+        return order;
+    }
+    // whether the last sort was the insertion sort of the previous order
+    bool LastSortIncremental() const
+    {
+        return incremental;
+    }
+
+private:
+    struct Pair {
+        unsigned int Key;
+        unsigned int Index;
+    };
+    std::vector<Pair> pairs, scratch;
+    std::vector<unsigned int> order;
+    bool incremental, sorted;
+    glm::vec3 lastViewPosition;
+
+    // the squared distance's bits, flipped so that unsigned integer order is float order (negative floats have
+    // all bits flipped, positive ones only the sign bit), then inverted for farthest first
+    static unsigned int backToFrontKey(const glm::vec3& viewPosition, const glm::vec3& position)
+    {
+        glm::vec3 offset = position - viewPosition;
+        float distance = glm::dot(offset, offset);
+        unsigned int bits;
+        std::memcpy(&bits, &distance, sizeof(bits));
+        bits ^= (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+        return ~bits;
+    }
+    void radixSort()
+    {
+        if (pairs.empty())
+            return;
+        scratch.resize(pairs.size());
+
+        // the histograms of all 4 digits in one pass over the keys
+        size_t counts[4][256] = {};
+        for (const Pair &pair : pairs)
+            for (int digit = 0; digit < 4; digit++)
+                counts[digit][(pair.Key >> (digit * 8)) & 0xFF]++;
+
+        for (int digit = 0; digit < 4; digit++)
+        {
+            // a digit all keys share doesn't change the order
+            size_t *count = counts[digit];
+            if (count[(pairs[0].Key >> (digit * 8)) & 0xFF] == pairs.size())
+                continue;
+
+            size_t offsets[256];
+            size_t offset = 0;
+            for (int bucket = 0; bucket < 256; bucket++)
+            {
+                offsets[bucket] = offset;
+                offset += count[bucket];
+            }
+            for (const Pair &pair : pairs)
+                scratch[offsets[(pair.Key >> (digit * 8)) & 0xFF]++] = pair;
+            std::swap(pairs, scratch);
+        }
+    }
+    // returns false, leaving the pairs partly sorted, once more than maxShifts shifts were needed
+    bool insertionSort(size_t maxShifts)
+    {
+        size_t shifts = 0;
+        for (size_t i = 1; i < pairs.size(); i++)
+        {
+            Pair pair = pairs[i];
+            size_t j = i;
+            while (j > 0 && pairs[j - 1].Key > pair.Key)
+            {
+                pairs[j] = pairs[j - 1];
+                j--;
+                if (++shifts > maxShifts)
+                {
+                    pairs[j] = pair;
+                    return false;
+                }
+            }
+            pairs[j] = pair;
+        }
+        return true;
+    }
+};
+#endif
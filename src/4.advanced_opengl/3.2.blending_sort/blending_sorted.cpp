@@ -10,14 +10,19 @@
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/transparent_sort.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <random>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
+void runSortScaleTest();
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -33,6 +38,9 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// times the sorts on a large number of transparent quads
+bool scaleTestKeyPressed = false;
+
 int main()
 {
     // glfw: initialize and configure
@@ -204,6 +212,11 @@ int main()
     shader.use();
     shader.setInt("texture1", 0);
 
+    // sorts the windows every frame without allocating, reusing last frame's order while the camera moves little
+    TransparentSort transparentSort;
+
+    std::cout << "Press T to time the sorts on 100000 transparent quads" << std::endl;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -220,12 +233,7 @@ int main()
 
         // sort the transparent windows before rendering
         // ---------------------------------------------
-        std::map<float, glm::vec3> sorted;
-        for (unsigned int i = 0; i < windows.size(); i++)
-        {
-            float distance = glm::length(camera.Position - windows[i]);
-            sorted[distance] = windows[i];
-        }
+        const std::vector<unsigned int>& sorted = transparentSort.SortBackToFront(camera.Position, windows);
 
         // render
         // ------
@@ -259,10 +267,10 @@ int main()
         // windows (from furthest to nearest)
         glBindVertexArray(transparentVAO);
         glBindTexture(GL_TEXTURE_2D, transparentTexture);
-        for (std::map<float, glm::vec3>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it)
+        for (unsigned int i = 0; i < sorted.size(); i++)
         {
             model = glm::mat4(1.0f);
-            model = glm::translate(model, it->second);
+            model = glm::translate(model, windows[sorted[i]]);
             shader.setMat4("model", model);
             glDrawArrays(GL_TRIANGLES, 0, 6);
         }
@@ -300,6 +308,77 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !scaleTestKeyPressed)
+    {
+        runSortScaleTest();
+        scaleTestKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+        scaleTestKeyPressed = false;
+}
+
+// sorts 100000 quads scattered around the camera with a std::map as above, with std::sort and with TransparentSort,
+// both from scratch and after a small camera movement
+// ---------------------------------------------------------------------------------------------------------
+void runSortScaleTest()
+{
+    const unsigned int QUAD_COUNT = 100000;
+    const int REPEATS = 10;
+    std::mt19937 random(0);
+    // positions on a grid, so many quads are at exactly the same distance
+    std::uniform_int_distribution<int> coordinate(-40, 40);
+    std::vector<glm::vec3> quads(QUAD_COUNT);
+    for (glm::vec3& quad : quads)
+        quad = glm::vec3(coordinate(random), coordinate(random) * 0.25f, coordinate(random));
+    glm::vec3 viewPosition = camera.Position;
+    glm::vec3 viewMovement = camera.Front * 0.01f;
+
+    auto time = [&](const auto& sort) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < REPEATS; i++)
+            sort(i);
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count() / REPEATS;
+    };
+
+    size_t mapSize = 0;
+    double mapTime = time([&](int) {
+        std::map<float, glm::vec3> sorted;
+        for (const glm::vec3& quad : quads)
+            sorted[glm::length(viewPosition - quad)] = quad;
+        mapSize = sorted.size();
+    });
+
+    std::vector<unsigned int> indices(QUAD_COUNT);
+    double stdSortTime = time([&](int) {
+        for (unsigned int i = 0; i < QUAD_COUNT; i++)
+            indices[i] = i;
+        std::sort(indices.begin(), indices.end(), [&](unsigned int a, unsigned int b) {
+            return glm::length(viewPosition - quads[a]) > glm::length(viewPosition - quads[b]);
+        });
+    });
+
+    // a new sorter every time, so it can't reuse the previous order
+    double radixTime = time([&](int) {
+        TransparentSort sort;
+        sort.SortBackToFront(viewPosition, quads);
+    });
+
+    // one sorter following the camera as it moves a little every frame
+    TransparentSort coherentSort;
+    coherentSort.SortBackToFront(viewPosition, quads);
+    int incrementalSorts = 0;
+    double coherentTime = time([&](int i) {
+        coherentSort.SortBackToFront(viewPosition + viewMovement * float(i + 1), quads);
+        incrementalSorts += coherentSort.LastSortIncremental();
+    });
+
+    std::cout << QUAD_COUNT << " quads:" << std::endl;
+    std::cout << "    std::map: " << mapTime << " ms, " << QUAD_COUNT - mapSize << " quads lost at equal distances" << std::endl;
+    std::cout << "    std::sort: " << stdSortTime << " ms" << std::endl;
+    std::cout << "    radix sort: " << radixTime << " ms" << std::endl;
+    std::cout << "    radix sort, moving camera: " << coherentTime << " ms, " << incrementalSorts << " of " << REPEATS << " sorts incremental" << std::endl;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 Position;
+
+uniform vec3 color;
+
+void main()
+{    
+    vec3 lightDir = normalize(vec3(0.3, 1.0, 0.5));
+    float diff = max(dot(normalize(Normal), lightDir), 0.0);
+    FragColor = vec4(color * (0.3 + 0.7 * diff), 1.0);
+}
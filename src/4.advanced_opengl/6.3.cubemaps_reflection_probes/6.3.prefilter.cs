@@ -0,0 +1,168 @@
+#version 430 core
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+// Filtered importance sampling of the pre-filter map: every sample reads the environment's mip whose texel
+// solid angle matches the sample's solid angle (from its pdf), so far fewer samples are needed than with a
+// fixed sample count. The sample count grows with the roughness (one sample for the mirror-like first mip).
+// A single dispatch writes every mip and face: the work groups of all mips are laid out after each other.
+// Dispatching a range of them starting at firstGroup filters part of the mips, e.g. one mip at a time.
+
+uniform samplerCube environmentMap;
+uniform float environmentResolution; // face size of the environment map's first mip
+uniform int prefilterSize;           // face size of the pre-filter map's first mip
+uniform int mipLevels;
+uniform int baseSampleCount;         // samples per texel are baseSampleCount << mip...
+uniform int maxSampleCount;          // ...up to maxSampleCount
+uniform uint firstGroup;             // of the dispatched range of work groups
+
+// one image per mip of the pre-filter map (up to 5 mips)
+layout (rgba16f, binding = 0) uniform writeonly imageCube prefilterMip0;
+layout (rgba16f, binding = 1) uniform writeonly imageCube prefilterMip1;
+layout (rgba16f, binding = 2) uniform writeonly imageCube prefilterMip2;
+layout (rgba16f, binding = 3) uniform writeonly imageCube prefilterMip3;
+layout (rgba16f, binding = 4) uniform writeonly imageCube prefilterMip4;
+
+const float PI = 3.14159265359;
+// ----------------------------------------------------------------------------
+float DistributionGGX(vec3 N, vec3 H, float roughness)
+{
+    float a = roughness*roughness;
+    float a2 = a*a;
+    float NdotH = max(dot(N, H), 0.0);
+    float NdotH2 = NdotH*NdotH;
+
+    float nom   = a2;
+    float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+    denom = PI * denom * denom;
+
+    return nom / denom;
+}
+// ----------------------------------------------------------------------------
+// http://holger.dammertz.org/stuff/notes_HammersleyOnHemisphere.html
+// efficient VanDerCorpus calculation.
+float RadicalInverse_VdC(uint bits) 
+{
+     bits = (bits << 16u) | (bits >> 16u);
+     bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+     bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+     bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+     bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+     return float(bits) * 2.3283064365386963e-10; // / 0x100000000
+}
+// ----------------------------------------------------------------------------
+vec2 Hammersley(uint i, uint N)
+{
+	return vec2(float(i)/float(N), RadicalInverse_VdC(i));
+}
+// ----------------------------------------------------------------------------
+vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float roughness)
+{
+	float a = roughness*roughness;
+	
+	float phi = 2.0 * PI * Xi.x;
+	float cosTheta = sqrt((1.0 - Xi.y) / (1.0 + (a*a - 1.0) * Xi.y));
+	float sinTheta = sqrt(1.0 - cosTheta*cosTheta);
+	
+	// from spherical coordinates to cartesian coordinates - halfway vector
+	vec3 H;
+	H.x = cos(phi) * sinTheta;
+	H.y = sin(phi) * sinTheta;
+	H.z = cosTheta;
+	
+	// from tangent-space H vector to world-space sample vector
+	vec3 up          = abs(N.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+	vec3 tangent   = normalize(cross(up, N));
+	vec3 bitangent = cross(N, tangent);
+	
+	vec3 sampleVec = tangent * H.x + bitangent * H.y + N * H.z;
+	return normalize(sampleVec);
+}
+// ----------------------------------------------------------------------------
+// direction through a texel of a cubemap face (OpenGL cube map face selection table)
+vec3 CubemapDirection(int face, vec2 uv)
+{
+    vec2 st = 2.0 * uv - 1.0;
+    vec3 direction;
+    if (face == 0)      direction = vec3( 1.0, -st.y, -st.x); // +X
+    else if (face == 1) direction = vec3(-1.0, -st.y,  st.x); // -X
+    else if (face == 2) direction = vec3( st.x,  1.0,  st.y); // +Y
+    else if (face == 3) direction = vec3( st.x, -1.0, -st.y); // -Y
+    else if (face == 4) direction = vec3( st.x, -st.y,  1.0); // +Z
+    else                direction = vec3(-st.x, -st.y, -1.0); // -Z
+    return normalize(direction);
+}
+// ----------------------------------------------------------------------------
+void StorePrefiltered(int mip, ivec3 coord, vec4 color)
+{
+    // image arrays can't be indexed per invocation, so select the mip's image explicitly
+    switch (mip)
+    {
+    case 0: imageStore(prefilterMip0, coord, color); break;
+    case 1: imageStore(prefilterMip1, coord, color); break;
+    case 2: imageStore(prefilterMip2, coord, color); break;
+    case 3: imageStore(prefilterMip3, coord, color); break;
+    default: imageStore(prefilterMip4, coord, color); break;
+    }
+}
+// ----------------------------------------------------------------------------
+void main()
+{
+    // find the mip, face and 8x8 tile of this work group
+    uint group = gl_WorkGroupID.x + firstGroup;
+    int mip = 0;
+    int size = prefilterSize;
+    uint tiles = uint((size + 7) / 8);
+    while (group >= tiles * tiles * 6u && mip < mipLevels - 1)
+    {
+        group -= tiles * tiles * 6u;
+        mip++;
+        size = max(size / 2, 1);
+        tiles = uint((size + 7) / 8);
+    }
+    int face = int(group / (tiles * tiles));
+    uint tile = group % (tiles * tiles);
+    ivec2 texel = ivec2(tile % tiles, tile / tiles) * 8 + ivec2(gl_LocalInvocationID.xy);
+    if (texel.x >= size || texel.y >= size)
+        return;
+
+    vec3 N = CubemapDirection(face, (vec2(texel) + 0.5) / float(size));
+    
+    // make the simplifying assumption that V equals R equals the normal 
+    vec3 R = N;
+    vec3 V = R;
+
+    float roughness = float(mip) / float(mipLevels - 1);
+    uint sampleCount = mip == 0 ? 1u : uint(min(baseSampleCount << mip, maxSampleCount));
+    vec3 prefilteredColor = vec3(0.0);
+    float totalWeight = 0.0;
+    
+    for(uint i = 0u; i < sampleCount; ++i)
+    {
+        // generates a sample vector that's biased towards the preferred alignment direction (importance sampling).
+        vec2 Xi = Hammersley(i, sampleCount);
+        vec3 H = ImportanceSampleGGX(Xi, N, roughness);
+        vec3 L  = normalize(2.0 * dot(V, H) * H - V);
+
+        float NdotL = max(dot(N, L), 0.0);
+        if(NdotL > 0.0)
+        {
+            // sample from the environment's mip level based on roughness/pdf
+            float D   = DistributionGGX(N, H, roughness);
+            float NdotH = max(dot(N, H), 0.0);
+            float HdotV = max(dot(H, V), 0.0);
+            float pdf = D * NdotH / (4.0 * HdotV) + 0.0001; 
+
+            float saTexel  = 4.0 * PI / (6.0 * environmentResolution * environmentResolution);
+            float saSample = 1.0 / (float(sampleCount) * pdf + 0.0001);
+
+            float mipLevel = roughness == 0.0 ? 0.0 : 0.5 * log2(saSample / saTexel); 
+            
+            prefilteredColor += textureLod(environmentMap, L, mipLevel).rgb * NdotL;
+            totalWeight      += NdotL;
+        }
+    }
+
+    prefilteredColor = prefilteredColor / totalWeight;
+
+    StorePrefiltered(mip, ivec3(texel, face), vec4(prefilteredColor, 1.0));
+}
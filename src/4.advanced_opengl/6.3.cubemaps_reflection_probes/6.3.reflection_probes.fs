@@ -0,0 +1,23 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 Position;
+
+uniform vec3 cameraPos;
+// the two nearest probes, blended by probeWeight (the weight of probeA)
+uniform samplerCube probeA;
+uniform samplerCube probeB;
+uniform float probeWeight;
+// rougher surfaces sample the blurrier mips of the probes
+uniform float roughness;
+uniform float maxLod;
+
+void main()
+{    
+    vec3 I = normalize(Position - cameraPos);
+    vec3 R = reflect(I, normalize(Normal));
+    float lod = roughness * maxLod;
+    vec3 color = mix(textureLod(probeB, R, lod).rgb, textureLod(probeA, R, lod).rgb, probeWeight);
+    FragColor = vec4(color, 1.0);
+}
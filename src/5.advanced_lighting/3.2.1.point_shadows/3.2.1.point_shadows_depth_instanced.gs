@@ -0,0 +1,22 @@
+#version 330 core
+layout (triangles) in;
+layout (triangle_strip, max_vertices=3) out;
+
+uniform mat4 shadowMatrices[6];
+
+flat in int Layer[];
+
+out vec4 FragPos; // FragPos from GS (output per emitvertex)
+
+void main()
+{
+    // fallback for when the vertex shader can't write gl_Layer: only emit the triangle to the face of its instance
+    for(int i = 0; i < 3; ++i) // for each triangle's vertices
+    {
+        gl_Layer = Layer[0];
+        FragPos = gl_in[i].gl_Position;
+        gl_Position = shadowMatrices[Layer[0]] * FragPos;
+        EmitVertex();
+    }    
+    EndPrimitive();
+}
@@ -0,0 +1,18 @@
+#version 330 core
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aLayer;
+
+uniform mat4 shadowMatrices[6];
+
+out vec4 FragPos;
+
+void main()
+{
+    // every instance is a caster in a single cube face, so the face is selected right here
+    FragPos = aModel * vec4(aPos, 1.0);
+    gl_Layer = aLayer;
+    gl_Position = shadowMatrices[aLayer] * FragPos;
+}
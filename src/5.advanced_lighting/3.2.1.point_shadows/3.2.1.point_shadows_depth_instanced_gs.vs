@@ -0,0 +1,12 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aLayer;
+
+flat out int Layer;
+
+void main()
+{
+    Layer = aLayer;
+    gl_Position = aModel * vec4(aPos, 1.0);
+}
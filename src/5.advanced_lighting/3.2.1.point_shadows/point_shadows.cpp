@@ -10,8 +10,10 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/shadow_pass.h>
 
 #include <iostream>
+#include <random>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -20,12 +22,21 @@ void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
 void renderScene(const Shader &shader);
 void renderCube();
+unsigned int getCubeVAO();
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 bool shadows = true;
 bool shadowsKeyPressed = false;
+bool layeredShadows = true;
+bool layeredShadowsKeyPressed = false;
+bool benchmark = false;
+bool benchmarkKeyPressed = false;
+
+// scene
+const glm::mat4 roomModel = glm::scale(glm::mat4(1.0f), glm::vec3(5.0f));
+std::vector<glm::mat4> cubeModels;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
@@ -84,6 +95,37 @@ int main()
     // -------------------------
     Shader shader("3.2.1.point_shadows.vs", "3.2.1.point_shadows.fs");
     Shader simpleDepthShader("3.2.1.point_shadows_depth.vs", "3.2.1.point_shadows_depth.fs", "3.2.1.point_shadows_depth.gs");    
+    // layered shadow pass: every cube is only instanced into the faces it's visible in and all faces are rendered in
+    // one draw call; the face is selected by the vertex shader if supported, otherwise by a (pass-through) geometry shader
+    ShadowPass shadowPass(2);
+    Shader layeredDepthShaderGS("3.2.1.point_shadows_depth_instanced_gs.vs", "3.2.1.point_shadows_depth.fs", "3.2.1.point_shadows_depth_instanced.gs");
+    Shader *layeredDepthShader = nullptr;
+    if (shadowPass.VertexLayer)
+        layeredDepthShader = new Shader("3.2.1.point_shadows_depth_instanced.vs", "3.2.1.point_shadows_depth.fs");
+
+    // scene
+    // -----
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(4.0f, -3.5f, 0.0));
+    model = glm::scale(model, glm::vec3(0.5f));
+    cubeModels.push_back(model);
+    model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(2.0f, 3.0f, 1.0));
+    model = glm::scale(model, glm::vec3(0.75f));
+    cubeModels.push_back(model);
+    model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(-3.0f, -1.0f, 0.0));
+    model = glm::scale(model, glm::vec3(0.5f));
+    cubeModels.push_back(model);
+    model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(-1.5f, 1.0f, 1.5));
+    model = glm::scale(model, glm::vec3(0.5f));
+    cubeModels.push_back(model);
+    model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(-1.5f, 2.0f, -3.0));
+    model = glm::rotate(model, glm::radians(60.0f), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
+    model = glm::scale(model, glm::vec3(0.75f));
+    cubeModels.push_back(model);
 
     // load textures
     // -------------
@@ -122,6 +164,95 @@ int main()
     // lighting info
     // -------------
     glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
+    float near_plane = 1.0f;
+    float far_plane  = 25.0f;
+
+    // 1. render scene to depth cubemap; returns the number of (caster, face) pairs rendered
+    // --------------------------------------------------------------------------------------
+    auto renderShadowMap = [&](bool layered, bool vertexLayer, const std::vector<glm::mat4>& shadowTransforms)
+    {
+        unsigned int instances = 0;
+        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            if (layered)
+            {
+                // cull every cube against the frustum of each cube face and instance it into the faces it intersects
+                shadowPass.Begin(shadowTransforms);
+                shadowPass.Add(0, roomModel, glm::vec3(0.0f), 1.7320508f); // the cube spans [-1, 1]
+                for (const auto& cubeModel : cubeModels)
+                    shadowPass.Add(1, cubeModel, glm::vec3(0.0f), 1.7320508f);
+                shadowPass.Upload();
+                Shader &depthShader = vertexLayer ? *layeredDepthShader : layeredDepthShaderGS;
+                depthShader.use();
+                for (unsigned int i = 0; i < 6; ++i)
+                    depthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
+                depthShader.setFloat("far_plane", far_plane);
+                depthShader.setVec3("lightPos", lightPos);
+                glDisable(GL_CULL_FACE); // we're inside the room cube
+                shadowPass.Draw(0, getCubeVAO(), 36);
+                glEnable(GL_CULL_FACE);
+                shadowPass.Draw(1, getCubeVAO(), 36);
+                instances = shadowPass.InstancesAdded;
+            }
+            else
+            {
+                simpleDepthShader.use();
+                for (unsigned int i = 0; i < 6; ++i)
+                    simpleDepthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
+                simpleDepthShader.setFloat("far_plane", far_plane);
+                simpleDepthShader.setVec3("lightPos", lightPos);
+                renderScene(simpleDepthShader);
+                instances = (unsigned int)(cubeModels.size() + 1) * 6;
+            }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return instances;
+    };
+
+    // renders the depth cubemap with 10k random cubes inside the room using each shadow pass path
+    // --------------------------------------------------------------------------------------------
+    auto runBenchmark = [&](const std::vector<glm::mat4>& shadowTransforms)
+    {
+        const auto sceneCubes = cubeModels;
+        std::default_random_engine generator;
+        std::uniform_real_distribution<float> positionDistribution(-4.5f, 4.5f);
+        std::uniform_real_distribution<float> scaleDistribution(0.05f, 0.15f);
+        cubeModels.clear();
+        for (unsigned int i = 0; i < 10000; ++i)
+        {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator)));
+            model = glm::scale(model, glm::vec3(scaleDistribution(generator)));
+            cubeModels.push_back(model);
+        }
+        const char* pathNames[] = { "geometry shader amplification", "culled + instanced (geometry shader layer)", "culled + instanced (vertex shader layer)" };
+        const int frames = 16;
+        unsigned int query;
+        glGenQueries(1, &query);
+        for (int path = 0; path < 3; ++path)
+        {
+            if (path == 2 && !shadowPass.VertexLayer)
+            {
+                std::cout << "10000 casters, " << pathNames[path] << ": not supported" << std::endl;
+                continue;
+            }
+            double totalTime = 0.0;
+            unsigned int instances = 0;
+            for (int frame = -1; frame < frames; ++frame) // first frame is a warm-up
+            {
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                instances = renderShadowMap(path != 0, path == 2, shadowTransforms);
+                glEndQuery(GL_TIME_ELAPSED);
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                if (frame >= 0)
+                    totalTime += elapsed / 1000000.0;
+            }
+            std::cout << "10000 casters, " << pathNames[path] << ": " << totalTime / frames << " ms, " << instances << " caster instances" << std::endl;
+        }
+        glDeleteQueries(1, &query);
+        cubeModels = sceneCubes;
+    };
 
     // render loop
     // -----------
@@ -147,8 +278,6 @@ int main()
 
         // 0. create depth cubemap transformation matrices
         // -----------------------------------------------
-        float near_plane = 1.0f;
-        float far_plane  = 25.0f;
         glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), (float)SHADOW_WIDTH / (float)SHADOW_HEIGHT, near_plane, far_plane);
         std::vector<glm::mat4> shadowTransforms;
         shadowTransforms.push_back(shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)));
@@ -158,18 +287,15 @@ int main()
         shadowTransforms.push_back(shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)));
         shadowTransforms.push_back(shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f)));
 
+        if (benchmark)
+        {
+            runBenchmark(shadowTransforms);
+            benchmark = false;
+        }
+
         // 1. render scene to depth cubemap
         // --------------------------------
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
-            glClear(GL_DEPTH_BUFFER_BIT);
-            simpleDepthShader.use();
-            for (unsigned int i = 0; i < 6; ++i)
-                simpleDepthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
-            simpleDepthShader.setFloat("far_plane", far_plane);
-            simpleDepthShader.setVec3("lightPos", lightPos);
-            renderScene(simpleDepthShader);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        renderShadowMap(layeredShadows, shadowPass.VertexLayer, shadowTransforms);
 
         // 2. render scene as normal 
         // -------------------------
@@ -197,6 +323,9 @@ int main()
         glfwPollEvents();
     }
 
+    shadowPass.Delete();
+    delete layeredDepthShader;
+
     glfwTerminate();
     return 0;
 }
@@ -206,48 +335,25 @@ int main()
 void renderScene(const Shader &shader)
 {
     // room cube
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::scale(model, glm::vec3(5.0f));
-    shader.setMat4("model", model);
+    shader.setMat4("model", roomModel);
     glDisable(GL_CULL_FACE); // note that we disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal culling methods.
     shader.setInt("reverse_normals", 1); // A small little hack to invert normals when drawing cube from the inside so lighting still works.
     renderCube();
     shader.setInt("reverse_normals", 0); // and of course disable it
     glEnable(GL_CULL_FACE);
     // cubes
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(4.0f, -3.5f, 0.0));
-    model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(2.0f, 3.0f, 1.0));
-    model = glm::scale(model, glm::vec3(0.75f));
-    shader.setMat4("model", model);
-    renderCube();
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(-3.0f, -1.0f, 0.0));
-    model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(-1.5f, 1.0f, 1.5));
-    model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(-1.5f, 2.0f, -3.0));
-    model = glm::rotate(model, glm::radians(60.0f), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
-    model = glm::scale(model, glm::vec3(0.75f));
-    shader.setMat4("model", model);
-    renderCube();
+    for (const auto& cubeModel : cubeModels)
+    {
+        shader.setMat4("model", cubeModel);
+        renderCube();
+    }
 }
 
 // renderCube() renders a 1x1 3D cube in NDC.
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
 unsigned int cubeVBO = 0;
-void renderCube()
+unsigned int getCubeVAO()
 {
     // initialize (if necessary)
     if (cubeVAO == 0)
@@ -312,8 +418,13 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
+    return cubeVAO;
+}
+
+void renderCube()
+{
     // render Cube
-    glBindVertexArray(cubeVAO);
+    glBindVertexArray(getCubeVAO());
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glBindVertexArray(0);
 }
@@ -343,6 +454,27 @@ void processInput(GLFWwindow *window)
     {
         shadowsKeyPressed = false;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !layeredShadowsKeyPressed)
+    {
+        layeredShadows = !layeredShadows;
+        layeredShadowsKeyPressed = true;
+        std::cout << "shadow pass: " << (layeredShadows ? "culled + instanced" : "geometry shader amplification") << std::endl;
+    }
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE)
+    {
+        layeredShadowsKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmark = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
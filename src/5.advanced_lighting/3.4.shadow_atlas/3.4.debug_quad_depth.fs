@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D depthMap;
+
+void main()
+{             
+    float depthValue = texture(depthMap, TexCoords).r;
+    // perspective depth is mostly close to 1.0; raise it to a power to make the pages distinguishable
+    FragColor = vec4(vec3(pow(depthValue, 32.0)), 1.0);
+}
@@ -0,0 +1,95 @@
+#version 330 core
+out vec4 FragColor;
+
+in VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+} fs_in;
+
+uniform sampler2D diffuseTexture;
+uniform sampler2D shadowAtlas;
+
+struct Light {
+    vec3 Position;
+    vec3 Direction;
+    vec3 Color;
+    float Range;
+    
+    mat4 LightSpaceMatrix;
+    vec4 AtlasRect; // offset (xy) and size (zw) of the light's page in the atlas
+};
+const int NR_LIGHTS = 32;
+uniform Light lights[NR_LIGHTS];
+uniform float cutOff;
+uniform float outerCutOff;
+uniform vec3 viewPos;
+
+float ShadowCalculation(int light, vec3 normal, vec3 lightDir)
+{
+    vec4 rect = lights[light].AtlasRect;
+    // the light didn't get a page in the atlas
+    if (rect.z == 0.0)
+        return 0.0;
+    // perform perspective divide and transform to [0,1] range
+    vec4 fragPosLightSpace = lights[light].LightSpaceMatrix * vec4(fs_in.FragPos, 1.0);
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    projCoords = projCoords * 0.5 + 0.5;
+    // keep the shadow at 0.0 when outside the far_plane region of the light's frustum.
+    float currentDepth = projCoords.z;
+    if (currentDepth > 1.0)
+        return 0.0;
+    // calculate bias (based on slope)
+    float bias = max(0.0005 * (1.0 - dot(normal, lightDir)), 0.00005);
+    // PCF; the taps are clamped to the light's page so they don't read the pages next to it
+    vec2 texelSize = 1.0 / textureSize(shadowAtlas, 0);
+    vec2 minCoord = rect.xy + 0.5 * texelSize;
+    vec2 maxCoord = rect.xy + rect.zw - 0.5 * texelSize;
+    float shadow = 0.0;
+    for(int x = -1; x <= 1; ++x)
+    {
+        for(int y = -1; y <= 1; ++y)
+        {
+            vec2 atlasCoords = clamp(rect.xy + projCoords.xy * rect.zw + vec2(x, y) * texelSize, minCoord, maxCoord);
+            float pcfDepth = texture(shadowAtlas, atlasCoords).r; 
+            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;        
+        }    
+    }
+    return shadow / 9.0;
+}
+
+void main()
+{           
+    vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    // ambient
+    vec3 lighting = 0.05 * color;
+    for(int i = 0; i < NR_LIGHTS; ++i)
+    {
+        vec3 toLight = lights[i].Position - fs_in.FragPos;
+        float distance = length(toLight);
+        if (distance > lights[i].Range)
+            continue;
+        vec3 lightDir = toLight / distance;
+        // spotlight (soft edges)
+        float theta = dot(lightDir, normalize(-lights[i].Direction));
+        float intensity = clamp((theta - outerCutOff) / (cutOff - outerCutOff), 0.0, 1.0);
+        if (intensity == 0.0)
+            continue;
+        // attenuation (reaches zero at the light's range)
+        float falloff = 1.0 - distance / lights[i].Range;
+        float attenuation = falloff * falloff;
+        // diffuse
+        float diff = max(dot(lightDir, normal), 0.0);
+        vec3 diffuse = diff * lights[i].Color;
+        // specular
+        vec3 halfwayDir = normalize(lightDir + viewDir);  
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+        vec3 specular = spec * lights[i].Color;
+        // calculate shadow
+        float shadow = ShadowCalculation(i, normal, lightDir);
+        lighting += (1.0 - shadow) * (diffuse + specular) * color * intensity * attenuation;
+    }
+    FragColor = vec4(lighting, 1.0);
+}
@@ -6,6 +6,13 @@ in vec2 TexCoords;
 uniform sampler2D hdrBuffer;
 uniform bool hdr;
 uniform float exposure;
+// the exposure measured by the auto exposure, the manual one then compensates it
+uniform bool useAutoExposure;
+layout (std140) uniform AutoExposure
+{
+    float adaptedExposure;
+    float averageLuminance;
+};
 
 void main()
 {             
@@ -16,7 +23,8 @@ void main()
         // reinhard
         // vec3 result = hdrColor / (hdrColor + vec3(1.0));
         // exposure
-        vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
+        float finalExposure = useAutoExposure ? adaptedExposure * exposure : exposure;
+        vec3 result = vec3(1.0) - exp(-hdrColor * finalExposure);
         // also gamma correct while we're at it       
         result = pow(result, vec3(1.0 / gamma));
         FragColor = vec4(result, 1.0);
@@ -10,6 +10,7 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/auto_exposure.h>
 
 #include <iostream>
 
@@ -27,6 +28,12 @@ const unsigned int SCR_HEIGHT = 600;
 bool hdr = true;
 bool hdrKeyPressed = false;
 float exposure = 1.0f;
+// with auto exposure the measured exposure is used, scaled by the manual one as compensation
+bool autoExposure = true;
+bool autoExposureKeyPressed = false;
+// times the auto exposure at 1080p
+bool benchmarkExposure = false;
+bool benchmarkKeyPressed = false;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
@@ -43,7 +50,8 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // the auto exposure requires OpenGL 4.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -134,6 +142,19 @@ int main()
     shader.setInt("diffuseTexture", 0);
     hdrShader.use();
     hdrShader.setInt("hdrBuffer", 0);
+    glUniformBlockBinding(hdrShader.ID, glGetUniformBlockIndex(hdrShader.ID, "AutoExposure"), 0);
+
+    // auto exposure
+    // -------------
+    AutoExposure exposureMeter("6.luminance_histogram.cs", "6.luminance_average.cs");
+    unsigned int exposureQuery;
+    glGenQueries(1, &exposureQuery);
+    unsigned int frameCount = 0;
+    unsigned int timedFrames = 0;
+    double exposureTimeSum = 0.0;
+    bool exposureQueryPending = false;
+
+    std::cout << "Press X to toggle the auto exposure (Q/E then compensate it), T to time it at 1080p" << std::endl;
 
     // render loop
     // -----------
@@ -181,17 +202,82 @@ int main()
             renderCube();
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 2. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
+        // 2. measure the luminance of the floating point color buffer and adapt the exposure, all on the GPU
+        // --------------------------------------------------------------------------------------------------
+        if (autoExposure)
+        {
+            // the previous frame's timing is read before its query is reused
+            if (exposureQueryPending)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(exposureQuery, GL_QUERY_RESULT, &elapsed);
+                exposureTimeSum += elapsed / 1000000.0;
+                timedFrames++;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, exposureQuery);
+            exposureMeter.Update(colorBuffer, SCR_WIDTH, SCR_HEIGHT, deltaTime);
+            glEndQuery(GL_TIME_ELAPSED);
+            exposureQueryPending = true;
+        }
+
+        // benchmark: the auto exposure at 1080p, on the color buffer scaled up to it
+        // --------------------------------------------------------------------------
+        if (benchmarkExposure)
+        {
+            benchmarkExposure = false;
+            const unsigned int REPEATS = 100;
+            if (exposureQueryPending)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(exposureQuery, GL_QUERY_RESULT, &elapsed);
+                exposureQueryPending = false;
+            }
+            unsigned int benchmarkTexture, benchmarkFBO;
+            glGenTextures(1, &benchmarkTexture);
+            glBindTexture(GL_TEXTURE_2D, benchmarkTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1920, 1080, 0, GL_RGBA, GL_FLOAT, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glGenFramebuffers(1, &benchmarkFBO);
+            glBindFramebuffer(GL_FRAMEBUFFER, benchmarkFBO);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, benchmarkTexture, 0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, hdrFBO);
+            glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, 1920, 1080, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            // no time passes, so the exposure doesn't change
+            exposureMeter.Update(benchmarkTexture, 1920, 1080, 0.0f); // warm up
+            glBeginQuery(GL_TIME_ELAPSED, exposureQuery);
+            for (unsigned int i = 0; i < REPEATS; ++i)
+                exposureMeter.Update(benchmarkTexture, 1920, 1080, 0.0f);
+            glEndQuery(GL_TIME_ELAPSED);
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(exposureQuery, GL_QUERY_RESULT, &elapsed);
+            std::cout << "auto exposure at 1920x1080 (histogram and reduction): " << elapsed / 1000000.0 / REPEATS << " ms" << std::endl;
+            glDeleteFramebuffers(1, &benchmarkFBO);
+            glDeleteTextures(1, &benchmarkTexture);
+        }
+
+        // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         hdrShader.use();
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, colorBuffer);
+        exposureMeter.Bind(0);
         hdrShader.setInt("hdr", hdr);
+        hdrShader.setBool("useAutoExposure", autoExposure);
         hdrShader.setFloat("exposure", exposure);
         renderQuad();
 
-        std::cout << "hdr: " << (hdr ? "on" : "off") << "| exposure: " << exposure << std::endl;
+        if (++frameCount % 120 == 0)
+        {
+            std::cout << "hdr: " << (hdr ? "on" : "off") << "| exposure: " << (autoExposure ? "auto, compensation " : "") << exposure;
+            if (timedFrames > 0)
+                std::cout << "| auto exposure: " << exposureTimeSum / timedFrames << " ms";
+            std::cout << std::endl;
+            exposureTimeSum = 0.0;
+            timedFrames = 0;
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -199,6 +285,8 @@ int main()
         glfwPollEvents();
     }
 
+    exposureMeter.Delete();
+    glDeleteQueries(1, &exposureQuery);
     glfwTerminate();
     return 0;
 }
@@ -346,6 +434,27 @@ void processInput(GLFWwindow *window)
     {
         exposure += 0.001f;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !autoExposureKeyPressed)
+    {
+        autoExposure = !autoExposure;
+        std::cout << "auto exposure: " << (autoExposure ? "on" : "off") << std::endl;
+        autoExposureKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE)
+    {
+        autoExposureKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkExposure = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -7,6 +7,13 @@ uniform sampler2D scene;
 uniform sampler2D bloomBlur;
 uniform bool bloom;
 uniform float exposure;
+// the exposure measured by the auto exposure, the manual one then compensates it
+uniform bool useAutoExposure;
+layout (std140) uniform AutoExposure
+{
+    float adaptedExposure;
+    float averageLuminance;
+};
 
 void main()
 {             
@@ -16,7 +23,8 @@ void main()
     if(bloom)
         hdrColor += bloomColor; // additive blending
     // tone mapping
-    vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
+    float finalExposure = useAutoExposure ? adaptedExposure * exposure : exposure;
+    vec3 result = vec3(1.0) - exp(-hdrColor * finalExposure);
     // also gamma correct while we're at it       
     result = pow(result, vec3(1.0 / gamma));
     FragColor = vec4(result, 1.0);
@@ -0,0 +1,41 @@
+#version 430 core
+// a work group blurs GROUP_SIZE pixels of a row (horizontal) or column
+layout (local_size_x = 256) in;
+
+layout (rgba16f, binding = 0) uniform writeonly image2D outputImage;
+
+uniform sampler2D image;
+
+uniform bool horizontal;
+// one side of the symmetric kernel; weight[0] is the center
+uniform int radius;
+uniform float weight[65];
+
+const int GROUP_SIZE = 256;
+const int MAX_RADIUS = 64;
+// the group's segment of the line plus radius pixels on both sides, so every pixel is fetched once per pass
+shared vec3 line[GROUP_SIZE + 2 * MAX_RADIUS];
+
+void main()
+{
+    ivec2 size = textureSize(image, 0);
+    int lineLength = horizontal ? size.x : size.y;
+    int lineIndex = int(gl_WorkGroupID.y);
+    int start = int(gl_WorkGroupID.x) * GROUP_SIZE;
+    for (int i = int(gl_LocalInvocationID.x); i < GROUP_SIZE + 2 * radius; i += GROUP_SIZE)
+    {
+        // clamp to the edge, like the fragment shader's texture sampling
+        int position = clamp(start - radius + i, 0, lineLength - 1);
+        line[i] = texelFetch(image, horizontal ? ivec2(position, lineIndex) : ivec2(lineIndex, position), 0).rgb;
+    }
+    barrier();
+
+    int position = start + int(gl_LocalInvocationID.x);
+    if (position >= lineLength)
+        return;
+    int center = int(gl_LocalInvocationID.x) + radius;
+    vec3 result = line[center] * weight[0];
+    for (int i = 1; i <= radius; ++i)
+        result += (line[center - i] + line[center + i]) * weight[i];
+    imageStore(outputImage, horizontal ? ivec2(position, lineIndex) : ivec2(lineIndex, position), vec4(result, 1.0));
+}
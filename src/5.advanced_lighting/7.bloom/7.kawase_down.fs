@@ -0,0 +1,21 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// the next larger level of the chain (or the bright color buffer)
+uniform sampler2D image;
+// distance of the taps in source texels; widens the blur without adding passes
+uniform float offset;
+
+// dual filter downsample: the center and 4 diagonal bilinear taps
+void main()
+{
+    vec2 halfTexel = offset / vec2(textureSize(image, 0));
+    vec3 result = texture(image, TexCoords).rgb * 4.0;
+    result += texture(image, TexCoords - halfTexel).rgb;
+    result += texture(image, TexCoords + halfTexel).rgb;
+    result += texture(image, TexCoords + vec2(halfTexel.x, -halfTexel.y)).rgb;
+    result += texture(image, TexCoords - vec2(halfTexel.x, -halfTexel.y)).rgb;
+    FragColor = vec4(result / 8.0, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// the next smaller level of the chain
+uniform sampler2D image;
+// distance of the taps in source texels; widens the blur without adding passes
+uniform float offset;
+
+// dual filter upsample: 4 taps on the axes and 4 (double weighted) diagonal taps
+void main()
+{
+    vec2 halfTexel = offset * 0.5 / vec2(textureSize(image, 0));
+    vec3 result = texture(image, TexCoords + vec2(-halfTexel.x * 2.0, 0.0)).rgb;
+    result += texture(image, TexCoords + vec2( halfTexel.x * 2.0, 0.0)).rgb;
+    result += texture(image, TexCoords + vec2(0.0, -halfTexel.y * 2.0)).rgb;
+    result += texture(image, TexCoords + vec2(0.0,  halfTexel.y * 2.0)).rgb;
+    result += texture(image, TexCoords + vec2(-halfTexel.x,  halfTexel.y)).rgb * 2.0;
+    result += texture(image, TexCoords + vec2( halfTexel.x,  halfTexel.y)).rgb * 2.0;
+    result += texture(image, TexCoords + vec2( halfTexel.x, -halfTexel.y)).rgb * 2.0;
+    result += texture(image, TexCoords + vec2(-halfTexel.x, -halfTexel.y)).rgb * 2.0;
+    FragColor = vec4(result / 12.0, 1.0);
+}
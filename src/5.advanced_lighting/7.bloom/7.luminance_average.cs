@@ -0,0 +1,68 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+// Reduces the luminance histogram to the average log2 luminance of the pixels between two percentiles and moves
+// the exposure towards the one that maps this average to the key value. Runs as a single work group, one
+// invocation per bin, and clears the histogram for the next frame.
+layout (std430, binding = 0) buffer LuminanceHistogram
+{
+    uint histogram[256];
+};
+layout (std430, binding = 1) buffer Exposure
+{
+    float exposure;
+    float averageLuminance;
+};
+
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+uniform float lowPercentile;
+uniform float highPercentile;
+uniform float key;
+// fraction of the way to the new exposure covered this frame
+uniform float adaptation;
+
+shared float prefix[256];
+shared vec2 sums[256];
+
+void main()
+{
+    uint bin = gl_LocalInvocationIndex;
+    float count = float(histogram[bin]);
+    histogram[bin] = 0u;
+
+    // inclusive prefix sum of the counts: the pixels up to and including each bin
+    prefix[bin] = count;
+    barrier();
+    for (uint offset = 1u; offset < 256u; offset <<= 1)
+    {
+        float previous = bin >= offset ? prefix[bin - offset] : 0.0;
+        barrier();
+        prefix[bin] += previous;
+        barrier();
+    }
+
+    // the part of this bin's pixels that lies between the percentiles of the non black pixels
+    float black = prefix[0];
+    float total = prefix[255] - black;
+    float first = prefix[bin] - count - black;
+    float inside = bin == 0u ? 0.0 : max(min(prefix[bin] - black, highPercentile * total) - max(first, lowPercentile * total), 0.0);
+    float logLuminance = (float(bin) - 0.5) / 254.0 * logLuminanceRange + minLogLuminance;
+    sums[bin] = vec2(inside * logLuminance, inside);
+    barrier();
+
+    for (uint stride = 128u; stride > 0u; stride >>= 1)
+    {
+        if (bin < stride)
+            sums[bin] += sums[bin + stride];
+        barrier();
+    }
+
+    if (bin == 0u)
+    {
+        // an all black image keeps the darkest exposure the histogram can measure
+        float average = sums[0].y > 0.0 ? exp2(sums[0].x / sums[0].y) : exp2(minLogLuminance);
+        averageLuminance = average;
+        exposure = mix(exposure, key / average, adaptation);
+    }
+}
@@ -8,10 +8,13 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/auto_exposure.h>
 
 #include <iostream>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -20,6 +23,7 @@ void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path, bool gammaCorrection);
 void renderQuad();
 void renderCube();
+unsigned int createColorTarget(unsigned int width, unsigned int height, unsigned int &texture);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -27,6 +31,38 @@ const unsigned int SCR_HEIGHT = 600;
 bool bloom = true;
 bool bloomKeyPressed = false;
 float exposure = 1.0f;
+// with auto exposure the measured exposure is used, scaled by the manual one as compensation
+bool autoExposure = true;
+bool autoExposureKeyPressed = false;
+
+// bloom backends: all of them blur the bright color buffer into a texture the HDR composite adds to the scene
+enum Bloom_Backend {
+    BLOOM_PINGPONG,    // fragment shader Gaussian, ping-ponging one 9 tap pass per framebuffer switch
+    BLOOM_COMPUTE,     // compute shader Gaussian, all passes of a direction folded into one wide kernel
+    BLOOM_DUAL_KAWASE  // dual filter down- and upsampling chain
+};
+const char *bloomBackendNames[] = { "ping-pong", "compute", "dual Kawase" };
+Bloom_Backend bloomBackend = BLOOM_PINGPONG;
+bool backendKeyPressed = false;
+// blur size: the ping-pong passes of the Gaussian backends (the radius grows linearly with them) and the levels of the
+// dual filter chain (the radius doubles with every level)
+unsigned int blurAmount = 10;
+unsigned int kawaseLevels = 5;
+const unsigned int MAX_KAWASE_LEVELS = 6;
+bool radiusKeyPressed = false;
+// times all backends at 1080p and 4K
+bool benchmarkBloom = false;
+bool benchmarkKeyPressed = false;
+
+// the blur targets of a resolution
+struct BloomTargets {
+    unsigned int Width, Height;
+    unsigned int PingpongFBO[2], PingpongColorbuffers[2]; // full resolution; the compute backend writes them as images
+    std::vector<unsigned int> MipFBOs, Mips;              // the dual filter's half, quarter, ... resolution levels
+};
+BloomTargets createBloomTargets(unsigned int width, unsigned int height);
+void deleteBloomTargets(BloomTargets &targets);
+std::vector<float> gaussianWeights(unsigned int passes);
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
@@ -43,7 +79,8 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // the compute bloom backend requires OpenGL 4.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -86,6 +123,9 @@ int main()
     Shader shaderLight("7.bloom.vs", "7.light_box.fs");
     Shader shaderBlur("7.blur.vs", "7.blur.fs");
     Shader shaderBloomFinal("7.bloom_final.vs", "7.bloom_final.fs");
+    ComputeShader shaderBlurCompute("7.blur.cs");
+    Shader shaderKawaseDown("7.blur.vs", "7.kawase_down.fs");
+    Shader shaderKawaseUp("7.blur.vs", "7.kawase_up.fs");
 
     // load textures
     // -------------
@@ -125,25 +165,8 @@ int main()
         std::cout << "Framebuffer not complete!" << std::endl;
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // ping-pong-framebuffer for blurring
-    unsigned int pingpongFBO[2];
-    unsigned int pingpongColorbuffers[2];
-    glGenFramebuffers(2, pingpongFBO);
-    glGenTextures(2, pingpongColorbuffers);
-    for (unsigned int i = 0; i < 2; i++)
-    {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // we clamp to the edge as the blur filter would otherwise sample repeated texture values!
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingpongColorbuffers[i], 0);
-        // also check if framebuffers are complete (no need for depth buffer)
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-            std::cout << "Framebuffer not complete!" << std::endl;
-    }
+    // ping-pong-framebuffer for blurring (and the dual filter's chain)
+    BloomTargets bloomTargets = createBloomTargets(SCR_WIDTH, SCR_HEIGHT);
 
     // lighting info
     // -------------
@@ -170,6 +193,114 @@ int main()
     shaderBloomFinal.use();
     shaderBloomFinal.setInt("scene", 0);
     shaderBloomFinal.setInt("bloomBlur", 1);
+    glUniformBlockBinding(shaderBloomFinal.ID, glGetUniformBlockIndex(shaderBloomFinal.ID, "AutoExposure"), 0);
+
+    // auto exposure, measured on the scene before the bloom is added
+    AutoExposure exposureMeter("7.luminance_histogram.cs", "7.luminance_average.cs");
+    shaderBlurCompute.use();
+    shaderBlurCompute.setInt("image", 0);
+    shaderKawaseDown.use();
+    shaderKawaseDown.setInt("image", 0);
+    shaderKawaseDown.setFloat("offset", 1.0f);
+    shaderKawaseUp.use();
+    shaderKawaseUp.setInt("image", 0);
+    shaderKawaseUp.setFloat("offset", 1.0f);
+
+    // blurs a bright color buffer with a backend; returns the texture holding the result
+    // -----------------------------------------------------------------------------------
+    unsigned int computeWeightsAmount = 0; // blurAmount the compute kernel's weights were uploaded for
+    auto renderBloom = [&](Bloom_Backend backend, BloomTargets &targets, unsigned int brightTexture) -> unsigned int {
+        unsigned int result;
+        glViewport(0, 0, targets.Width, targets.Height);
+        glActiveTexture(GL_TEXTURE0);
+        if (backend == BLOOM_PINGPONG)
+        {
+            // two-pass Gaussian blur, one direction per pass
+            bool horizontal = true, first_iteration = true;
+            shaderBlur.use();
+            for (unsigned int i = 0; i < blurAmount; i++)
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, targets.PingpongFBO[horizontal]);
+                shaderBlur.setInt("horizontal", horizontal);
+                glBindTexture(GL_TEXTURE_2D, first_iteration ? brightTexture : targets.PingpongColorbuffers[!horizontal]);  // bind texture of other framebuffer (or scene if first iteration)
+                renderQuad();
+                horizontal = !horizontal;
+                if (first_iteration)
+                    first_iteration = false;
+            }
+            result = targets.PingpongColorbuffers[!horizontal];
+        }
+        else if (backend == BLOOM_COMPUTE)
+        {
+            // the same Gaussian: repeated 9 tap passes of a direction equal a single pass with the kernel convolved
+            // with itself, so each direction is a single dispatch
+            shaderBlurCompute.use();
+            if (computeWeightsAmount != blurAmount)
+            {
+                std::vector<float> weights = gaussianWeights(blurAmount / 2);
+                shaderBlurCompute.setInt("radius", (int)weights.size() - 1);
+                for (unsigned int i = 0; i < weights.size(); ++i)
+                    shaderBlurCompute.setFloat("weight[" + std::to_string(i) + "]", weights[i]);
+                computeWeightsAmount = blurAmount;
+            }
+            for (unsigned int pass = 0; pass < 2; ++pass)
+            {
+                const bool horizontal = pass == 0;
+                shaderBlurCompute.setBool("horizontal", horizontal);
+                glBindTexture(GL_TEXTURE_2D, horizontal ? brightTexture : targets.PingpongColorbuffers[0]);
+                glBindImageTexture(0, targets.PingpongColorbuffers[pass], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+                const unsigned int lineLength = horizontal ? targets.Width : targets.Height;
+                glDispatchCompute((lineLength + 255) / 256, horizontal ? targets.Height : targets.Width, 1);
+                // make sure the pass is written before the next one (or the composite) reads it
+                glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+            }
+            result = targets.PingpongColorbuffers[1];
+        }
+        else
+        {
+            // dual filter: downsample through the chain, then upsample back up to full resolution
+            shaderKawaseDown.use();
+            unsigned int source = brightTexture;
+            for (unsigned int i = 0; i < kawaseLevels; ++i)
+            {
+                glViewport(0, 0, targets.Width >> (i + 1), targets.Height >> (i + 1));
+                glBindFramebuffer(GL_FRAMEBUFFER, targets.MipFBOs[i]);
+                glBindTexture(GL_TEXTURE_2D, source);
+                renderQuad();
+                source = targets.Mips[i];
+            }
+            shaderKawaseUp.use();
+            for (int i = (int)kawaseLevels - 2; i >= -1; --i)
+            {
+                // level -1 is the full resolution result
+                if (i >= 0)
+                {
+                    glViewport(0, 0, targets.Width >> (i + 1), targets.Height >> (i + 1));
+                    glBindFramebuffer(GL_FRAMEBUFFER, targets.MipFBOs[i]);
+                }
+                else
+                {
+                    glViewport(0, 0, targets.Width, targets.Height);
+                    glBindFramebuffer(GL_FRAMEBUFFER, targets.PingpongFBO[0]);
+                }
+                glBindTexture(GL_TEXTURE_2D, targets.Mips[i + 1]);
+                renderQuad();
+            }
+            result = targets.PingpongColorbuffers[0];
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        return result;
+    };
+
+    // timing of the bloom blur
+    unsigned int bloomQuery;
+    glGenQueries(1, &bloomQuery);
+    unsigned int frameCount = 0;
+    double bloomTimeSum = 0.0;
+
+    std::cout << "Press B to switch the bloom backend, +/- to change the blur size, T to time all backends at 1080p and 4K, "
+              << "X to toggle the auto exposure" << std::endl;
 
     // render loop
     // -----------
@@ -270,22 +401,61 @@ int main()
         }
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 2. blur bright fragments with two-pass Gaussian Blur 
+        // benchmark: all backends at 1080p and 4K, on the bright color buffer scaled up to these resolutions
+        // -------------------------------------------------------------------------------------------------
+        if (benchmarkBloom)
+        {
+            benchmarkBloom = false;
+            const unsigned int resolutions[2][2] = { { 1920, 1080 }, { 3840, 2160 } };
+            const unsigned int REPEATS = 10;
+            for (unsigned int r = 0; r < 2; ++r)
+            {
+                BloomTargets targets = createBloomTargets(resolutions[r][0], resolutions[r][1]);
+                unsigned int brightTexture;
+                unsigned int brightFBO = createColorTarget(resolutions[r][0], resolutions[r][1], brightTexture);
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, hdrFBO);
+                glReadBuffer(GL_COLOR_ATTACHMENT1);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, brightFBO);
+                glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, resolutions[r][0], resolutions[r][1], GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, hdrFBO);
+                glReadBuffer(GL_COLOR_ATTACHMENT0);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                std::cout << resolutions[r][0] << "x" << resolutions[r][1] << " (" << blurAmount << " ping-pong passes, "
+                          << kawaseLevels << " dual filter levels):";
+                for (unsigned int backend = 0; backend < 3; ++backend)
+                {
+                    renderBloom(Bloom_Backend(backend), targets, brightTexture); // warm up
+                    glBeginQuery(GL_TIME_ELAPSED, bloomQuery);
+                    for (unsigned int i = 0; i < REPEATS; ++i)
+                        renderBloom(Bloom_Backend(backend), targets, brightTexture);
+                    glEndQuery(GL_TIME_ELAPSED);
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(bloomQuery, GL_QUERY_RESULT, &elapsed);
+                    std::cout << " " << bloomBackendNames[backend] << " " << elapsed / 1000000.0 / REPEATS << " ms";
+                }
+                std::cout << std::endl;
+                deleteBloomTargets(targets);
+                glDeleteFramebuffers(1, &brightFBO);
+                glDeleteTextures(1, &brightTexture);
+            }
+        }
+
+        // 2. blur bright fragments with the selected backend
         // --------------------------------------------------
-        bool horizontal = true, first_iteration = true;
-        unsigned int amount = 10;
-        shaderBlur.use();
-        for (unsigned int i = 0; i < amount; i++)
+        // the previous frame's timing is read before its query is reused
+        if (frameCount > 0)
         {
-            glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
-            shaderBlur.setInt("horizontal", horizontal);
-            glBindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[1] : pingpongColorbuffers[!horizontal]);  // bind texture of other framebuffer (or scene if first iteration)
-            renderQuad();
-            horizontal = !horizontal;
-            if (first_iteration)
-                first_iteration = false;
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(bloomQuery, GL_QUERY_RESULT, &elapsed);
+            bloomTimeSum += elapsed / 1000000.0;
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glBeginQuery(GL_TIME_ELAPSED, bloomQuery);
+        unsigned int bloomTexture = renderBloom(bloomBackend, bloomTargets, colorBuffers[1]);
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // measure the scene's luminance and adapt the exposure, all on the GPU
+        if (autoExposure)
+            exposureMeter.Update(colorBuffers[0], SCR_WIDTH, SCR_HEIGHT, deltaTime);
 
         // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
@@ -294,12 +464,19 @@ int main()
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
+        glBindTexture(GL_TEXTURE_2D, bloomTexture);
+        exposureMeter.Bind(0);
         shaderBloomFinal.setInt("bloom", bloom);
+        shaderBloomFinal.setBool("useAutoExposure", autoExposure);
         shaderBloomFinal.setFloat("exposure", exposure);
         renderQuad();
 
-        std::cout << "bloom: " << (bloom ? "on" : "off") << "| exposure: " << exposure << std::endl;
+        if (++frameCount % 120 == 0)
+        {
+            std::cout << "bloom: " << (bloom ? "on" : "off") << "| exposure: " << exposure << "| " << bloomBackendNames[bloomBackend]
+                      << " blur: " << bloomTimeSum / 120.0 << " ms" << std::endl;
+            bloomTimeSum = 0.0;
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -307,10 +484,81 @@ int main()
         glfwPollEvents();
     }
 
+    deleteBloomTargets(bloomTargets);
+    glDeleteQueries(1, &bloomQuery);
+    exposureMeter.Delete();
+
     glfwTerminate();
     return 0;
 }
 
+// creates a floating point color texture with a framebuffer rendering to it; returns the framebuffer
+// ---------------------------------------------------------------------------------------------------
+unsigned int createColorTarget(unsigned int width, unsigned int height, unsigned int &texture)
+{
+    unsigned int fbo;
+    glGenFramebuffers(1, &fbo);
+    glGenTextures(1, &texture);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // we clamp to the edge as the blur filter would otherwise sample repeated texture values!
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    // also check if framebuffers are complete (no need for depth buffer)
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return fbo;
+}
+
+// creates the ping-pong framebuffers and the dual filter's chain for a resolution
+// -------------------------------------------------------------------------------
+BloomTargets createBloomTargets(unsigned int width, unsigned int height)
+{
+    BloomTargets targets;
+    targets.Width = width;
+    targets.Height = height;
+    for (unsigned int i = 0; i < 2; i++)
+        targets.PingpongFBO[i] = createColorTarget(width, height, targets.PingpongColorbuffers[i]);
+    for (unsigned int i = 0; i < MAX_KAWASE_LEVELS; i++)
+    {
+        unsigned int mip;
+        targets.MipFBOs.push_back(createColorTarget(std::max(width >> (i + 1), 1u), std::max(height >> (i + 1), 1u), mip));
+        targets.Mips.push_back(mip);
+    }
+    return targets;
+}
+
+void deleteBloomTargets(BloomTargets &targets)
+{
+    glDeleteFramebuffers(2, targets.PingpongFBO);
+    glDeleteTextures(2, targets.PingpongColorbuffers);
+    glDeleteFramebuffers((GLsizei)targets.MipFBOs.size(), &targets.MipFBOs[0]);
+    glDeleteTextures((GLsizei)targets.Mips.size(), &targets.Mips[0]);
+}
+
+// one side of the kernel of the given number of 9 tap blur passes (7.blur.fs's weights) in one direction: the
+// 9 tap kernel convolved with itself passes - 1 times
+// -------------------------------------------------------------------------------------------------------------
+std::vector<float> gaussianWeights(unsigned int passes)
+{
+    const float weight[5] = { 0.2270270270f, 0.1945945946f, 0.1216216216f, 0.0540540541f, 0.0162162162f };
+    std::vector<float> kernel(1, 1.0f);
+    for (unsigned int pass = 0; pass < passes; ++pass)
+    {
+        std::vector<float> next(kernel.size() + 8, 0.0f);
+        for (unsigned int i = 0; i < kernel.size(); ++i)
+            for (int j = -4; j <= 4; ++j)
+                next[i + 4 + j] += kernel[i] * weight[std::abs(j)];
+        kernel = next;
+    }
+    // the kernel is symmetric; keep the center and one side
+    return std::vector<float>(kernel.begin() + kernel.size() / 2, kernel.end());
+}
+
 // renderCube() renders a 1x1 3D cube in NDC.
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
@@ -443,6 +691,17 @@ void processInput(GLFWwindow *window)
         bloomKeyPressed = false;
     }
 
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !autoExposureKeyPressed)
+    {
+        autoExposure = !autoExposure;
+        std::cout << "auto exposure: " << (autoExposure ? "on" : "off") << std::endl;
+        autoExposureKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE)
+    {
+        autoExposureKeyPressed = false;
+    }
+
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
     {
         if (exposure > 0.0f)
@@ -454,6 +713,48 @@ void processInput(GLFWwindow *window)
     {
         exposure += 0.001f;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !backendKeyPressed)
+    {
+        bloomBackend = Bloom_Backend((bloomBackend + 1) % 3);
+        std::cout << "bloom backend: " << bloomBackendNames[bloomBackend] << std::endl;
+        backendKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        backendKeyPressed = false;
+    }
+
+    // the compute kernel's radius is limited to 64 texels: at most 16 passes per direction
+    if ((glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_PRESS) && !radiusKeyPressed)
+    {
+        if (bloomBackend == BLOOM_DUAL_KAWASE)
+            kawaseLevels = std::min(kawaseLevels + 1, MAX_KAWASE_LEVELS);
+        else
+            blurAmount = std::min(blurAmount + 2, 32u);
+        radiusKeyPressed = true;
+    }
+    else if ((glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS) && !radiusKeyPressed)
+    {
+        if (bloomBackend == BLOOM_DUAL_KAWASE)
+            kawaseLevels = std::max(kawaseLevels - 1, 1u);
+        else
+            blurAmount = std::max(blurAmount - 2, 2u);
+        radiusKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_RELEASE && glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_RELEASE &&
+        glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_RELEASE && glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_RELEASE)
+        radiusKeyPressed = false;
+
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkBloom = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -9,6 +9,7 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
 
 #include <iostream>
 
@@ -34,6 +35,13 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// g-buffer layout
+GBuffer_Layout gBufferLayout = GBUFFER_STANDARD;
+bool gBufferLayoutChanged = false;
+bool layoutKeyPressed = false;
+bool benchmark = false;
+bool benchmarkKeyPressed = false;
+
 int main()
 {
     // glfw: initialize and configure
@@ -81,8 +89,14 @@ int main()
 
     // build and compile shaders
     // -------------------------
-    Shader shaderGeometryPass("8.1.g_buffer.vs", "8.1.g_buffer.fs");
-    Shader shaderLightingPass("8.1.deferred_shading.vs", "8.1.deferred_shading.fs");
+    Shader shaderGeometryPass[] = {
+        Shader("8.1.g_buffer.vs", "8.1.g_buffer.fs"),          // GBUFFER_STANDARD
+        Shader("8.1.g_buffer.vs", "8.1.g_buffer_compact.fs"),  // GBUFFER_COMPACT
+    };
+    Shader shaderLightingPass[] = {
+        Shader("8.1.deferred_shading.vs", "8.1.deferred_shading.fs"),
+        Shader("8.1.deferred_shading.vs", "8.1.deferred_shading_compact.fs"),
+    };
     Shader shaderLightBox("8.1.deferred_light_box.vs", "8.1.deferred_light_box.fs");
 
     // load models
@@ -102,44 +116,8 @@ int main()
 
     // configure g-buffer framebuffer
     // ------------------------------
-    unsigned int gBuffer;
-    glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition, gNormal, gAlbedoSpec;
-    // position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-    // normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-    // color + specular color buffer
-    glGenTextures(1, &gAlbedoSpec);
-    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-    glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // the geometry and lighting pass shaders are picked by the g-buffer's layout
+    GBuffer gBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
 
     // lighting info
     // -------------
@@ -163,10 +141,135 @@ int main()
 
     // shader configuration
     // --------------------
-    shaderLightingPass.use();
-    shaderLightingPass.setInt("gPosition", 0);
-    shaderLightingPass.setInt("gNormal", 1);
-    shaderLightingPass.setInt("gAlbedoSpec", 2);
+    shaderLightingPass[GBUFFER_STANDARD].use();
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gPosition", 0);
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gNormal", 1);
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gAlbedoSpec", 2);
+    shaderLightingPass[GBUFFER_COMPACT].use();
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gNormal", 0);
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gAlbedoSpec", 1);
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gDepth", 2);
+    for (unsigned int layout = GBUFFER_STANDARD; layout <= GBUFFER_COMPACT; layout++)
+    {
+        shaderLightingPass[layout].use();
+        // send light relevant uniforms
+        for (unsigned int i = 0; i < lightPositions.size(); i++)
+        {
+            shaderLightingPass[layout].setVec3("lights[" + std::to_string(i) + "].Position", lightPositions[i]);
+            shaderLightingPass[layout].setVec3("lights[" + std::to_string(i) + "].Color", lightColors[i]);
+            // update attenuation parameters and calculate radius
+            const float linear = 0.7f;
+            const float quadratic = 1.8f;
+            shaderLightingPass[layout].setFloat("lights[" + std::to_string(i) + "].Linear", linear);
+            shaderLightingPass[layout].setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
+        }
+    }
+
+    // 1. geometry pass: render scene's geometry/color data into gbuffer
+    // -----------------------------------------------------------------
+    auto geometryPass = [&](const GBuffer &target, const glm::mat4 &projection, const glm::mat4 &view)
+    {
+        Shader &shader = shaderGeometryPass[target.Layout];
+        glBindFramebuffer(GL_FRAMEBUFFER, target.ID);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        for (unsigned int i = 0; i < objectPositions.size(); i++)
+        {
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, objectPositions[i]);
+            model = glm::scale(model, glm::vec3(0.5f));
+            shader.setMat4("model", model);
+            backpack.Draw(shader);
+        }
+    };
+    // 2. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
+    // -----------------------------------------------------------------------------------------------------------------------
+    auto lightingPass = [&](const GBuffer &source, const glm::mat4 &projection, const glm::mat4 &view)
+    {
+        Shader &shader = shaderLightingPass[source.Layout];
+        shader.use();
+        if (source.Layout == GBUFFER_COMPACT)
+        {
+            // the position is reconstructed from depth, so the lighting pass needs the inverse of the projection
+            shader.setMat4("inverseViewProjection", glm::inverse(projection * view));
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, source.Normal);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, source.AlbedoSpec);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, source.Depth);
+        }
+        else
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, source.Position);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, source.Normal);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, source.AlbedoSpec);
+        }
+        shader.setVec3("viewPos", camera.Position);
+        // finally render quad
+        renderQuad();
+    };
+
+    // renders both passes of each layout offscreen at 1080p and 4K and reports the
+    // g-buffer traffic per frame (every target written once and read once) and the GPU time
+    // ------------------------------------------------------------------------------------------
+    auto runBenchmark = [&]()
+    {
+        const unsigned int resolutions[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+        const char *layoutNames[] = { "standard", "compact" };
+        const int frames = 32;
+        unsigned int query;
+        glGenQueries(1, &query);
+        for (const auto &resolution : resolutions)
+        {
+            unsigned int width = resolution[0], height = resolution[1];
+            // lighting result target
+            unsigned int colorFBO, colorBuffer;
+            glGenFramebuffers(1, &colorFBO);
+            glGenTextures(1, &colorBuffer);
+            glBindTexture(GL_TEXTURE_2D, colorBuffer);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glBindFramebuffer(GL_FRAMEBUFFER, colorFBO);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorBuffer, 0);
+            glViewport(0, 0, width, height);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)width / (float)height, 0.1f, 100.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            for (unsigned int layout = GBUFFER_STANDARD; layout <= GBUFFER_COMPACT; layout++)
+            {
+                GBuffer target(width, height, (GBuffer_Layout)layout);
+                double totalTime = 0.0;
+                for (int frame = -1; frame < frames; frame++) // first frame is a warm-up
+                {
+                    glBeginQuery(GL_TIME_ELAPSED, query);
+                    geometryPass(target, projection, view);
+                    glBindFramebuffer(GL_FRAMEBUFFER, colorFBO);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    lightingPass(target, projection, view);
+                    glEndQuery(GL_TIME_ELAPSED);
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                    if (frame >= 0)
+                        totalTime += elapsed / 1000000.0;
+                }
+                double traffic = 2.0 * target.BytesPerPixel() * width * height / (1024.0 * 1024.0);
+                std::cout << width << "x" << height << " " << layoutNames[layout] << ": " << target.BytesPerPixel() << " bytes/pixel, "
+                          << traffic << " MB/frame, " << totalTime / frames << " ms (geometry + lighting)" << std::endl;
+                target.Delete();
+            }
+            glDeleteTextures(1, &colorBuffer);
+            glDeleteFramebuffers(1, &colorFBO);
+        }
+        glDeleteQueries(1, &query);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+    };
 
     // render loop
     // -----------
@@ -182,6 +285,20 @@ int main()
         // -----
         processInput(window);
 
+        if (gBufferLayoutChanged)
+        {
+            gBuffer.Delete();
+            gBuffer = GBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
+            gBufferLayoutChanged = false;
+            std::cout << "g-buffer layout: " << (gBufferLayout == GBUFFER_COMPACT ? "compact" : "standard") << " ("
+                      << gBuffer.BytesPerPixel() << " bytes/pixel)" << std::endl;
+        }
+        if (benchmark)
+        {
+            runBenchmark();
+            benchmark = false;
+        }
+
         // render
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -189,52 +306,20 @@ int main()
 
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-            glm::mat4 view = camera.GetViewMatrix();
-            glm::mat4 model = glm::mat4(1.0f);
-            shaderGeometryPass.use();
-            shaderGeometryPass.setMat4("projection", projection);
-            shaderGeometryPass.setMat4("view", view);
-            for (unsigned int i = 0; i < objectPositions.size(); i++)
-            {
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, objectPositions[i]);
-                model = glm::scale(model, glm::vec3(0.5f));
-                shaderGeometryPass.setMat4("model", model);
-                backpack.Draw(shaderGeometryPass);
-            }
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 model = glm::mat4(1.0f);
+        geometryPass(gBuffer, projection, view);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         // 2. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
         // -----------------------------------------------------------------------------------------------------------------------
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderLightingPass.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        // send light relevant uniforms
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
-        {
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Position", lightPositions[i]);
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Color", lightColors[i]);
-            // update attenuation parameters and calculate radius
-            const float linear = 0.7f;
-            const float quadratic = 1.8f;
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Linear", linear);
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
-        }
-        shaderLightingPass.setVec3("viewPos", camera.Position);
-        // finally render quad
-        renderQuad();
+        lightingPass(gBuffer, projection, view);
 
         // 2.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
         // ----------------------------------------------------------------------------------
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer.ID);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
         // blit to default framebuffer. Note that this may or may not work as the internal formats of both the FBO and default framebuffer have to match.
         // the internal formats are implementation defined. This works on all of my systems, but if it doesn't on yours you'll likely have to write to the 		
@@ -264,6 +349,8 @@ int main()
         glfwPollEvents();
     }
 
+    gBuffer.Delete();
+
     glfwTerminate();
     return 0;
 }
@@ -390,6 +477,27 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !layoutKeyPressed)
+    {
+        gBufferLayout = gBufferLayout == GBUFFER_STANDARD ? GBUFFER_COMPACT : GBUFFER_STANDARD;
+        gBufferLayoutChanged = true;
+        layoutKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+    {
+        layoutKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmark = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -2,12 +2,18 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+// per-light instance data
+layout (location = 3) in vec4 aLightPosition; // xyz: position, w: radius
+layout (location = 4) in vec3 aLightColor;
+
+out vec3 LightColor;
 
 uniform mat4 projection;
 uniform mat4 view;
-uniform mat4 model;
+uniform float boxSize;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    LightColor = aLightColor;
+    gl_Position = projection * view * vec4(aLightPosition.xyz + aPos * boxSize, 1.0);
+}
@@ -0,0 +1,41 @@
+#version 330 core
+out vec4 FragColor;
+
+flat in vec4 LightPosition;
+flat in vec3 LightColor;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+uniform vec2 screenSize;
+uniform float lightLinear;
+uniform float lightQuadratic;
+uniform vec3 viewPos;
+
+void main()
+{
+    // only the pixels covered by the light's volume get here; fetch their gbuffer data
+    vec2 TexCoords = gl_FragCoord.xy / screenSize;
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    // pixels in front of the volume also pass the depth test, skip them
+    float distance = length(LightPosition.xyz - FragPos);
+    if(distance >= LightPosition.w)
+        discard;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    // diffuse
+    vec3 lightDir = normalize(LightPosition.xyz - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * LightColor;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);  
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = LightColor * spec * Specular;
+    // attenuation
+    float attenuation = 1.0 / (1.0 + lightLinear * distance + lightQuadratic * distance * distance);
+    // the contribution of each light is added to the framebuffer by blending
+    FragColor = vec4((diffuse + specular) * attenuation, 1.0);
+}
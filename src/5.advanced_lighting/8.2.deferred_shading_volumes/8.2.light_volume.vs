@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+// per-light instance data
+layout (location = 3) in vec4 aLightPosition; // xyz: position, w: radius
+layout (location = 4) in vec3 aLightColor;
+
+flat out vec4 LightPosition;
+flat out vec3 LightColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    LightPosition = aLightPosition;
+    LightColor = aLightColor;
+    // scale the (unit) bounding sphere to the light's radius
+    gl_Position = projection * view * vec4(aLightPosition.xyz + aPos * aLightPosition.w, 1.0);
+}
@@ -10,7 +10,9 @@
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
 
+#include <cstddef>
 #include <iostream>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -18,7 +20,8 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path, bool gammaCorrection);
 void renderQuad();
-void renderCube();
+void renderCube(unsigned int instances = 1);
+void renderSphere(unsigned int instances = 1);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -34,6 +37,25 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// per-light instance data; the instance buffer is read as vertex attributes by the
+// light volumes/boxes and as a texture buffer (2 RGBA32F texels per light) by the quad path
+struct LightInstance {
+    glm::vec3 Position;
+    float Radius;
+    glm::vec3 Color;
+    float padding;
+};
+const unsigned int MAX_LIGHTS = 4096;
+unsigned int lightInstanceVBO = 0;
+std::vector<LightInstance> generateLights(unsigned int count);
+
+// lighting
+unsigned int lightCount = 32;
+bool useLightVolumes = true;
+bool lightVolumesKeyPressed = false;
+bool benchmarkKeyPressed = false;
+bool benchmarkRequested = false;
+
 int main()
 {
     // glfw: initialize and configure
@@ -83,6 +105,7 @@ int main()
     // -------------------------
     Shader shaderGeometryPass("8.2.g_buffer.vs", "8.2.g_buffer.fs");
     Shader shaderLightingPass("8.2.deferred_shading.vs", "8.2.deferred_shading.fs");
+    Shader shaderLightVolume("8.2.light_volume.vs", "8.2.light_volume.fs");
     Shader shaderLightBox("8.2.deferred_light_box.vs", "8.2.deferred_light_box.fs");
 
     // load models
@@ -143,23 +166,22 @@ int main()
 
     // lighting info
     // -------------
-    const unsigned int NR_LIGHTS = 32;
-    std::vector<glm::vec3> lightPositions;
-    std::vector<glm::vec3> lightColors;
-    srand(13);
-    for (unsigned int i = 0; i < NR_LIGHTS; i++)
-    {
-        // calculate slightly random offsets
-        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
-        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        lightPositions.push_back(glm::vec3(xPos, yPos, zPos));
-        // also calculate random color
-        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        lightColors.push_back(glm::vec3(rColor, gColor, bColor));
-    }
+    const float linear = 0.7f;
+    const float quadratic = 1.8f;
+    glGenBuffers(1, &lightInstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, MAX_LIGHTS * sizeof(LightInstance), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    unsigned int lightTBO;
+    glGenTextures(1, &lightTBO);
+    glBindTexture(GL_TEXTURE_BUFFER, lightTBO);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightInstanceVBO);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    unsigned int uploadedLightCount = 0;
+
+    // timer query for the lighting pass
+    unsigned int timerQuery;
+    glGenQueries(1, &timerQuery);
 
     // shader configuration
     // --------------------
@@ -167,6 +189,69 @@ int main()
     shaderLightingPass.setInt("gPosition", 0);
     shaderLightingPass.setInt("gNormal", 1);
     shaderLightingPass.setInt("gAlbedoSpec", 2);
+    shaderLightingPass.setInt("lights", 3);
+    shaderLightingPass.setFloat("lightLinear", linear);
+    shaderLightingPass.setFloat("lightQuadratic", quadratic);
+    shaderLightVolume.use();
+    shaderLightVolume.setInt("gPosition", 0);
+    shaderLightVolume.setInt("gNormal", 1);
+    shaderLightVolume.setInt("gAlbedoSpec", 2);
+    shaderLightVolume.setVec2("screenSize", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+    shaderLightVolume.setFloat("lightLinear", linear);
+    shaderLightVolume.setFloat("lightQuadratic", quadratic);
+
+    // lighting pass: either a full-screen quad that iterates over all lights per pixel, or the ambient term from a
+    // full-screen quad plus a bounding sphere per light so each light only shades the pixels it actually touches.
+    // Returns the GPU time of the pass in milliseconds if timed (which waits for the GPU to finish).
+    auto lightingPass = [&](const glm::mat4 &projection, const glm::mat4 &view, bool timed) -> float
+    {
+        if (timed)
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_BUFFER, lightTBO);
+        // the quad doesn't need (and shouldn't fail) the depth test against the scene's depth
+        glDisable(GL_DEPTH_TEST);
+        shaderLightingPass.use();
+        shaderLightingPass.setVec3("viewPos", camera.Position);
+        shaderLightingPass.setInt("lightCount", useLightVolumes ? 0 : lightCount); // the light volumes add the lights themselves
+        renderQuad();
+        glEnable(GL_DEPTH_TEST);
+        if (useLightVolumes)
+        {
+            // render the back faces of each light's bounding sphere that lie behind the scene's depth: these
+            // pixels are the ones (potentially) inside the volume. This also works with the camera inside a
+            // volume, where its front faces would be clipped. Each light's contribution is added by blending.
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+            glDepthFunc(GL_GEQUAL);
+            glDepthMask(GL_FALSE);
+            shaderLightVolume.use();
+            shaderLightVolume.setMat4("projection", projection);
+            shaderLightVolume.setMat4("view", view);
+            shaderLightVolume.setVec3("viewPos", camera.Position);
+            renderSphere(lightCount);
+            glDepthMask(GL_TRUE);
+            glDepthFunc(GL_LESS);
+            glCullFace(GL_BACK);
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+        }
+        if (!timed)
+            return 0.0f;
+        glEndQuery(GL_TIME_ELAPSED);
+        GLuint64 elapsed;
+        glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsed);
+        return elapsed / 1000000.0f;
+    };
 
     // render loop
     // -----------
@@ -182,6 +267,16 @@ int main()
         // -----
         processInput(window);
 
+        // (re)upload the lights if their count changed
+        if (uploadedLightCount != lightCount)
+        {
+            std::vector<LightInstance> lights = generateLights(lightCount);
+            glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, lights.size() * sizeof(LightInstance), lights.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            uploadedLightCount = lightCount;
+        }
+
         // render
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -207,37 +302,8 @@ int main()
         }
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 2. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
-        // -----------------------------------------------------------------------------------------------------------------------
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderLightingPass.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        // send light relevant uniforms
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
-        {
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Position", lightPositions[i]);
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Color", lightColors[i]);
-            // update attenuation parameters and calculate radius
-            const float constant = 1.0f; // note that we don't send this to the shader, we assume it is always 1.0 (in our case)
-            const float linear = 0.7f;
-            const float quadratic = 1.8f;
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Linear", linear);
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
-            // then calculate radius of light volume/sphere
-            const float maxBrightness = std::fmaxf(std::fmaxf(lightColors[i].r, lightColors[i].g), lightColors[i].b);
-            float radius = (-linear + std::sqrt(linear * linear - 4 * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) / (2.0f * quadratic);
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Radius", radius);
-        }
-        shaderLightingPass.setVec3("viewPos", camera.Position);
-        // finally render quad
-        renderQuad();
-
-        // 2.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
+        // 2. copy content of geometry's depth buffer to default framebuffer's depth buffer; the light volumes
+        // are depth tested against it so this now has to happen before the lighting pass
         // ----------------------------------------------------------------------------------
         glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
@@ -247,20 +313,48 @@ int main()
         glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 3. render lights on top of scene
-        // --------------------------------
+        // benchmark: time the quad and light volume path at an increasing number of lights (on the current g-buffer)
+        if (benchmarkRequested)
+        {
+            const unsigned int BENCHMARK_FRAMES = 20;
+            const unsigned int benchmarkCounts[] = { 32, 512, 4096 };
+            unsigned int previousCount = lightCount;
+            bool previousMode = useLightVolumes;
+            std::cout << "lights   quad (ms)   light volumes (ms)" << std::endl;
+            for (unsigned int count : benchmarkCounts)
+            {
+                std::vector<LightInstance> lights = generateLights(count);
+                glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, lights.size() * sizeof(LightInstance), lights.data());
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                lightCount = count;
+                float quadTime = 0.0f, volumeTime = 0.0f;
+                for (unsigned int i = 0; i < BENCHMARK_FRAMES; i++)
+                {
+                    useLightVolumes = false;
+                    quadTime += lightingPass(projection, view, true) / BENCHMARK_FRAMES;
+                    useLightVolumes = true;
+                    volumeTime += lightingPass(projection, view, true) / BENCHMARK_FRAMES;
+                }
+                std::cout << count << "\t " << quadTime << "\t     " << volumeTime << std::endl;
+            }
+            lightCount = previousCount;
+            useLightVolumes = previousMode;
+            uploadedLightCount = 0; // restore the lights next frame
+            benchmarkRequested = false;
+        }
+
+        // 3. lighting pass: calculate lighting using the gbuffer's content
+        // ----------------------------------------------------------------
+        lightingPass(projection, view, false);
+
+        // 4. render lights on top of scene (one instance per light)
+        // --------------------------------------------------------
         shaderLightBox.use();
         shaderLightBox.setMat4("projection", projection);
         shaderLightBox.setMat4("view", view);
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
-        {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, lightPositions[i]);
-            model = glm::scale(model, glm::vec3(0.125f));
-            shaderLightBox.setMat4("model", model);
-            shaderLightBox.setVec3("lightColor", lightColors[i]);
-            renderCube();
-        }
+        shaderLightBox.setFloat("boxSize", 0.125f);
+        renderCube(lightCount);
 
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -273,11 +367,116 @@ int main()
     return 0;
 }
 
-// renderCube() renders a 1x1 3D cube in NDC.
+// generates the given number of randomly placed and colored lights, including the radius of their volume
+// ---------------------------------------------------------------------------------------------------------
+std::vector<LightInstance> generateLights(unsigned int count)
+{
+    std::vector<LightInstance> lights(count);
+    srand(13);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // calculate slightly random offsets
+        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
+        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
+        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
+        lights[i].Position = glm::vec3(xPos, yPos, zPos);
+        // also calculate random color
+        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
+        lights[i].Color = glm::vec3(rColor, gColor, bColor);
+        // calculate radius of light volume/sphere
+        const float constant = 1.0f; // note that we don't send this to the shader, we assume it is always 1.0 (in our case)
+        const float linear = 0.7f;
+        const float quadratic = 1.8f;
+        const float maxBrightness = std::fmaxf(std::fmaxf(rColor, gColor), bColor);
+        lights[i].Radius = (-linear + std::sqrt(linear * linear - 4 * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) / (2.0f * quadratic);
+    }
+    return lights;
+}
+
+// configures the per-light instance attributes (location 3 and 4) on the currently bound VAO
+// ------------------------------------------------------------------------------------------
+void setupLightInstanceAttributes()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(LightInstance), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(LightInstance), (void*)offsetof(LightInstance, Color));
+    glVertexAttribDivisor(4, 1);
+}
+
+// renderSphere() renders (instances of) a low-poly sphere that fully encloses the unit sphere
+// -------------------------------------------------------------------------------------------
+unsigned int sphereVAO = 0;
+unsigned int sphereIndexCount;
+void renderSphere(unsigned int instances)
+{
+    if (sphereVAO == 0)
+    {
+        const unsigned int X_SEGMENTS = 16;
+        const unsigned int Y_SEGMENTS = 8;
+        const float PI = 3.14159265359f;
+        // the faces of a tessellated sphere lie inside the sphere; push them out so the volume covers the whole light radius
+        const float scale = 1.0f / (std::cos(PI / X_SEGMENTS) * std::cos(PI / (2 * Y_SEGMENTS)));
+        std::vector<glm::vec3> positions;
+        std::vector<unsigned int> indices;
+        for (unsigned int y = 0; y <= Y_SEGMENTS; ++y)
+        {
+            for (unsigned int x = 0; x <= X_SEGMENTS; ++x)
+            {
+                float xSegment = (float)x / (float)X_SEGMENTS;
+                float ySegment = (float)y / (float)Y_SEGMENTS;
+                float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+                float yPos = std::cos(ySegment * PI);
+                float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+                positions.push_back(glm::vec3(xPos, yPos, zPos) * scale);
+            }
+        }
+        // counter-clockwise triangles (seen from the outside)
+        for (unsigned int y = 0; y < Y_SEGMENTS; ++y)
+        {
+            for (unsigned int x = 0; x < X_SEGMENTS; ++x)
+            {
+                unsigned int i0 = y * (X_SEGMENTS + 1) + x;
+                unsigned int i1 = (y + 1) * (X_SEGMENTS + 1) + x;
+                indices.push_back(i0);
+                indices.push_back(i0 + 1);
+                indices.push_back(i1);
+                indices.push_back(i0 + 1);
+                indices.push_back(i1 + 1);
+                indices.push_back(i1);
+            }
+        }
+        sphereIndexCount = static_cast<unsigned int>(indices.size());
+
+        unsigned int vbo, ebo;
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), &positions[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+        setupLightInstanceAttributes();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    glBindVertexArray(sphereVAO);
+    glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, instances);
+    glBindVertexArray(0);
+}
+
+// renderCube() renders (instances of) a 1x1 3D cube in NDC.
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
 unsigned int cubeVBO = 0;
-void renderCube()
+void renderCube(unsigned int instances)
 {
     // initialize (if necessary)
     if (cubeVAO == 0)
@@ -339,12 +538,13 @@ void renderCube()
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(2);
         glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        setupLightInstanceAttributes();
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
     // render Cube
     glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instances);
     glBindVertexArray(0);
 }
 
@@ -395,6 +595,25 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // V toggles between light volumes and the full-screen quad
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !lightVolumesKeyPressed)
+    {
+        useLightVolumes = !useLightVolumes;
+        lightVolumesKeyPressed = true;
+        std::cout << (useLightVolumes ? "light volumes" : "full-screen quad") << std::endl;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE)
+        lightVolumesKeyPressed = false;
+
+    // B runs the benchmark
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkRequested = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+        benchmarkKeyPressed = false;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,9 @@
+#version 430 core
+layout (location = 0) out vec4 FragColor;
+
+in vec3 LightColor;
+
+void main()
+{           
+    FragColor = vec4(LightColor, 1.0);
+}
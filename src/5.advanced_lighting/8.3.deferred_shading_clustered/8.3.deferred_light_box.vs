@@ -0,0 +1,29 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+struct PointLight {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+out vec3 LightColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform float boxSize;
+
+void main()
+{
+    // one instance per light
+    PointLight light = lights[gl_InstanceID];
+    LightColor = light.Color;
+    gl_Position = projection * view * vec4(light.Position + aPos * boxSize, 1.0);
+}
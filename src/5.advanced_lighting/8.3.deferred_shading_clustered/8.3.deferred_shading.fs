@@ -0,0 +1,87 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+// must match 8.3.light_culling.cs
+const uint CLUSTERS_X = 16;
+const uint CLUSTERS_Y = 9;
+const uint CLUSTERS_Z = 24;
+
+struct PointLight {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+// offset into lightIndices and number of lights per cluster
+layout (std430, binding = 1) readonly buffer ClusterGrid {
+    uvec2 clusterLights[];
+};
+layout (std430, binding = 2) readonly buffer ClusterIndices {
+    uint lightIndices[];
+};
+
+uniform vec3 viewPos;
+uniform mat4 view;
+uniform vec2 screenSize;
+uniform float zNear;
+uniform float zFar;
+uniform uint lightCount;
+uniform bool clustered; // if false, every light is evaluated for every fragment (for comparison)
+
+vec3 shadeLight(PointLight light, vec3 FragPos, vec3 Normal, vec3 Diffuse, float Specular, vec3 viewDir)
+{
+    // calculate distance between light source and current fragment
+    float distance = length(light.Position - FragPos);
+    if(distance >= light.Radius)
+        return vec3(0.0);
+    // diffuse
+    vec3 lightDir = normalize(light.Position - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.Color;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);  
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = light.Color * spec * Specular;
+    // attenuation
+    float attenuation = 1.0 / (1.0 + light.Linear * distance + light.Quadratic * distance * distance);
+    return (diffuse + specular) * attenuation;
+}
+
+void main()
+{             
+    // retrieve data from gbuffer
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+    
+    // then calculate lighting as usual
+    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    if(clustered)
+    {
+        // find the cluster of this fragment and only iterate over the lights binned into it
+        float depth = -(view * vec4(FragPos, 1.0)).z;
+        uint slice = uint(clamp(log(depth / zNear) / log(zFar / zNear) * CLUSTERS_Z, 0.0, CLUSTERS_Z - 1));
+        uvec2 tile = min(uvec2(gl_FragCoord.xy / ceil(screenSize / vec2(CLUSTERS_X, CLUSTERS_Y))), uvec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+        uint cluster = tile.x + tile.y * CLUSTERS_X + slice * CLUSTERS_X * CLUSTERS_Y;
+        uvec2 range = clusterLights[cluster];
+        for(uint i = 0; i < range.y; ++i)
+            lighting += shadeLight(lights[lightIndices[range.x + i]], FragPos, Normal, Diffuse, Specular, viewDir);
+    }
+    else
+    {
+        for(uint i = 0; i < lightCount; ++i)
+            lighting += shadeLight(lights[i], FragPos, Normal, Diffuse, Specular, viewDir);
+    }
+    FragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,121 @@
+#version 430 core
+// Bins all lights into a grid of view-space clusters: the screen is divided into
+// CLUSTERS_X * CLUSTERS_Y tiles and the view frustum into CLUSTERS_Z depth slices
+// (exponentially spaced, so clusters are roughly cubic). Every invocation handles
+// a single cluster and tests each light's sphere against the cluster's AABB: once to
+// count its lights and reserve that many entries of the shared index list, then again
+// to write their indices. A cluster whose lights don't fit in the index list anymore
+// keeps the ones that do and is counted in the stats.
+layout (local_size_x = 128) in;
+
+const uint CLUSTERS_X = 16;
+const uint CLUSTERS_Y = 9;
+const uint CLUSTERS_Z = 24;
+const uint MAX_LIGHT_INDICES = 2097152;
+
+struct PointLight {
+    vec3 Position;
+    float Radius;
+    vec3 Color;
+    float Linear;
+    float Quadratic;
+};
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+// offset into lightIndices and number of lights per cluster
+layout (std430, binding = 1) writeonly buffer ClusterGrid {
+    uvec2 clusterLights[];
+};
+// the light indices of all clusters, each cluster's lights one after another
+layout (std430, binding = 2) writeonly buffer ClusterIndices {
+    uint lightIndices[];
+};
+// reset to 0 before every dispatch
+layout (std430, binding = 3) buffer ClusterStats {
+    uint indexCount;
+    uint overflowedClusters;
+};
+
+uniform mat4 view;
+uniform mat4 inverseProjection;
+uniform vec2 screenSize;
+uniform float zNear;
+uniform float zFar;
+uniform uint lightCount;
+
+// lights are loaded in batches (one per invocation) and shared by the whole work group
+shared vec4 sharedLights[gl_WorkGroupSize.x];
+
+// converts a screen-space pixel position to a view-space position on the near plane
+vec3 screenToView(vec2 pixel)
+{
+    vec2 ndc = pixel / screenSize * 2.0 - 1.0;
+    vec4 position = inverseProjection * vec4(ndc, -1.0, 1.0);
+    return position.xyz / position.w;
+}
+
+// intersection of the ray from the eye through the given point with the plane at view-space depth z
+vec3 onDepthPlane(vec3 point, float z)
+{
+    return point * (z / point.z);
+}
+
+void main()
+{
+    uint cluster = gl_GlobalInvocationID.x;
+    bool active = cluster < CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+    uvec3 id = uvec3(cluster % CLUSTERS_X, (cluster / CLUSTERS_X) % CLUSTERS_Y, cluster / (CLUSTERS_X * CLUSTERS_Y));
+
+    // view-space AABB of this cluster
+    vec2 tileSize = ceil(screenSize / vec2(CLUSTERS_X, CLUSTERS_Y));
+    vec3 minPoint = screenToView(vec2(id.xy) * tileSize);
+    vec3 maxPoint = screenToView(vec2(id.xy + 1) * tileSize);
+    float sliceNear = -zNear * pow(zFar / zNear, float(id.z) / CLUSTERS_Z);
+    float sliceFar  = -zNear * pow(zFar / zNear, float(id.z + 1) / CLUSTERS_Z);
+    vec3 p0 = onDepthPlane(minPoint, sliceNear);
+    vec3 p1 = onDepthPlane(minPoint, sliceFar);
+    vec3 p2 = onDepthPlane(maxPoint, sliceNear);
+    vec3 p3 = onDepthPlane(maxPoint, sliceFar);
+    vec3 aabbMin = min(min(p0, p1), min(p2, p3));
+    vec3 aabbMax = max(max(p0, p1), max(p2, p3));
+
+    uint count = 0, offset = 0, reserved = 0;
+    for (uint pass = 0; pass < 2; ++pass)
+    {
+        count = 0;
+        for (uint batch = 0; batch < lightCount; batch += gl_WorkGroupSize.x)
+        {
+            // load a batch of lights into shared memory (in view space)
+            uint index = batch + gl_LocalInvocationIndex;
+            if (index < lightCount)
+                sharedLights[gl_LocalInvocationIndex] = vec4(vec3(view * vec4(lights[index].Position, 1.0)), lights[index].Radius);
+            barrier();
+            uint batchSize = min(gl_WorkGroupSize.x, lightCount - batch);
+            for (uint i = 0; active && i < batchSize; ++i)
+            {
+                // sphere-AABB test: squared distance from the light to the closest point of the box
+                vec4 light = sharedLights[i];
+                vec3 closest = clamp(light.xyz, aabbMin, aabbMax);
+                vec3 d = closest - light.xyz;
+                if (dot(d, d) <= light.w * light.w)
+                {
+                    if (pass == 1 && count < reserved)
+                        lightIndices[offset + count] = batch + i;
+                    ++count;
+                }
+            }
+            barrier();
+        }
+        // reserve this cluster's part of the index list
+        if (pass == 0 && active)
+        {
+            offset = atomicAdd(indexCount, count);
+            reserved = offset < MAX_LIGHT_INDICES ? min(count, MAX_LIGHT_INDICES - offset) : 0;
+            if (reserved < count)
+                atomicAdd(overflowedClusters, 1);
+        }
+    }
+    if (active)
+        clusterLights[cluster] = uvec2(offset, reserved);
+}
@@ -0,0 +1,51 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+// the compact g-buffer layout stores octahedral encoded normals
+uniform bool octahedralNormals;
+uniform mat4 inverseProjection;
+
+// inverse of the octahedral encoding of the compact geometry pass
+vec3 decodeNormal(vec2 f)
+{
+    f = f * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// view-space depth of a g-buffer texel
+float viewDepth(ivec2 texel)
+{
+    vec2 texCoords = (vec2(texel) + 0.5) / vec2(textureSize(gDepth, 0));
+    float depth = texelFetch(gDepth, texel, 0).r;
+    vec4 position = inverseProjection * vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    return position.z / position.w;
+}
+
+// first level of the depth/normal pyramid: of each 2x2 g-buffer texels the one closest to the camera is kept
+// (averaging depths would create surfaces that don't exist), stored as its view-space normal and depth
+void main()
+{
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    ivec2 closest = base;
+    float closestDepth = -1e30;
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 texel = min(base + ivec2(i % 2, i / 2), textureSize(gDepth, 0) - 1);
+        float depth = viewDepth(texel);
+        if (depth > closestDepth)
+        {
+            closest = texel;
+            closestDepth = depth;
+        }
+    }
+    vec3 normal = octahedralNormals ? decodeNormal(texelFetch(gNormal, closest, 0).rg) : normalize(texelFetch(gNormal, closest, 0).rgb);
+    FragColor = vec4(normal, closestDepth);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D normalDepth;
+
+// next level of the depth/normal pyramid: keeps the closest of each 2x2 texels of the previous level
+void main()
+{
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    vec4 closest = vec4(0.0, 0.0, 0.0, -1e30);
+    for (int i = 0; i < 4; ++i)
+    {
+        vec4 texel = texelFetch(normalDepth, min(base + ivec2(i % 2, i / 2), textureSize(normalDepth, 0) - 1), 0);
+        if (texel.w > closest.w)
+            closest = texel;
+    }
+    FragColor = closest;
+}
@@ -0,0 +1,29 @@
+#version 330 core
+layout (location = 0) out vec2 gNormal;
+layout (location = 1) out vec4 gAlbedo;
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 Normal;
+
+// folds the lower hemisphere of the octahedron over the upper one
+vec2 octWrap(vec2 v)
+{
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// maps a unit vector onto the octahedron and unfolds it into the [0, 1] square
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    n.xy = n.z >= 0.0 ? n.xy : octWrap(n.xy);
+    return n.xy * 0.5 + 0.5;
+}
+
+void main()
+{    
+    // the view-space position is reconstructed from depth, so only the normal is stored (octahedral encoded)
+    gNormal = encodeNormal(normalize(Normal));
+    // and the diffuse per-fragment color
+    gAlbedo = vec4(vec3(0.95), 0.0);
+}
@@ -0,0 +1,125 @@
+#version 430 core
+layout (local_size_x = 16, local_size_y = 16) in;
+
+// raw AO, blurred/upsampled by the same passes as the hemisphere kernel's
+layout (r16f, binding = 0) uniform writeonly image2D aoOutput;
+
+// source of the view-space depth: the g-buffer's depth buffer or (pyramidInput) a level of the depth/normal pyramid
+uniform sampler2D depthInput;
+uniform bool pyramidInput;
+
+uniform mat4 projection;
+uniform mat4 inverseProjection;
+
+// slices through the hemisphere, each marched to both sides, and the samples per side
+uniform int directionCount;
+uniform int stepCount;
+uniform int frameIndex;
+
+float radius = 0.5;
+
+// every work group loads its tile of depths plus an apron of the maximum march distance into shared memory once,
+// so the marches of all its pixels read from there instead of the texture
+const int TILE = 16;
+const int APRON = 16;
+const int SHARED_SIZE = TILE + 2 * APRON;
+shared float depths[SHARED_SIZE * SHARED_SIZE];
+
+const float PI = 3.14159265359;
+
+float loadViewDepth(ivec2 texel)
+{
+    ivec2 size = textureSize(depthInput, 0);
+    texel = clamp(texel, ivec2(0), size - 1);
+    vec4 value = texelFetch(depthInput, texel, 0);
+    if (pyramidInput)
+        return value.w;
+    // un-project the stored depth
+    vec2 texCoords = (vec2(texel) + 0.5) / vec2(size);
+    vec4 position = inverseProjection * vec4(vec3(texCoords, value.r) * 2.0 - 1.0, 1.0);
+    return position.z / position.w;
+}
+
+// view-space position of a texel of the shared tile
+vec3 viewPosition(ivec2 local, ivec2 origin)
+{
+    float viewZ = depths[local.y * SHARED_SIZE + local.x];
+    vec2 ndc = (vec2(origin + local) + 0.5) / vec2(imageSize(aoOutput)) * 2.0 - 1.0;
+    return vec3(ndc.x * -viewZ / projection[0][0], ndc.y * -viewZ / projection[1][1], viewZ);
+}
+
+// ground truth AO (Jimenez et al.): per slice, the horizon angles on both sides of the view vector are searched
+// and the cosine weighted visible arc between them is integrated analytically
+void main()
+{
+    ivec2 origin = ivec2(gl_WorkGroupID.xy) * TILE - APRON;
+    for (int i = int(gl_LocalInvocationIndex); i < SHARED_SIZE * SHARED_SIZE; i += TILE * TILE)
+        depths[i] = loadViewDepth(origin + ivec2(i % SHARED_SIZE, i / SHARED_SIZE));
+    barrier();
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(aoOutput);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy) + APRON;
+    vec3 P = viewPosition(local, origin);
+    // normal from the depths: on each axis the neighbor closer in depth, so it doesn't bend over edges
+    vec3 left  = viewPosition(local - ivec2(1, 0), origin);
+    vec3 right = viewPosition(local + ivec2(1, 0), origin);
+    vec3 down  = viewPosition(local - ivec2(0, 1), origin);
+    vec3 up    = viewPosition(local + ivec2(0, 1), origin);
+    vec3 dx = abs(P.z - left.z) < abs(right.z - P.z) ? P - left : right - P;
+    vec3 dy = abs(P.z - down.z) < abs(up.z - P.z) ? P - down : up - P;
+    vec3 N = normalize(cross(dx, dy));
+    vec3 V = normalize(-P);
+
+    // the world-space radius in pixels, limited to what's in shared memory
+    float radiusPixels = min(radius * projection[1][1] * 0.5 * float(size.y) / -P.z, float(APRON - 1));
+    if (radiusPixels < 1.0)
+    {
+        imageStore(aoOutput, texel, vec4(1.0));
+        return;
+    }
+    float stepSize = radiusPixels / float(stepCount);
+
+    // interleaved gradient noise rotates the slices and offsets the steps per pixel and frame
+    float noise = fract(52.9829189 * fract(dot(vec2(texel) + float(frameIndex) * 5.588238, vec2(0.06711056, 0.00583715))));
+    float jitter = fract(noise * 8.0);
+
+    float visibility = 0.0;
+    for (int slice = 0; slice < directionCount; ++slice)
+    {
+        float phi = (float(slice) + noise) * PI / float(directionCount);
+        vec2 direction = vec2(cos(phi), sin(phi));
+        // the slice's plane and the normal projected onto it
+        vec3 sliceDirection = vec3(direction, 0.0);
+        vec3 orthoDirection = sliceDirection - dot(sliceDirection, V) * V;
+        vec3 axis = normalize(cross(sliceDirection, V));
+        vec3 projectedNormal = N - axis * dot(N, axis);
+        float projectedLength = length(projectedNormal);
+        float cosN = clamp(dot(projectedNormal, V) / projectedLength, 0.0, 1.0);
+        float n = sign(dot(orthoDirection, projectedNormal)) * acos(cosN);
+
+        // march both sides for the highest horizon; samples beyond the radius fade out
+        float horizonCos[2];
+        for (int side = 0; side < 2; ++side)
+        {
+            horizonCos[side] = -1.0;
+            for (int s = 0; s < stepCount; ++s)
+            {
+                float distance = max(1.0, (float(s) + jitter) * stepSize);
+                ivec2 offset = ivec2(round((side == 0 ? -direction : direction) * distance));
+                vec3 delta = viewPosition(local + offset, origin) - P;
+                float len = length(delta);
+                float falloff = clamp(1.0 - len * len / (radius * radius), 0.0, 1.0);
+                horizonCos[side] = max(horizonCos[side], mix(-1.0, dot(delta / len, V), falloff));
+            }
+        }
+        // horizon angles, clamped to the normal's hemisphere
+        float h0 = n + max(-acos(horizonCos[0]) - n, -PI / 2.0);
+        float h1 = n + min(acos(horizonCos[1]) - n, PI / 2.0);
+        visibility += projectedLength * 0.25 * ((-cos(2.0 * h0 - n) + cosN + 2.0 * h0 * sin(n)) + (-cos(2.0 * h1 - n) + cosN + 2.0 * h1 * sin(n)));
+    }
+    imageStore(aoOutput, texel, vec4(clamp(visibility / float(directionCount), 0.0, 1.0)));
+}
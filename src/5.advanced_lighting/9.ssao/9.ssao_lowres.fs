@@ -0,0 +1,71 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D normalDepth;
+uniform sampler2D texNoise;
+
+// the sample kernel, uploaded once
+layout (std140) uniform SSAOKernel
+{
+    vec4 samples[64];
+};
+
+// only a few samples are taken per frame; every frame takes a different subset of the kernel and a
+// different noise rotation, so the temporal accumulation converges to the full kernel over time
+uniform int kernelSize;
+uniform int frameIndex;
+uniform vec2 noiseOffset;
+
+float radius = 0.5;
+float bias = 0.025;
+
+uniform mat4 projection;
+
+// view-space position of a pyramid texel from its view-space depth
+vec3 viewPosition(vec2 texCoords, float viewZ)
+{
+    vec2 ndc = texCoords * 2.0 - 1.0;
+    return vec3(ndc.x * -viewZ / projection[0][0], ndc.y * -viewZ / projection[1][1], viewZ);
+}
+
+void main()
+{
+    // get input for SSAO algorithm
+    vec4 center = texture(normalDepth, TexCoords);
+    vec3 fragPos = viewPosition(TexCoords, center.w);
+    vec3 normal = normalize(center.xyz);
+    // tile noise texture over the pyramid level
+    vec2 noiseScale = vec2(textureSize(normalDepth, 0)) / 4.0;
+    vec3 randomVec = normalize(texture(texNoise, TexCoords * noiseScale + noiseOffset).xyz);
+    // create TBN change-of-basis matrix: from tangent-space to view-space
+    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
+    vec3 bitangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, bitangent, normal);
+    // iterate over this frame's subset of the kernel, spread over all of its radii
+    float occlusion = 0.0;
+    int stride = 64 / kernelSize;
+    for(int i = 0; i < kernelSize; ++i)
+    {
+        // get sample position
+        vec3 samplePos = TBN * samples[(i * stride + frameIndex) % 64].xyz; // from tangent to view-space
+        samplePos = fragPos + samplePos * radius; 
+        
+        // project sample position (to sample texture) (to get position on screen/texture)
+        vec4 offset = vec4(samplePos, 1.0);
+        offset = projection * offset; // from view to clip-space
+        offset.xyz /= offset.w; // perspective divide
+        offset.xyz = offset.xyz * 0.5 + 0.5; // transform to range 0.0 - 1.0
+        
+        // get sample depth
+        float sampleDepth = texture(normalDepth, offset.xy).w; // get depth value of kernel sample
+        
+        // range check & accumulate
+        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
+        occlusion += (sampleDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;           
+    }
+    occlusion = 1.0 - (occlusion / kernelSize);
+    
+    FragColor = occlusion;
+}
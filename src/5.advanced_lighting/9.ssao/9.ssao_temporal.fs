@@ -0,0 +1,38 @@
+#version 330 core
+out vec2 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D currentAO;
+uniform sampler2D history;    // accumulated AO (r) and the view-space depth it belongs to (g) of the previous frame
+uniform sampler2D normalDepth;
+
+uniform mat4 projection;
+uniform mat4 viewToPrevView;  // current view space to the previous frame's view space
+uniform bool historyValid;
+uniform float historyWeight;
+
+// view-space position of a pyramid texel from its view-space depth
+vec3 viewPosition(vec2 texCoords, float viewZ)
+{
+    vec2 ndc = texCoords * 2.0 - 1.0;
+    return vec3(ndc.x * -viewZ / projection[0][0], ndc.y * -viewZ / projection[1][1], viewZ);
+}
+
+void main()
+{
+    float ao = texture(currentAO, TexCoords).r;
+    float viewZ = texture(normalDepth, TexCoords).w;
+    // reproject the surface into the previous frame
+    vec4 prevPos = viewToPrevView * vec4(viewPosition(TexCoords, viewZ), 1.0);
+    vec4 prevClip = projection * prevPos;
+    vec2 prevTexCoords = prevClip.xy / prevClip.w * 0.5 + 0.5;
+    if (historyValid && all(greaterThanEqual(prevTexCoords, vec2(0.0))) && all(lessThanEqual(prevTexCoords, vec2(1.0))))
+    {
+        vec2 previous = texture(history, prevTexCoords).rg;
+        // the history is only reused if it belongs to the same surface, otherwise it was disoccluded
+        if (abs(previous.g - prevPos.z) < 0.05 * abs(prevPos.z))
+            ao = mix(ao, previous.r, historyWeight);
+    }
+    FragColor = vec2(ao, viewZ);
+}
@@ -0,0 +1,52 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D aoInput; // low resolution AO (r) and view-space depth (g)
+uniform sampler2D gDepth;
+
+uniform mat4 inverseProjection;
+
+float depthSharpness = 50.0;
+
+// un-projects the stored depth back to a view-space depth
+float viewDepth(vec2 texCoords)
+{
+    float depth = texture(gDepth, texCoords).r;
+    vec4 position = inverseProjection * vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+    return position.z / position.w;
+}
+
+// bilateral upsample: the 4 low resolution texels around the pixel are weighted bilinearly and by how close
+// their depth is to the pixel's, so AO doesn't bleed over depth discontinuities
+void main()
+{
+    float depth = viewDepth(TexCoords);
+    ivec2 size = textureSize(aoInput, 0);
+    vec2 position = TexCoords * vec2(size) - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 f = fract(position);
+
+    float result = 0.0;
+    float totalWeight = 0.0;
+    float closestDifference = 1e30;
+    float closestAO = 1.0;
+    for (int i = 0; i < 4; ++i)
+    {
+        ivec2 offset = ivec2(i % 2, i / 2);
+        vec2 texel = texelFetch(aoInput, clamp(base + offset, ivec2(0), size - 1), 0).rg;
+        float difference = abs(texel.g - depth);
+        float bilinear = (offset.x == 1 ? f.x : 1.0 - f.x) * (offset.y == 1 ? f.y : 1.0 - f.y);
+        float weight = bilinear * exp(-depthSharpness * difference / abs(depth));
+        result += texel.r * weight;
+        totalWeight += weight;
+        if (difference < closestDifference)
+        {
+            closestDifference = difference;
+            closestAO = texel.r;
+        }
+    }
+    // none of the texels is on the same surface (thin geometry): take the closest in depth
+    FragColor = totalWeight > 0.0001 ? result / totalWeight : closestAO;
+}
@@ -7,8 +7,10 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
 
 #include <iostream>
 #include <random>
@@ -20,6 +22,7 @@ void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path, bool gammaCorrection);
 void renderQuad();
 void renderCube();
+unsigned int createSSAOTarget(unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, unsigned int &texture);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -35,6 +38,45 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// g-buffer layout
+GBuffer_Layout gBufferLayout = GBUFFER_STANDARD;
+bool gBufferLayoutChanged = false;
+bool layoutKeyPressed = false;
+
+// SSAO resolution: the full resolution pass (64 samples + blur) is the reference; the reduced resolutions run on a
+// depth/normal pyramid with fewer samples per pixel, accumulate them over frames and upsample the result bilaterally
+enum SSAO_Resolution {
+    SSAO_FULL,
+    SSAO_HALF,
+    SSAO_QUARTER
+};
+SSAO_Resolution ssaoResolution = SSAO_HALF;
+bool ssaoResolutionChanged = true;
+bool resolutionKeyPressed = false;
+int lowResKernelSize = 12;
+bool kernelKeyPressed = false;
+// AO method: the hemisphere kernel or horizon-based (GTAO) compute kernel; both share the blur/upsample passes
+enum SSAO_Method {
+    SSAO_HEMISPHERE,
+    SSAO_HORIZON
+};
+SSAO_Method ssaoMethod = SSAO_HEMISPHERE;
+bool methodKeyPressed = false;
+// renders the test scene from a set of views with both methods and prints their timings and difference
+bool benchmarkSSAO = false;
+bool benchmarkKeyPressed = false;
+// renders the reference next to the reduced resolution pass once and prints their difference and timings
+bool compareSSAO = false;
+bool compareKeyPressed = false;
+
+// the targets of a pyramid level
+struct SSAOLevel {
+    unsigned int Width, Height;
+    unsigned int NormalDepthFBO, NormalDepth;  // view-space normal (rgb) and depth (a) of the closest g-buffer texel
+    unsigned int AOFBO, AO;                    // this frame's AO
+    unsigned int HistoryFBO[2], History[2];    // accumulated AO (r) and its view-space depth (g), ping-ponged
+};
+
 float ourLerp(float a, float b, float f)
 {
     return a + f * (b - a);
@@ -45,7 +87,8 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // the horizon-based AO is a compute shader, which requires OpenGL 4.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -84,10 +127,26 @@ int main()
 
     // build and compile shaders
     // -------------------------
-    Shader shaderGeometryPass("9.ssao_geometry.vs", "9.ssao_geometry.fs");
-    Shader shaderLightingPass("9.ssao.vs", "9.ssao_lighting.fs");
-    Shader shaderSSAO("9.ssao.vs", "9.ssao.fs");
+    // the geometry, SSAO and lighting pass shaders are picked by the g-buffer's layout
+    Shader shaderGeometryPass[] = {
+        Shader("9.ssao_geometry.vs", "9.ssao_geometry.fs"),          // GBUFFER_STANDARD
+        Shader("9.ssao_geometry.vs", "9.ssao_geometry_compact.fs"),  // GBUFFER_COMPACT
+    };
+    Shader shaderLightingPass[] = {
+        Shader("9.ssao.vs", "9.ssao_lighting.fs"),
+        Shader("9.ssao.vs", "9.ssao_lighting_compact.fs"),
+    };
+    Shader shaderSSAO[] = {
+        Shader("9.ssao.vs", "9.ssao.fs"),
+        Shader("9.ssao.vs", "9.ssao_compact.fs"),
+    };
     Shader shaderSSAOBlur("9.ssao.vs", "9.ssao_blur.fs");
+    Shader shaderSSAODownsample("9.ssao.vs", "9.ssao_downsample.fs");
+    Shader shaderSSAODownsampleLevel("9.ssao.vs", "9.ssao_downsample_level.fs");
+    Shader shaderSSAOLowRes("9.ssao.vs", "9.ssao_lowres.fs");
+    Shader shaderSSAOTemporal("9.ssao.vs", "9.ssao_temporal.fs");
+    Shader shaderSSAOUpsample("9.ssao.vs", "9.ssao_upsample.fs");
+    ComputeShader shaderSSAOHorizon("9.ssao_horizon.cs");
 
     // load models
     // -----------
@@ -95,46 +154,7 @@ int main()
 
     // configure g-buffer framebuffer
     // ------------------------------
-    unsigned int gBuffer;
-    glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition, gNormal, gAlbedo;
-    // position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-    // normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-    // color + specular color buffer
-    glGenTextures(1, &gAlbedo);
-    glBindTexture(GL_TEXTURE_2D, gAlbedo);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-    glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GBuffer gBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
 
     // also create framebuffer to hold SSAO processing stage 
     // -----------------------------------------------------
@@ -145,7 +165,8 @@ int main()
     // SSAO color buffer
     glGenTextures(1, &ssaoColorBuffer);
     glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, SCR_WIDTH, SCR_HEIGHT, 0, GL_RED, GL_FLOAT, NULL);
+    // (R16F, so the horizon-based compute kernel can write it as an image)
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RED, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ssaoColorBuffer, 0);
@@ -163,6 +184,23 @@ int main()
         std::cout << "SSAO Blur Framebuffer not complete!" << std::endl;
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    // and the reduced resolution pipeline: a half and a quarter resolution pyramid level and the full resolution
+    // upsampled result
+    // -------------------------------------------------------------------------------------------------------
+    SSAOLevel ssaoLevels[2];
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+        SSAOLevel &level = ssaoLevels[i];
+        level.Width = SCR_WIDTH >> (i + 1);
+        level.Height = SCR_HEIGHT >> (i + 1);
+        level.NormalDepthFBO = createSSAOTarget(level.Width, level.Height, GL_RGBA32F, GL_RGBA, level.NormalDepth);
+        level.AOFBO = createSSAOTarget(level.Width, level.Height, GL_R16F, GL_RED, level.AO);
+        for (unsigned int j = 0; j < 2; ++j)
+            level.HistoryFBO[j] = createSSAOTarget(level.Width, level.Height, GL_RG32F, GL_RG, level.History[j]);
+    }
+    unsigned int ssaoColorBufferUpsampled;
+    unsigned int ssaoUpsampleFBO = createSSAOTarget(SCR_WIDTH, SCR_HEIGHT, GL_RED, GL_RED, ssaoColorBufferUpsampled);
+
     // generate sample kernel
     // ----------------------
     std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0); // generates random floats between 0.0 and 1.0
@@ -180,6 +218,18 @@ int main()
         sample *= scale;
         ssaoKernel.push_back(sample);
     }
+    // upload it once into a uniform buffer, as a std140 vec4 array
+    std::vector<glm::vec4> ssaoKernelData;
+    for (const glm::vec3 &sample : ssaoKernel)
+        ssaoKernelData.push_back(glm::vec4(sample, 0.0f));
+    unsigned int ssaoKernelUBO;
+    glGenBuffers(1, &ssaoKernelUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, ssaoKernelUBO);
+    glBufferData(GL_UNIFORM_BUFFER, ssaoKernelData.size() * sizeof(glm::vec4), &ssaoKernelData[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, ssaoKernelUBO);
+    for (Shader *shader : { &shaderSSAO[GBUFFER_STANDARD], &shaderSSAO[GBUFFER_COMPACT], &shaderSSAOLowRes })
+        glUniformBlockBinding(shader->ID, glGetUniformBlockIndex(shader->ID, "SSAOKernel"), 0);
 
     // generate noise texture
     // ----------------------
@@ -204,17 +254,61 @@ int main()
 
     // shader configuration
     // --------------------
-    shaderLightingPass.use();
-    shaderLightingPass.setInt("gPosition", 0);
-    shaderLightingPass.setInt("gNormal", 1);
-    shaderLightingPass.setInt("gAlbedo", 2);
-    shaderLightingPass.setInt("ssao", 3);
-    shaderSSAO.use();
-    shaderSSAO.setInt("gPosition", 0);
-    shaderSSAO.setInt("gNormal", 1);
-    shaderSSAO.setInt("texNoise", 2);
+    shaderLightingPass[GBUFFER_STANDARD].use();
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gPosition", 0);
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gNormal", 1);
+    shaderLightingPass[GBUFFER_STANDARD].setInt("gAlbedo", 2);
+    shaderLightingPass[GBUFFER_STANDARD].setInt("ssao", 3);
+    shaderLightingPass[GBUFFER_COMPACT].use();
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gNormal", 0);
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gAlbedo", 1);
+    shaderLightingPass[GBUFFER_COMPACT].setInt("gDepth", 2);
+    shaderLightingPass[GBUFFER_COMPACT].setInt("ssao", 3);
+    shaderSSAO[GBUFFER_STANDARD].use();
+    shaderSSAO[GBUFFER_STANDARD].setInt("gPosition", 0);
+    shaderSSAO[GBUFFER_STANDARD].setInt("gNormal", 1);
+    shaderSSAO[GBUFFER_STANDARD].setInt("texNoise", 2);
+    shaderSSAO[GBUFFER_COMPACT].use();
+    shaderSSAO[GBUFFER_COMPACT].setInt("gNormal", 0);
+    shaderSSAO[GBUFFER_COMPACT].setInt("gDepth", 1);
+    shaderSSAO[GBUFFER_COMPACT].setInt("texNoise", 2);
     shaderSSAOBlur.use();
     shaderSSAOBlur.setInt("ssaoInput", 0);
+    shaderSSAODownsample.use();
+    shaderSSAODownsample.setInt("gNormal", 0);
+    shaderSSAODownsample.setInt("gDepth", 1);
+    shaderSSAODownsampleLevel.use();
+    shaderSSAODownsampleLevel.setInt("normalDepth", 0);
+    shaderSSAOLowRes.use();
+    shaderSSAOLowRes.setInt("normalDepth", 0);
+    shaderSSAOLowRes.setInt("texNoise", 1);
+    shaderSSAOTemporal.use();
+    shaderSSAOTemporal.setInt("currentAO", 0);
+    shaderSSAOTemporal.setInt("history", 1);
+    shaderSSAOTemporal.setInt("normalDepth", 2);
+    shaderSSAOTemporal.setFloat("historyWeight", 0.9f);
+    shaderSSAOUpsample.use();
+    shaderSSAOUpsample.setInt("aoInput", 0);
+    shaderSSAOUpsample.setInt("gDepth", 1);
+    shaderSSAOHorizon.use();
+    shaderSSAOHorizon.setInt("depthInput", 0);
+    shaderSSAOHorizon.setInt("directionCount", 4);
+    shaderSSAOHorizon.setInt("stepCount", 4);
+
+    // timing of the SSAO passes
+    unsigned int ssaoQuery, referenceQuery;
+    glGenQueries(1, &ssaoQuery);
+    glGenQueries(1, &referenceQuery);
+    unsigned int frameCount = 0;
+    double ssaoTimeSum = 0.0;
+    // previous frame's view matrix and history buffer for the temporal accumulation
+    glm::mat4 prevView = camera.GetViewMatrix();
+    unsigned int historyIndex = 0;
+    bool historyValid = false;
+
+    std::cout << "Press O to switch the SSAO resolution, K to change the samples per pixel of the reduced resolutions, "
+              << "C to compare against the full resolution pass, M to switch between the hemisphere and horizon-based AO, "
+              << "B to benchmark both methods" << std::endl;
 
     // render loop
     // -----------
@@ -230,6 +324,25 @@ int main()
         // -----
         processInput(window);
 
+        if (gBufferLayoutChanged)
+        {
+            gBuffer.Delete();
+            gBuffer = GBuffer(SCR_WIDTH, SCR_HEIGHT, gBufferLayout);
+            gBufferLayoutChanged = false;
+            std::cout << "g-buffer layout: " << (gBufferLayout == GBUFFER_COMPACT ? "compact" : "standard") << " ("
+                      << gBuffer.BytesPerPixel() << " bytes/pixel)" << std::endl;
+        }
+        Shader &geometryShader = shaderGeometryPass[gBuffer.Layout];
+        Shader &ssaoShader = shaderSSAO[gBuffer.Layout];
+        Shader &lightingShader = shaderLightingPass[gBuffer.Layout];
+        if (ssaoResolutionChanged)
+        {
+            // the history of another resolution is stale
+            historyValid = false;
+            ssaoResolutionChanged = false;
+            std::cout << "SSAO resolution: " << (ssaoResolution == SSAO_FULL ? "full" : ssaoResolution == SSAO_HALF ? "half" : "quarter") << std::endl;
+        }
+
         // render
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -237,83 +350,325 @@ int main()
 
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 50.0f);
-            glm::mat4 view = camera.GetViewMatrix();
-            glm::mat4 model = glm::mat4(1.0f);
-            shaderGeometryPass.use();
-            shaderGeometryPass.setMat4("projection", projection);
-            shaderGeometryPass.setMat4("view", view);
-            // room cube
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0, 7.0f, 0.0f));
-            model = glm::scale(model, glm::vec3(7.5f, 7.5f, 7.5f));
-            shaderGeometryPass.setMat4("model", model);
-            shaderGeometryPass.setInt("invertedNormals", 1); // invert normals as we're inside the cube
-            renderCube();
-            shaderGeometryPass.setInt("invertedNormals", 0); 
-            // backpack model on the floor
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(0.0f, 0.5f, 0.0));
-            model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
-            model = glm::scale(model, glm::vec3(1.0f));
-            shaderGeometryPass.setMat4("model", model);
-            backpack.Draw(shaderGeometryPass);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-
-        // 2. generate SSAO texture
-        // ------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-            glClear(GL_COLOR_BUFFER_BIT);
-            shaderSSAO.use();
-            // Send kernel + rotation 
-            for (unsigned int i = 0; i < 64; ++i)
-                shaderSSAO.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-            shaderSSAO.setMat4("projection", projection);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, gPosition);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, gNormal);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, noiseTexture);
-            renderQuad();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 50.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        // the test scene of the benchmark adds a colonnade to the room, for plenty of creases and contact shadows
+        auto renderGeometry = [&](const glm::mat4 &sceneView, bool testScene) {
+            glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.ID);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glm::mat4 model = glm::mat4(1.0f);
+                geometryShader.use();
+                geometryShader.setMat4("projection", projection);
+                geometryShader.setMat4("view", sceneView);
+                // room cube
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, glm::vec3(0.0, 7.0f, 0.0f));
+                model = glm::scale(model, glm::vec3(7.5f, 7.5f, 7.5f));
+                geometryShader.setMat4("model", model);
+                geometryShader.setInt("invertedNormals", 1); // invert normals as we're inside the cube
+                renderCube();
+                geometryShader.setInt("invertedNormals", 0); 
+                // backpack model on the floor
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, glm::vec3(0.0f, 0.5f, 0.0));
+                model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
+                model = glm::scale(model, glm::vec3(1.0f));
+                geometryShader.setMat4("model", model);
+                backpack.Draw(geometryShader);
+                if (testScene)
+                {
+                    // two rows of pillars carrying a beam each
+                    for (int side = -1; side <= 1; side += 2)
+                    {
+                        for (int i = 0; i < 5; ++i)
+                        {
+                            model = glm::mat4(1.0f);
+                            model = glm::translate(model, glm::vec3(side * 3.0f, 2.5f, -5.0f + i * 2.5f));
+                            model = glm::scale(model, glm::vec3(0.3f, 3.0f, 0.3f));
+                            geometryShader.setMat4("model", model);
+                            renderCube();
+                        }
+                        model = glm::mat4(1.0f);
+                        model = glm::translate(model, glm::vec3(side * 3.0f, 5.75f, 0.0f));
+                        model = glm::scale(model, glm::vec3(0.4f, 0.25f, 5.5f));
+                        geometryShader.setMat4("model", model);
+                        renderCube();
+                    }
+                }
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        };
+        renderGeometry(view, false);
 
 
-        // 3. blur SSAO texture to remove noise
-        // ------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-            glClear(GL_COLOR_BUFFER_BIT);
-            shaderSSAOBlur.use();
+        // horizon-based AO of a depth source into an AO texture of the given size
+        auto renderHorizonAO = [&](unsigned int depthInput, bool pyramidInput, unsigned int output, unsigned int width, unsigned int height) {
+            shaderSSAOHorizon.use();
+            shaderSSAOHorizon.setBool("pyramidInput", pyramidInput);
+            shaderSSAOHorizon.setMat4("projection", projection);
+            shaderSSAOHorizon.setMat4("inverseProjection", glm::inverse(projection));
+            shaderSSAOHorizon.setInt("frameIndex", frameCount % 64);
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
-            renderQuad();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glBindTexture(GL_TEXTURE_2D, depthInput);
+            glBindImageTexture(0, output, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16F);
+            glDispatchCompute((width + 15) / 16, (height + 15) / 16, 1);
+            // make sure the AO is written before the blur/temporal pass reads it
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        };
+
+        // 2. full resolution: generate SSAO texture and blur it to remove noise; with the hemisphere kernel's 64
+        //    samples this is the reference
+        // -----------------------------------------------------------------------------------------------------
+        auto renderFullResSSAO = [&](SSAO_Method method) {
+            if (method == SSAO_HORIZON)
+                renderHorizonAO(gBuffer.Depth, false, ssaoColorBuffer, SCR_WIDTH, SCR_HEIGHT);
+            else
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+                    glClear(GL_COLOR_BUFFER_BIT);
+                    ssaoShader.use();
+                    ssaoShader.setMat4("projection", projection);
+                    if (gBuffer.Layout == GBUFFER_COMPACT)
+                    {
+                        ssaoShader.setMat4("inverseProjection", glm::inverse(projection));
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+                        glActiveTexture(GL_TEXTURE1);
+                        glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+                    }
+                    else
+                    {
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(GL_TEXTURE_2D, gBuffer.Position);
+                        glActiveTexture(GL_TEXTURE1);
+                        glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+                    }
+                    glActiveTexture(GL_TEXTURE2);
+                    glBindTexture(GL_TEXTURE_2D, noiseTexture);
+                    renderQuad();
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+                glClear(GL_COLOR_BUFFER_BIT);
+                shaderSSAOBlur.use();
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+                renderQuad();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        };
 
 
+        // 3. reduced resolution: downsample the g-buffer into the depth/normal pyramid, take a few samples per
+        //    pixel, accumulate them with the reprojected AO of the previous frames and upsample the result
+        // ----------------------------------------------------------------------------------------------------
+        auto renderLowResSSAO = [&]() {
+            SSAOLevel &level = ssaoLevels[ssaoResolution == SSAO_QUARTER ? 1 : 0];
+            // depth/normal pyramid
+            glViewport(0, 0, ssaoLevels[0].Width, ssaoLevels[0].Height);
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoLevels[0].NormalDepthFBO);
+                shaderSSAODownsample.use();
+                shaderSSAODownsample.setBool("octahedralNormals", gBuffer.Layout == GBUFFER_COMPACT);
+                shaderSSAODownsample.setMat4("inverseProjection", glm::inverse(projection));
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+                renderQuad();
+            if (ssaoResolution == SSAO_QUARTER)
+            {
+                glViewport(0, 0, ssaoLevels[1].Width, ssaoLevels[1].Height);
+                glBindFramebuffer(GL_FRAMEBUFFER, ssaoLevels[1].NormalDepthFBO);
+                    shaderSSAODownsampleLevel.use();
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, ssaoLevels[0].NormalDepth);
+                    renderQuad();
+            }
+            // this frame's AO, from a rotating subset of the kernel or the horizon-based kernel
+            if (ssaoMethod == SSAO_HORIZON)
+                renderHorizonAO(level.NormalDepth, true, level.AO, level.Width, level.Height);
+            else
+            {
+                glBindFramebuffer(GL_FRAMEBUFFER, level.AOFBO);
+                    shaderSSAOLowRes.use();
+                    shaderSSAOLowRes.setMat4("projection", projection);
+                    shaderSSAOLowRes.setInt("kernelSize", lowResKernelSize);
+                    shaderSSAOLowRes.setInt("frameIndex", frameCount % 64);
+                    shaderSSAOLowRes.setVec2("noiseOffset", glm::vec2(float(frameCount % 4), float((frameCount / 4) % 4)) / 4.0f);
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, level.NormalDepth);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, noiseTexture);
+                    renderQuad();
+            }
+            // temporal accumulation
+            glBindFramebuffer(GL_FRAMEBUFFER, level.HistoryFBO[historyIndex]);
+                shaderSSAOTemporal.use();
+                shaderSSAOTemporal.setMat4("projection", projection);
+                shaderSSAOTemporal.setMat4("viewToPrevView", prevView * glm::inverse(view));
+                shaderSSAOTemporal.setBool("historyValid", historyValid);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, level.AO);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, level.History[1 - historyIndex]);
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, level.NormalDepth);
+                renderQuad();
+            // bilateral upsample to full resolution
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoUpsampleFBO);
+                shaderSSAOUpsample.use();
+                shaderSSAOUpsample.setMat4("inverseProjection", glm::inverse(projection));
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, level.History[historyIndex]);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+                renderQuad();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        };
+
+        // benchmark: both methods at full resolution (including the shared blur) on the test scene from a few views
+        // ------------------------------------------------------------------------------------------------------
+        if (benchmarkSSAO)
+        {
+            benchmarkSSAO = false;
+            const glm::mat4 benchmarkViews[] = {
+                glm::lookAt(glm::vec3(0.0f, 1.5f, 6.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                glm::lookAt(glm::vec3(-5.0f, 4.0f, 6.0f), glm::vec3(1.0f, 0.0f, -2.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                glm::lookAt(glm::vec3(5.5f, 1.0f, -6.0f), glm::vec3(-3.0f, 3.0f, 3.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                glm::lookAt(glm::vec3(0.0f, 6.5f, 0.0f), glm::vec3(2.0f, 0.0f, -4.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+            };
+            const unsigned int REPEATS = 10;
+            std::vector<float> results[2] = { std::vector<float>(SCR_WIDTH * SCR_HEIGHT), std::vector<float>(SCR_WIDTH * SCR_HEIGHT) };
+            double totalTime[2] = { 0.0, 0.0 }, totalDifference = 0.0;
+            for (unsigned int v = 0; v < 4; ++v)
+            {
+                renderGeometry(benchmarkViews[v], true);
+                double time[2];
+                for (unsigned int method = 0; method < 2; ++method)
+                {
+                    glBeginQuery(GL_TIME_ELAPSED, referenceQuery);
+                    for (unsigned int r = 0; r < REPEATS; ++r)
+                        renderFullResSSAO(SSAO_Method(method));
+                    glEndQuery(GL_TIME_ELAPSED);
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(referenceQuery, GL_QUERY_RESULT, &elapsed);
+                    time[method] = elapsed / 1000000.0 / REPEATS;
+                    totalTime[method] += time[method];
+                    glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+                    glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RED, GL_FLOAT, &results[method][0]);
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                }
+                double difference = 0.0;
+                for (size_t i = 0; i < results[0].size(); ++i)
+                    difference += std::abs(results[0][i] - results[1][i]);
+                difference /= results[0].size();
+                totalDifference += difference;
+                std::cout << "view " << v << ": hemisphere (64 samples) " << time[SSAO_HEMISPHERE] << " ms, horizon-based "
+                          << time[SSAO_HORIZON] << " ms, mean abs AO difference " << difference << std::endl;
+            }
+            std::cout << "average: hemisphere (64 samples) " << totalTime[SSAO_HEMISPHERE] / 4.0 << " ms, horizon-based "
+                      << totalTime[SSAO_HORIZON] / 4.0 << " ms, mean abs AO difference " << totalDifference / 4.0 << std::endl;
+            // back to the camera's view
+            renderGeometry(view, false);
+        }
+
+        // the previous frame's timing is read before its query is reused
+        if (frameCount > 0)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(ssaoQuery, GL_QUERY_RESULT, &elapsed);
+            ssaoTimeSum += elapsed / 1000000.0;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, ssaoQuery);
+        if (ssaoResolution == SSAO_FULL)
+            renderFullResSSAO(ssaoMethod);
+        else
+            renderLowResSSAO();
+        glEndQuery(GL_TIME_ELAPSED);
+        unsigned int ssaoResult = ssaoResolution == SSAO_FULL ? ssaoColorBufferBlur : ssaoColorBufferUpsampled;
+        if (ssaoResolution != SSAO_FULL)
+        {
+            historyIndex = 1 - historyIndex;
+            historyValid = true;
+        }
+        prevView = view;
+
+        if (compareSSAO)
+        {
+            compareSSAO = false;
+            if (ssaoResolution == SSAO_FULL)
+                std::cout << "Switch to a reduced SSAO resolution (O) to compare it against the full resolution pass" << std::endl;
+            else
+            {
+                glBeginQuery(GL_TIME_ELAPSED, referenceQuery);
+                renderFullResSSAO(SSAO_HEMISPHERE);
+                glEndQuery(GL_TIME_ELAPSED);
+                GLuint64 lowResTime = 0, referenceTime = 0;
+                glGetQueryObjectui64v(ssaoQuery, GL_QUERY_RESULT, &lowResTime);
+                glGetQueryObjectui64v(referenceQuery, GL_QUERY_RESULT, &referenceTime);
+                // read both results back and compare them per pixel
+                std::vector<float> lowRes(SCR_WIDTH * SCR_HEIGHT), reference(SCR_WIDTH * SCR_HEIGHT);
+                glBindFramebuffer(GL_FRAMEBUFFER, ssaoUpsampleFBO);
+                glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RED, GL_FLOAT, &lowRes[0]);
+                glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+                glReadPixels(0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RED, GL_FLOAT, &reference[0]);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                double errorSum = 0.0, squaredErrorSum = 0.0, maxError = 0.0;
+                for (size_t i = 0; i < lowRes.size(); ++i)
+                {
+                    const double error = std::abs(lowRes[i] - reference[i]);
+                    errorSum += error;
+                    squaredErrorSum += error * error;
+                    maxError = std::max(maxError, error);
+                }
+                const double mse = squaredErrorSum / lowRes.size();
+                std::cout << (ssaoResolution == SSAO_HALF ? "half" : "quarter") << " resolution, "
+                          << (ssaoMethod == SSAO_HORIZON ? "horizon-based" : std::to_string(lowResKernelSize) + " samples/pixel") << ": "
+                          << lowResTime / 1000000.0 << " ms, full resolution, 64 samples/pixel: " << referenceTime / 1000000.0 << " ms; "
+                          << "mean abs error " << errorSum / lowRes.size() << ", max " << maxError << ", PSNR "
+                          << (mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : 99.0) << " dB" << std::endl;
+            }
+        }
+        if (++frameCount % 120 == 0)
+        {
+            std::cout << "SSAO (" << (ssaoResolution == SSAO_FULL ? "full" : ssaoResolution == SSAO_HALF ? "half" : "quarter") << " resolution, "
+                      << (ssaoMethod == SSAO_HORIZON ? "horizon-based" : std::to_string(ssaoResolution == SSAO_FULL ? 64 : lowResKernelSize) + " samples/pixel")
+                      << "): " << ssaoTimeSum / 120.0 << " ms" << std::endl;
+            ssaoTimeSum = 0.0;
+        }
+
         // 4. lighting pass: traditional deferred Blinn-Phong lighting with added screen-space ambient occlusion
         // -----------------------------------------------------------------------------------------------------
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderLightingPass.use();
+        lightingShader.use();
         // send light relevant uniforms
         glm::vec3 lightPosView = glm::vec3(camera.GetViewMatrix() * glm::vec4(lightPos, 1.0));
-        shaderLightingPass.setVec3("light.Position", lightPosView);
-        shaderLightingPass.setVec3("light.Color", lightColor);
+        lightingShader.setVec3("light.Position", lightPosView);
+        lightingShader.setVec3("light.Color", lightColor);
         // Update attenuation parameters
         const float linear    = 0.09f;
         const float quadratic = 0.032f;
-        shaderLightingPass.setFloat("light.Linear", linear);
-        shaderLightingPass.setFloat("light.Quadratic", quadratic);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedo);
+        lightingShader.setFloat("light.Linear", linear);
+        lightingShader.setFloat("light.Quadratic", quadratic);
+        if (gBuffer.Layout == GBUFFER_COMPACT)
+        {
+            lightingShader.setMat4("inverseProjection", glm::inverse(projection));
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.AlbedoSpec);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+        }
+        else
+        {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.Position);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, gBuffer.AlbedoSpec);
+        }
         glActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
-        glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
+        glBindTexture(GL_TEXTURE_2D, ssaoResult);
         renderQuad();
 
 
@@ -323,6 +678,11 @@ int main()
         glfwPollEvents();
     }
 
+    gBuffer.Delete();
+    glDeleteQueries(1, &ssaoQuery);
+    glDeleteQueries(1, &referenceQuery);
+    glDeleteBuffers(1, &ssaoKernelUBO);
+
     glfwTerminate();
     return 0;
 }
@@ -434,6 +794,27 @@ void renderQuad()
     glBindVertexArray(0);
 }
 
+// creates a single texture render target for the SSAO passes; returns its framebuffer
+// ------------------------------------------------------------------------------------
+unsigned int createSSAOTarget(unsigned int width, unsigned int height, GLenum internalFormat, GLenum format, unsigned int &texture)
+{
+    unsigned int fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "SSAO Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return fbo;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
@@ -449,6 +830,71 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !layoutKeyPressed)
+    {
+        gBufferLayout = gBufferLayout == GBUFFER_STANDARD ? GBUFFER_COMPACT : GBUFFER_STANDARD;
+        gBufferLayoutChanged = true;
+        layoutKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+    {
+        layoutKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !resolutionKeyPressed)
+    {
+        ssaoResolution = SSAO_Resolution((ssaoResolution + 1) % 3);
+        ssaoResolutionChanged = true;
+        resolutionKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE)
+    {
+        resolutionKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS && !kernelKeyPressed)
+    {
+        lowResKernelSize = lowResKernelSize >= 16 ? 8 : lowResKernelSize + 4;
+        std::cout << "reduced resolution SSAO: " << lowResKernelSize << " samples/pixel" << std::endl;
+        kernelKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_RELEASE)
+    {
+        kernelKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !methodKeyPressed)
+    {
+        ssaoMethod = ssaoMethod == SSAO_HEMISPHERE ? SSAO_HORIZON : SSAO_HEMISPHERE;
+        ssaoResolutionChanged = true; // the accumulated AO of the other method is stale
+        std::cout << "SSAO method: " << (ssaoMethod == SSAO_HORIZON ? "horizon-based" : "hemisphere kernel") << std::endl;
+        methodKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE)
+    {
+        methodKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkSSAO = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !compareKeyPressed)
+    {
+        compareSSAO = true;
+        compareKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE)
+    {
+        compareKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
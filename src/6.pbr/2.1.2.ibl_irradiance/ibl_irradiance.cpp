@@ -10,6 +10,8 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/ibl_baker.h>
+#include <learnopengl/sh_irradiance.h>
 
 #include <iostream>
 
@@ -34,6 +36,10 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// diffuse IBL: spherical harmonics (default) or the convoluted irradiance cubemap
+bool useSH = true;
+bool useSHKeyPressed = false;
+
 int main()
 {
     // glfw: initialize and configure
@@ -81,6 +87,7 @@ int main()
     // build and compile shaders
     // -------------------------
     Shader pbrShader("2.1.2.pbr.vs", "2.1.2.pbr.fs");
+    Shader pbrSHShader("2.1.2.pbr.vs", "2.1.2.pbr_sh.fs");
     Shader equirectangularToCubemapShader("2.1.2.cubemap.vs", "2.1.2.equirectangular_to_cubemap.fs");
     Shader irradianceShader("2.1.2.cubemap.vs", "2.1.2.irradiance_convolution.fs");
     Shader backgroundShader("2.1.2.background.vs", "2.1.2.background.fs");
@@ -90,6 +97,10 @@ int main()
     pbrShader.setInt("irradianceMap", 0);
     pbrShader.setVec3("albedo", 0.5f, 0.0f, 0.0f);
     pbrShader.setFloat("ao", 1.0f);
+    pbrSHShader.use();
+    pbrSHShader.setVec3("albedo", 0.5f, 0.0f, 0.0f);
+    pbrSHShader.setFloat("ao", 1.0f);
+    glUniformBlockBinding(pbrSHShader.ID, glGetUniformBlockIndex(pbrSHShader.ID, "SHIrradiance"), 0);
 
     backgroundShader.use();
     backgroundShader.setInt("environmentMap", 0);
@@ -131,8 +142,14 @@ int main()
     int width, height, nrComponents;
     float *data = stbi_loadf(FileSystem::getPath("resources/textures/hdr/newport_loft.hdr").c_str(), &width, &height, &nrComponents, 0);
     unsigned int hdrTexture;
+    SHIrradiance sh;
     if (data)
     {
+        // pbr: project the environment onto spherical harmonics for the diffuse irradiance
+        double shStart = glfwGetTime();
+        sh = SHIrradiance::FromEquirectangular(data, width, height, nrComponents);
+        std::cout << "SH projection: " << (glfwGetTime() - shStart) * 1000.0 << " ms" << std::endl;
+
         glGenTextures(1, &hdrTexture);
         glBindTexture(GL_TEXTURE_2D, hdrTexture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data); // note how we specify the texture's data value to be float
@@ -197,50 +214,93 @@ int main()
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    // pbr: create an irradiance cubemap, and re-scale capture FBO to irradiance scale.
-    // --------------------------------------------------------------------------------
-    unsigned int irradianceMap;
-    glGenTextures(1, &irradianceMap);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-    for (unsigned int i = 0; i < 6; ++i)
+    // pbr: upload the SH coefficients to a uniform buffer (binding point 0)
+    // ---------------------------------------------------------------------
+    unsigned int shUBO;
+    glGenBuffers(1, &shUBO);
+    sh.Upload(shUBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, shUBO);
+
+    // the irradiance cubemap is no longer needed for rendering; it's only convoluted (once) when switching to it
+    // for comparison, after which its difference with the SH irradiance is printed
+    unsigned int irradianceMap = 0;
+    auto bakeIrradianceMap = [&]()
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
-    }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
+        // pbr: create an irradiance cubemap, and re-scale capture FBO to irradiance scale.
+        // --------------------------------------------------------------------------------
+        glGenTextures(1, &irradianceMap);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
+
+        // pbr: solve diffuse integral by convolution to create an irradiance (cube)map.
+        // -----------------------------------------------------------------------------
+        double convolutionStart = glfwGetTime();
+        irradianceShader.use();
+        irradianceShader.setInt("environmentMap", 0);
+        irradianceShader.setMat4("projection", captureProjection);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    // pbr: solve diffuse integral by convolution to create an irradiance (cube)map.
-    // -----------------------------------------------------------------------------
-    irradianceShader.use();
-    irradianceShader.setInt("environmentMap", 0);
-    irradianceShader.setMat4("projection", captureProjection);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+        glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+        glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            irradianceShader.setMat4("view", captureViews[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceMap, 0);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
-    glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    for (unsigned int i = 0; i < 6; ++i)
-    {
-        irradianceShader.setMat4("view", captureViews[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradianceMap, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            renderCube();
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glFinish();
+        std::cout << "irradiance convolution: " << (glfwGetTime() - convolutionStart) * 1000.0 << " ms" << std::endl;
 
-        renderCube();
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // image difference: read the cubemap back and compare every texel with the SH irradiance in its direction
+        std::vector<float> texels(32 * 32 * 3);
+        double sumError = 0.0, maxError = 0.0, sumIrradiance = 0.0;
+        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, GL_FLOAT, &texels[0]);
+            for (unsigned int y = 0; y < 32; ++y)
+            {
+                for (unsigned int x = 0; x < 32; ++x)
+                {
+                    glm::vec3 N = IBLBaker::FaceToDirection(i, glm::vec2((x + 0.5f) / 32.0f, (y + 0.5f) / 32.0f));
+                    glm::vec3 reference = glm::make_vec3(&texels[(y * 32 + x) * 3]);
+                    glm::vec3 error = glm::abs(sh.Evaluate(N) - reference);
+                    sumError += error.r + error.g + error.b;
+                    maxError = std::max(maxError, (double)std::max(error.r, std::max(error.g, error.b)));
+                    sumIrradiance += reference.r + reference.g + reference.b;
+                }
+            }
+        }
+        std::cout << "SH vs irradiance cubemap: mean absolute error " << sumError / (6 * 32 * 32 * 3) << ", max absolute error " << maxError
+                  << ", mean relative error " << 100.0 * sumError / sumIrradiance << "%" << std::endl;
+        int scrWidth, scrHeight;
+        glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
+        glViewport(0, 0, scrWidth, scrHeight);
+    };
 
     // initialize static shader uniforms before rendering
     // --------------------------------------------------
     glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
     pbrShader.use();
     pbrShader.setMat4("projection", projection);
+    pbrSHShader.use();
+    pbrSHShader.setMat4("projection", projection);
     backgroundShader.use();
     backgroundShader.setMat4("projection", projection);
 
@@ -268,14 +328,17 @@ int main()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // render scene, supplying the convoluted irradiance map to the final shader.
+        // render scene, supplying the SH irradiance (or the convoluted irradiance map) to the final shader.
         // ------------------------------------------------------------------------------------------
-        pbrShader.use();
+        if (!useSH && irradianceMap == 0)
+            bakeIrradianceMap();
+        Shader &pbr = useSH ? pbrSHShader : pbrShader;
+        pbr.use();
         glm::mat4 view = camera.GetViewMatrix();
-        pbrShader.setMat4("view", view);
-        pbrShader.setVec3("camPos", camera.Position);
+        pbr.setMat4("view", view);
+        pbr.setVec3("camPos", camera.Position);
 
-        // bind pre-computed IBL data
+        // bind pre-computed IBL data (the SH coefficients are in the uniform buffer)
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
 
@@ -283,12 +346,12 @@ int main()
         glm::mat4 model = glm::mat4(1.0f);
         for (int row = 0; row < nrRows; ++row)
         {
-            pbrShader.setFloat("metallic", (float)row / (float)nrRows);
+            pbr.setFloat("metallic", (float)row / (float)nrRows);
             for (int col = 0; col < nrColumns; ++col)
             {
                 // we clamp the roughness to 0.025 - 1.0 as perfectly smooth surfaces (roughness of 0.0) tend to look a bit off
                 // on direct lighting.
-                pbrShader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
+                pbr.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
 
                 model = glm::mat4(1.0f);
                 model = glm::translate(model, glm::vec3(
@@ -296,8 +359,8 @@ int main()
                     (float)(row - (nrRows / 2)) * spacing,
                     -2.0f
                 ));
-                pbrShader.setMat4("model", model);
-                pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                pbr.setMat4("model", model);
+                pbr.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
                 renderSphere();
             }
         }
@@ -310,14 +373,14 @@ int main()
         {
             glm::vec3 newPos = lightPositions[i] + glm::vec3(sin(glfwGetTime() * 5.0) * 5.0, 0.0, 0.0);
             newPos = lightPositions[i];
-            pbrShader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
-            pbrShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
+            pbr.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
+            pbr.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
 
             model = glm::mat4(1.0f);
             model = glm::translate(model, newPos);
             model = glm::scale(model, glm::vec3(0.5f));
-            pbrShader.setMat4("model", model);
-            pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+            pbr.setMat4("model", model);
+            pbr.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
             renderSphere();
         }
 
@@ -357,6 +420,14 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !useSHKeyPressed)
+    {
+        useSH = !useSH;
+        useSHKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE)
+        useSHKeyPressed = false;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
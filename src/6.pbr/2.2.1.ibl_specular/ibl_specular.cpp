@@ -8,8 +8,10 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/ibl_cache.h>
 
 #include <iostream>
 
@@ -17,6 +19,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+IBLMaps bakeIBL(const std::string &hdrPath, const IBLSettings &settings);
 void renderSphere();
 void renderCube();
 void renderQuad();
@@ -35,12 +38,16 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// refilter the pre-filter map with the compute shader every frame (as a dynamic environment probe would)
+bool dynamicProbe = false;
+bool dynamicProbeKeyPressed = false;
+
 int main()
 {
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4); // the compute shader pre-filter requires OpenGL 4.3
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_SAMPLES, 4);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -85,10 +92,6 @@ int main()
     // build and compile shaders
     // -------------------------
     Shader pbrShader("2.2.1.pbr.vs", "2.2.1.pbr.fs");
-    Shader equirectangularToCubemapShader("2.2.1.cubemap.vs", "2.2.1.equirectangular_to_cubemap.fs");
-    Shader irradianceShader("2.2.1.cubemap.vs", "2.2.1.irradiance_convolution.fs");
-    Shader prefilterShader("2.2.1.cubemap.vs", "2.2.1.prefilter.fs");
-    Shader brdfShader("2.2.1.brdf.vs", "2.2.1.brdf.fs");
     Shader backgroundShader("2.2.1.background.vs", "2.2.1.background.fs");
 
     pbrShader.use();
@@ -120,6 +123,269 @@ int main()
     int nrColumns = 7;
     float spacing = 2.5;
 
+    // pbr: load the precomputed IBL maps from the cache; if there's no valid cache (yet) bake them on the GPU and
+    // write them to the cache, so the convolutions only run once per environment map and bake settings.
+    // ------------------------------------------------------------------------------------------------------------
+    IBLSettings iblSettings;
+    std::string hdrPath = FileSystem::getPath("resources/textures/hdr/newport_loft.hdr");
+    std::string iblCachePath = hdrPath + ".ibl";
+    uint64_t hdrHash = FileHash::Hash(hdrPath);
+    IBLData iblData;
+    IBLMaps ibl;
+    if (IBLCache::Load(iblCachePath, hdrHash, iblSettings, iblData))
+    {
+        ibl = IBLCache::Upload(iblData);
+    }
+    else
+    {
+        std::cout << "No IBL cache found, baking " << hdrPath << std::endl;
+        ibl = bakeIBL(hdrPath, iblSettings);
+        IBLCache::Save(iblCachePath, hdrHash, iblSettings, IBLCache::Readback(ibl, iblSettings));
+    }
+    unsigned int envCubemap = ibl.EnvCubemap;
+    unsigned int irradianceMap = ibl.IrradianceMap;
+    unsigned int prefilterMap = ibl.PrefilterMap;
+    unsigned int brdfLUTTexture = ibl.BrdfLUT;
+
+    // pbr: filtered importance sampling of the pre-filter map in a compute shader. The sample count grows with the
+    // roughness and a single dispatch writes all mips and faces, which makes it cheap enough to refilter dynamic
+    // environment probes every frame.
+    // -------------------------------------------------------------------------------------------------------------
+    ComputeShader prefilterComputeShader("2.2.1.prefilter.cs");
+    prefilterComputeShader.use();
+    prefilterComputeShader.setInt("environmentMap", 0);
+    prefilterComputeShader.setFloat("environmentResolution", (float)iblSettings.EnvironmentSize);
+    prefilterComputeShader.setInt("prefilterSize", iblSettings.PrefilterSize);
+    prefilterComputeShader.setInt("mipLevels", iblSettings.PrefilterMipLevels);
+    prefilterComputeShader.setInt("baseSampleCount", 16);
+    prefilterComputeShader.setInt("maxSampleCount", iblSettings.SampleCount);
+
+    unsigned int prefilterMapCompute;
+    glGenTextures(1, &prefilterMapCompute);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMapCompute);
+    glTexStorage2D(GL_TEXTURE_CUBE_MAP, iblSettings.PrefilterMipLevels, GL_RGBA16F, iblSettings.PrefilterSize, iblSettings.PrefilterSize);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // the work groups (8x8 texels) of all mips and faces, laid out mip after mip
+    unsigned int prefilterGroups = 0;
+    for (unsigned int mip = 0; mip < iblSettings.PrefilterMipLevels; ++mip)
+    {
+        unsigned int tiles = (std::max(iblSettings.PrefilterSize >> mip, 1u) + 7) / 8;
+        prefilterGroups += 6 * tiles * tiles;
+    }
+    auto prefilterCompute = [&]()
+    {
+        prefilterComputeShader.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+        for (unsigned int mip = 0; mip < iblSettings.PrefilterMipLevels; ++mip)
+            glBindImageTexture(mip, prefilterMapCompute, mip, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute(prefilterGroups, 1, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    };
+
+    // filter once and report its cost and quality (PSNR of the tonemapped colors) against the fragment shader's
+    // pre-filter map, which uses a fixed number of samples per texel for every mip. This reads every mip and face
+    // of both maps back, so it only runs the first time the dynamic probe is switched on (P) and startup stays on
+    // the cached maps.
+    unsigned int prefilterQuery;
+    glGenQueries(1, &prefilterQuery);
+    GLuint64 prefilterTime;
+    auto comparePrefilter = [&]()
+    {
+        glBeginQuery(GL_TIME_ELAPSED, prefilterQuery);
+        prefilterCompute();
+        glEndQuery(GL_TIME_ELAPSED);
+        glGetQueryObjectui64v(prefilterQuery, GL_QUERY_RESULT, &prefilterTime);
+        std::cout << "compute pre-filter (all mips and faces): " << prefilterTime / 1000000.0 << " ms" << std::endl;
+        for (unsigned int mip = 0; mip < iblSettings.PrefilterMipLevels; ++mip)
+        {
+            unsigned int mipSize = std::max(iblSettings.PrefilterSize >> mip, 1u);
+            std::vector<float> reference(mipSize * mipSize * 3), filtered(mipSize * mipSize * 3);
+            double squaredError = 0.0;
+            for (unsigned int i = 0; i < 6; ++i)
+            {
+                glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
+                glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GL_RGB, GL_FLOAT, &reference[0]);
+                glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMapCompute);
+                glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, mip, GL_RGB, GL_FLOAT, &filtered[0]);
+                for (size_t j = 0; j < reference.size(); ++j)
+                {
+                    double difference = reference[j] / (1.0 + reference[j]) - filtered[j] / (1.0 + filtered[j]);
+                    squaredError += difference * difference;
+                }
+            }
+            double mse = squaredError / (6.0 * reference.size());
+            unsigned int samples = mip == 0 ? 1 : std::min(16u << mip, iblSettings.SampleCount);
+            std::cout << "  mip " << mip << ": " << samples << " vs " << iblSettings.SampleCount << " samples per texel, PSNR "
+                      << (mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : INFINITY) << " dB" << std::endl;
+        }
+    };
+
+    // initialize static shader uniforms before rendering
+    // --------------------------------------------------
+    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+    pbrShader.use();
+    pbrShader.setMat4("projection", projection);
+    backgroundShader.use();
+    backgroundShader.setMat4("projection", projection);
+
+    // then before rendering, configure the viewport to the original framebuffer's screen dimensions
+    int scrWidth, scrHeight;
+    glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
+    glViewport(0, 0, scrWidth, scrHeight);
+
+    // render loop
+    // -----------
+    unsigned int dynamicProbeFrame = 0;
+    bool prefilterCompared = false, prefilterTimed = false;
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // refilter the dynamic probe; its GPU time is printed every 120 frames, once the query's result is
+        // available so the CPU doesn't wait for the GPU
+        // ----------------------------------------------------------------------------------------------------
+        if (prefilterTimed)
+        {
+            GLuint available = 0;
+            glGetQueryObjectuiv(prefilterQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                glGetQueryObjectui64v(prefilterQuery, GL_QUERY_RESULT, &prefilterTime);
+                std::cout << "dynamic probe pre-filter: " << prefilterTime / 1000000.0 << " ms" << std::endl;
+                prefilterTimed = false;
+            }
+        }
+        if (dynamicProbe && !prefilterCompared)
+        {
+            comparePrefilter();
+            prefilterCompared = true;
+        }
+        else if (dynamicProbe)
+        {
+            bool timed = ++dynamicProbeFrame % 120 == 0 && !prefilterTimed;
+            if (timed)
+                glBeginQuery(GL_TIME_ELAPSED, prefilterQuery);
+            prefilterCompute();
+            if (timed)
+            {
+                glEndQuery(GL_TIME_ELAPSED);
+                prefilterTimed = true;
+            }
+        }
+
+        // render
+        // ------
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // render scene, supplying the convoluted irradiance map to the final shader.
+        // ------------------------------------------------------------------------------------------
+        pbrShader.use();
+        glm::mat4 view = camera.GetViewMatrix();
+        pbrShader.setMat4("view", view);
+        pbrShader.setVec3("camPos", camera.Position);
+
+        // bind pre-computed IBL data
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, dynamicProbe ? prefilterMapCompute : prefilterMap);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
+
+        // render rows*column number of spheres with varying metallic/roughness values scaled by rows and columns respectively
+        glm::mat4 model = glm::mat4(1.0f);
+        for (int row = 0; row < nrRows; ++row)
+        {
+            pbrShader.setFloat("metallic", (float)row / (float)nrRows);
+            for (int col = 0; col < nrColumns; ++col)
+            {
+                // we clamp the roughness to 0.025 - 1.0 as perfectly smooth surfaces (roughness of 0.0) tend to look a bit off
+                // on direct lighting.
+                pbrShader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
+
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, glm::vec3(
+                    (float)(col - (nrColumns / 2)) * spacing,
+                    (float)(row - (nrRows / 2)) * spacing,
+                    -2.0f
+                ));
+                pbrShader.setMat4("model", model);
+                pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                renderSphere();
+            }
+        }
+
+
+        // render light source (simply re-render sphere at light positions)
+        // this looks a bit off as we use the same shader, but it'll make their positions obvious and 
+        // keeps the codeprint small.
+        for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+        {
+            glm::vec3 newPos = lightPositions[i] + glm::vec3(sin(glfwGetTime() * 5.0) * 5.0, 0.0, 0.0);
+            newPos = lightPositions[i];
+            pbrShader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
+            pbrShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
+
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, newPos);
+            model = glm::scale(model, glm::vec3(0.5f));
+            pbrShader.setMat4("model", model);
+            pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+            renderSphere();
+        }
+
+        // render skybox (render as last to prevent overdraw)
+        backgroundShader.use();
+        backgroundShader.setMat4("view", view);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
+        //glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
+        //glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap); // display prefilter map
+        renderCube();
+
+
+        // render BRDF map to screen
+        //glBindTexture(GL_TEXTURE_2D, brdfLUTTexture); // display BRDF map (with a textured quad shader)
+        //renderQuad();
+
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// bakes the IBL maps of an HDR environment map on the GPU through render-to-cubemap passes
+// (the sample count and source resolution of the prefilter and brdf shaders match the default settings)
+// ---------------------------------------------------------------------------------------------------
+IBLMaps bakeIBL(const std::string &hdrPath, const IBLSettings &settings)
+{
+    Shader equirectangularToCubemapShader("2.2.1.cubemap.vs", "2.2.1.equirectangular_to_cubemap.fs");
+    Shader irradianceShader("2.2.1.cubemap.vs", "2.2.1.irradiance_convolution.fs");
+    Shader prefilterShader("2.2.1.cubemap.vs", "2.2.1.prefilter.fs");
+    Shader brdfShader("2.2.1.brdf.vs", "2.2.1.brdf.fs");
+
     // pbr: setup framebuffer
     // ----------------------
     unsigned int captureFBO;
@@ -129,15 +395,15 @@ int main()
 
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, settings.EnvironmentSize, settings.EnvironmentSize);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, captureRBO);
 
     // pbr: load the HDR environment map
     // ---------------------------------
     stbi_set_flip_vertically_on_load(true);
     int width, height, nrComponents;
-    float *data = stbi_loadf(FileSystem::getPath("resources/textures/hdr/newport_loft.hdr").c_str(), &width, &height, &nrComponents, 0);
-    unsigned int hdrTexture;
+    float *data = stbi_loadf(hdrPath.c_str(), &width, &height, &nrComponents, 0);
+    unsigned int hdrTexture = 0;
     if (data)
     {
         glGenTextures(1, &hdrTexture);
@@ -163,7 +429,7 @@ int main()
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
     for (unsigned int i = 0; i < 6; ++i)
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 512, 512, 0, GL_RGB, GL_FLOAT, nullptr);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, settings.EnvironmentSize, settings.EnvironmentSize, 0, GL_RGB, GL_FLOAT, nullptr);
     }
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -192,7 +458,7 @@ int main()
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, hdrTexture);
 
-    glViewport(0, 0, 512, 512); // don't forget to configure the viewport to the capture dimensions.
+    glViewport(0, 0, settings.EnvironmentSize, settings.EnvironmentSize); // don't forget to configure the viewport to the capture dimensions.
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
@@ -215,7 +481,7 @@ int main()
     glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, settings.IrradianceSize, settings.IrradianceSize, 0, GL_RGB, GL_FLOAT, nullptr);
     }
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -225,7 +491,7 @@ int main()
 
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, settings.IrradianceSize, settings.IrradianceSize);
 
     // pbr: solve diffuse integral by convolution to create an irradiance (cube)map.
     // -----------------------------------------------------------------------------
@@ -235,7 +501,7 @@ int main()
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
-    glViewport(0, 0, 32, 32); // don't forget to configure the viewport to the capture dimensions.
+    glViewport(0, 0, settings.IrradianceSize, settings.IrradianceSize); // don't forget to configure the viewport to the capture dimensions.
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     for (unsigned int i = 0; i < 6; ++i)
     {
@@ -254,7 +520,7 @@ int main()
     glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
     for (unsigned int i = 0; i < 6; ++i)
     {
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 128, 128, 0, GL_RGB, GL_FLOAT, nullptr);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, settings.PrefilterSize, settings.PrefilterSize, 0, GL_RGB, GL_FLOAT, nullptr);
     }
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -273,12 +539,12 @@ int main()
     glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
 
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
-    unsigned int maxMipLevels = 5;
+    unsigned int maxMipLevels = settings.PrefilterMipLevels;
     for (unsigned int mip = 0; mip < maxMipLevels; ++mip)
     {
         // reisze framebuffer according to mip-level size.
-        unsigned int mipWidth  = static_cast<unsigned int>(128 * std::pow(0.5, mip));
-        unsigned int mipHeight = static_cast<unsigned int>(128 * std::pow(0.5, mip));
+        unsigned int mipWidth  = static_cast<unsigned int>(settings.PrefilterSize * std::pow(0.5, mip));
+        unsigned int mipHeight = static_cast<unsigned int>(settings.PrefilterSize * std::pow(0.5, mip));
         glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
         glViewport(0, 0, mipWidth, mipHeight);
@@ -303,7 +569,7 @@ int main()
 
     // pre-allocate enough memory for the LUT texture.
     glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, 512, 512, 0, GL_RG, GL_FLOAT, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, settings.BrdfLUTSize, settings.BrdfLUTSize, 0, GL_RG, GL_FLOAT, 0);
     // be sure to set wrapping mode to GL_CLAMP_TO_EDGE
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -313,131 +579,26 @@ int main()
     // then re-configure capture framebuffer object and render screen-space quad with BRDF shader.
     glBindFramebuffer(GL_FRAMEBUFFER, captureFBO);
     glBindRenderbuffer(GL_RENDERBUFFER, captureRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, settings.BrdfLUTSize, settings.BrdfLUTSize);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUTTexture, 0);
 
-    glViewport(0, 0, 512, 512);
+    glViewport(0, 0, settings.BrdfLUTSize, settings.BrdfLUTSize);
     brdfShader.use();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     renderQuad();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    glDeleteFramebuffers(1, &captureFBO);
+    glDeleteRenderbuffers(1, &captureRBO);
+    glDeleteTextures(1, &hdrTexture);
 
-    // initialize static shader uniforms before rendering
-    // --------------------------------------------------
-    glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-    pbrShader.use();
-    pbrShader.setMat4("projection", projection);
-    backgroundShader.use();
-    backgroundShader.setMat4("projection", projection);
-
-    // then before rendering, configure the viewport to the original framebuffer's screen dimensions
-    int scrWidth, scrHeight;
-    glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
-    glViewport(0, 0, scrWidth, scrHeight);
-
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
-    {
-        // per-frame time logic
-        // --------------------
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // render scene, supplying the convoluted irradiance map to the final shader.
-        // ------------------------------------------------------------------------------------------
-        pbrShader.use();
-        glm::mat4 view = camera.GetViewMatrix();
-        pbrShader.setMat4("view", view);
-        pbrShader.setVec3("camPos", camera.Position);
-
-        // bind pre-computed IBL data
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, brdfLUTTexture);
-
-        // render rows*column number of spheres with varying metallic/roughness values scaled by rows and columns respectively
-        glm::mat4 model = glm::mat4(1.0f);
-        for (int row = 0; row < nrRows; ++row)
-        {
-            pbrShader.setFloat("metallic", (float)row / (float)nrRows);
-            for (int col = 0; col < nrColumns; ++col)
-            {
-                // we clamp the roughness to 0.025 - 1.0 as perfectly smooth surfaces (roughness of 0.0) tend to look a bit off
-                // on direct lighting.
-                pbrShader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
-
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3(
-                    (float)(col - (nrColumns / 2)) * spacing,
-                    (float)(row - (nrRows / 2)) * spacing,
-                    -2.0f
-                ));
-                pbrShader.setMat4("model", model);
-                pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-                renderSphere();
-            }
-        }
-
-
-        // render light source (simply re-render sphere at light positions)
-        // this looks a bit off as we use the same shader, but it'll make their positions obvious and 
-        // keeps the codeprint small.
-        for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
-        {
-            glm::vec3 newPos = lightPositions[i] + glm::vec3(sin(glfwGetTime() * 5.0) * 5.0, 0.0, 0.0);
-            newPos = lightPositions[i];
-            pbrShader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
-            pbrShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, newPos);
-            model = glm::scale(model, glm::vec3(0.5f));
-            pbrShader.setMat4("model", model);
-            pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-            renderSphere();
-        }
-
-        // render skybox (render as last to prevent overdraw)
-        backgroundShader.use();
-        backgroundShader.setMat4("view", view);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
-        //glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
-        //glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterMap); // display prefilter map
-        renderCube();
-
-
-        // render BRDF map to screen
-        //brdfShader.Use();
-        //renderQuad();
-
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    IBLMaps maps;
+    maps.EnvCubemap = envCubemap;
+    maps.IrradianceMap = irradianceMap;
+    maps.PrefilterMap = prefilterMap;
+    maps.BrdfLUT = brdfLUTTexture;
+    return maps;
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
@@ -455,6 +616,14 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !dynamicProbeKeyPressed)
+    {
+        dynamicProbe = !dynamicProbe;
+        dynamicProbeKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE)
+        dynamicProbeKeyPressed = false;
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,48 @@
+#include <stb_image.h>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/ibl_baker.h>
+#include <learnopengl/ibl_cache.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Offline baker for the image based lighting data of the PBR samples. Converts an HDR environment into the
+// environment, irradiance and pre-filter cubemaps and the BRDF LUT on the CPU (no OpenGL context required)
+// and writes them to the cache the ibl_specular samples load at startup.
+//
+// usage: ibl_bake [hdr file] [cache file]
+// by default bakes resources/textures/hdr/newport_loft.hdr into newport_loft.hdr.ibl next to it
+int main(int argc, char *argv[])
+{
+    std::string hdrPath = argc > 1 ? argv[1] : FileSystem::getPath("resources/textures/hdr/newport_loft.hdr");
+    std::string cachePath = argc > 2 ? argv[2] : hdrPath + ".ibl";
+    IBLSettings settings;
+
+    // load the HDR environment map
+    // ----------------------------
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, nrComponents;
+    float *data = stbi_loadf(hdrPath.c_str(), &width, &height, &nrComponents, 3);
+    if (!data)
+    {
+        std::cout << "Failed to load HDR image: " << hdrPath << std::endl;
+        return -1;
+    }
+    uint64_t hash = FileHash::Hash(hdrPath);
+
+    // bake on all cores and write the cache
+    // -------------------------------------
+    std::cout << "baking " << hdrPath << " on " << std::thread::hardware_concurrency() << " threads..." << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+    IBLData ibl = IBLBaker::Bake(data, width, height, 3, settings);
+    auto end = std::chrono::high_resolution_clock::now();
+    stbi_image_free(data);
+    std::cout << "baked in " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+
+    if (!IBLCache::Save(cachePath, hash, settings, ibl))
+        return -1;
+    std::cout << "written to " << cachePath << std::endl;
+    return 0;
+}
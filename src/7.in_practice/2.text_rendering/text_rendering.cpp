@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -14,25 +17,69 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/sdf_font.h>
+
+struct GlyphSet;
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
-void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color);
+void RenderText(Shader &shader, GlyphSet &glyphs, std::string text, float x, float y, float scale, glm::vec3 color);
+void RenderTextPerGlyph(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color);
+void benchmarkText(Shader &shader);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
+const unsigned int ATLAS_SIZE = 1024;
 
 /// Holds all state information relevant to a character as loaded using FreeType
 struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
+    glm::vec2    UVMin;     // Top-left texture coordinate of the glyph inside the atlas
+    glm::vec2    UVMax;     // Bottom-right texture coordinate of the glyph inside the atlas
     glm::ivec2   Size;      // Size of glyph
     glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
     unsigned int Advance;   // Horizontal offset to advance to next glyph
 };
+Character loadCharacter(unsigned int codepoint);
+Character loadSDFCharacter(unsigned int codepoint);
+
+/// All glyphs of a font that live in a single atlas texture: the ASCII range in a flat table
+/// indexed by codepoint, other codepoints are added to the atlas the first time they're used
+struct GlyphSet {
+    std::vector<Character> Characters;
+    std::unordered_map<unsigned int, Character> ExtendedCharacters;
+    // shaped strings at glyph scale relative to their origin, as <vec2 pos, vec2 tex> vertices
+    std::unordered_map<std::string, std::vector<float>> ShapedRuns;
+    unsigned int Atlas;
+    float UnitScale;                  // scale from glyph units to 48 pixel text
+    Character (*Load)(unsigned int);  // adds a codepoint to the atlas
+};
+
+// glyphs rasterized at 48 pixels
+GlyphSet bitmapGlyphs;
+unsigned int atlasPenX = 0, atlasPenY = 0, atlasRowHeight = 0;
+// FreeType is kept alive for lazily loaded glyphs
+FT_Library ft;
+FT_Face face;
+// signed distance field glyphs, one (smaller) atlas for all text sizes
+GlyphSet sdfGlyphs;
+SDFFont sdfFont;
+bool useSDF = true;
+bool sdfKeyPressed = false;
+
+std::vector<float> textVertices;
+unsigned int VAO, VBO, VBOCapacity = 0;
 
-std::map<GLchar, Character> Characters;
-unsigned int VAO, VBO;
+/// The original path: one texture per glyph and one draw call per character (kept for benchmarking)
+struct GlyphTexture {
+    unsigned int TextureID; // ID handle of the glyph texture
+    glm::ivec2   Size;      // Size of glyph
+    glm::ivec2   Bearing;   // Offset from baseline to left/top of glyph
+    unsigned int Advance;   // Horizontal offset to advance to next glyph
+};
+std::map<GLchar, GlyphTexture> GlyphTextures;
+unsigned int perGlyphVAO, perGlyphVBO;
+bool benchmarkKeyPressed = false;
 
 int main()
 {
@@ -76,13 +123,15 @@ int main()
     // compile and setup the shader
     // ----------------------------
     Shader shader("text.vs", "text.fs");
+    Shader sdfShader("text.vs", "text_sdf.fs");
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(SCR_WIDTH), 0.0f, static_cast<float>(SCR_HEIGHT));
     shader.use();
     glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    sdfShader.use();
+    glUniformMatrix4fv(glGetUniformLocation(sdfShader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
 
     // FreeType
     // --------
-    FT_Library ft;
     // All functions return a value different than 0 whenever an error occurred
     if (FT_Init_FreeType(&ft))
     {
@@ -99,69 +148,111 @@ int main()
     }
 	
 	// load font as face
-    FT_Face face;
     if (FT_New_Face(ft, font_name.c_str(), 0, &face)) {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
         return -1;
     }
-    else {
-        // set size to load glyphs as
-        FT_Set_Pixel_Sizes(face, 0, 48);
+    // set size to load glyphs as
+    FT_Set_Pixel_Sizes(face, 0, 48);
+
+    // disable byte-alignment restriction
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        // disable byte-alignment restriction
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // create the (empty) glyph atlas
+    std::vector<unsigned char> emptyAtlas(ATLAS_SIZE * ATLAS_SIZE, 0);
+    glGenTextures(1, &bitmapGlyphs.Atlas);
+    glBindTexture(GL_TEXTURE_2D, bitmapGlyphs.Atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, emptyAtlas.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        // load first 128 characters of ASCII set
-        for (unsigned char c = 0; c < 128; c++)
+    // load first 128 characters of ASCII set into the atlas
+    bitmapGlyphs.UnitScale = 1.0f;
+    bitmapGlyphs.Load = loadCharacter;
+    for (unsigned int c = 0; c < 128; c++)
+        bitmapGlyphs.Characters.push_back(loadCharacter(c));
+
+    // generate the distance fields of the same characters (or load them from the cache of a previous run)
+    if (!sdfFont.Load(font_name, 0, 128, "Antonio-Bold.sdf"))
+        return -1;
+    glGenTextures(1, &sdfGlyphs.Atlas);
+    glBindTexture(GL_TEXTURE_2D, sdfGlyphs.Atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, sdfFont.AtlasSize, sdfFont.AtlasSize, 0, GL_RED, GL_UNSIGNED_BYTE, sdfFont.Pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    sdfGlyphs.UnitScale = 48.0f / sdfFont.GlyphSize;
+    sdfGlyphs.Load = loadSDFCharacter;
+    sdfGlyphs.Characters.assign(128, Character{ glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 });
+    for (const SDFGlyph &glyph : sdfFont.Glyphs)
+    {
+        Character &ch = sdfGlyphs.Characters[glyph.Codepoint];
+        ch.UVMin = glm::vec2(glyph.Offset) / static_cast<float>(sdfFont.AtlasSize);
+        ch.UVMax = glm::vec2(glyph.Offset + glyph.Size) / static_cast<float>(sdfFont.AtlasSize);
+        ch.Size = glyph.Size;
+        ch.Bearing = glyph.Bearing;
+        ch.Advance = glyph.Advance;
+    }
+
+    // also load the same characters the original way (a texture per glyph) to compare against
+    for (unsigned char c = 0; c < 128; c++)
+    {
+        // Load character glyph 
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
-            // Load character glyph 
-            if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-            {
-                std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-                continue;
-            }
-            // generate texture
-            unsigned int texture;
-            glGenTextures(1, &texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                face->glyph->bitmap.width,
-                face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer
-            );
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            // now store character for later use
-            Character character = {
-                texture,
-                glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-                glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-                static_cast<unsigned int>(face->glyph->advance.x)
-            };
-            Characters.insert(std::pair<char, Character>(c, character));
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            continue;
         }
-        glBindTexture(GL_TEXTURE_2D, 0);
+        // generate texture
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            0,
+            GL_RED,
+            face->glyph->bitmap.width,
+            face->glyph->bitmap.rows,
+            0,
+            GL_RED,
+            GL_UNSIGNED_BYTE,
+            face->glyph->bitmap.buffer
+        );
+        // set texture options
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // now store character for later use
+        GlyphTexture glyph = {
+            texture,
+            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
+            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
+            static_cast<unsigned int>(face->glyph->advance.x)
+        };
+        GlyphTextures.insert(std::pair<char, GlyphTexture>(c, glyph));
     }
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    glBindTexture(GL_TEXTURE_2D, 0);
 
     
-    // configure VAO/VBO for texture quads
-    // -----------------------------------
+    // configure VAO/VBO for texture quads; the VBO is (re)allocated when streaming a string
+    // -------------------------------------------------------------------------------------
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glGenVertexArrays(1, &perGlyphVAO);
+    glGenBuffers(1, &perGlyphVBO);
+    glBindVertexArray(perGlyphVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, perGlyphVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
@@ -175,14 +266,37 @@ int main()
         // input
         // -----
         processInput(window);
+        if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+        {
+            benchmarkText(shader);
+            benchmarkKeyPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+        {
+            benchmarkKeyPressed = false;
+        }
+        if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !sdfKeyPressed)
+        {
+            useSDF = !useSDF;
+            sdfKeyPressed = true;
+        }
+        if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE)
+        {
+            sdfKeyPressed = false;
+        }
 
         // render
         // ------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        RenderText(shader, "This is sample text", 25.0f, 25.0f, 1.0f, glm::vec3(0.5, 0.8f, 0.2f));
-        RenderText(shader, "(C) LearnOpenGL.com", 540.0f, 570.0f, 0.5f, glm::vec3(0.3, 0.7f, 0.9f));
+        // distance field text stays sharp at any scale, bitmap text blurs when scaled up
+        Shader &textShader = useSDF ? sdfShader : shader;
+        GlyphSet &glyphs = useSDF ? sdfGlyphs : bitmapGlyphs;
+        float pulse = 1.0f + 1.5f * (0.5f + 0.5f * static_cast<float>(sin(glfwGetTime())));
+        RenderText(textShader, glyphs, "This is sample text", 25.0f, 25.0f, 1.0f, glm::vec3(0.5, 0.8f, 0.2f));
+        RenderText(textShader, glyphs, "(C) LearnOpenGL.com", 540.0f, 570.0f, 0.5f, glm::vec3(0.3, 0.7f, 0.9f));
+        RenderText(textShader, glyphs, useSDF ? "SDF" : "Bitmap", 25.0f, 300.0f, pulse, glm::vec3(0.9f, 0.9f, 0.9f));
        
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -190,6 +304,10 @@ int main()
         glfwPollEvents();
     }
 
+    // destroy FreeType once we're finished
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+
     glfwTerminate();
     return 0;
 }
@@ -212,21 +330,191 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 }
 
 
-// render line of text
-// -------------------
-void RenderText(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color)
+// decodes the next codepoint of a UTF-8 string and advances the iterator (invalid bytes decode as '?')
+// ---------------------------------------------------------------------------------------------------
+unsigned int nextCodepoint(std::string::const_iterator &it, std::string::const_iterator end)
+{
+    unsigned char lead = static_cast<unsigned char>(*it++);
+    unsigned int codepoint;
+    int continuation;
+    if (lead < 0x80)
+        return lead;
+    else if ((lead & 0xE0) == 0xC0) { codepoint = lead & 0x1F; continuation = 1; }
+    else if ((lead & 0xF0) == 0xE0) { codepoint = lead & 0x0F; continuation = 2; }
+    else if ((lead & 0xF8) == 0xF0) { codepoint = lead & 0x07; continuation = 3; }
+    else
+        return '?';
+    for (int i = 0; i < continuation; ++i)
+    {
+        if (it == end || (static_cast<unsigned char>(*it) & 0xC0) != 0x80)
+            return '?';
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(*it++) & 0x3F);
+    }
+    return codepoint;
+}
+
+// rasterizes a single codepoint and packs it into the next free spot of the atlas (shelf packing)
+// ----------------------------------------------------------------------------------------------
+Character loadCharacter(unsigned int codepoint)
+{
+    Character character = { glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+    if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
+    {
+        std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+        return character;
+    }
+    unsigned int width = face->glyph->bitmap.width;
+    unsigned int rows = face->glyph->bitmap.rows;
+    character.Size = glm::ivec2(width, rows);
+    character.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+    character.Advance = static_cast<unsigned int>(face->glyph->advance.x);
+    if (width == 0 || rows == 0)
+        return character;
+    // start a new shelf if the glyph doesn't fit on the current one (1 texel padding against bleeding)
+    if (atlasPenX + width + 1 > ATLAS_SIZE)
+    {
+        atlasPenX = 0;
+        atlasPenY += atlasRowHeight + 1;
+        atlasRowHeight = 0;
+    }
+    if (atlasPenY + rows > ATLAS_SIZE)
+    {
+        std::cout << "ERROR::FREETYPE: Glyph atlas is full" << std::endl;
+        character.Size = glm::ivec2(0);
+        return character;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, bitmapGlyphs.Atlas);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, atlasPenX, atlasPenY, width, rows, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
+    character.UVMin = glm::vec2(atlasPenX, atlasPenY) / static_cast<float>(ATLAS_SIZE);
+    character.UVMax = glm::vec2(atlasPenX + width, atlasPenY + rows) / static_cast<float>(ATLAS_SIZE);
+    atlasPenX += width + 1;
+    atlasRowHeight = std::max(atlasRowHeight, rows);
+    return character;
+}
+
+// generates the distance field of a codepoint outside of the preloaded range and uploads it
+// -----------------------------------------------------------------------------------------
+Character loadSDFCharacter(unsigned int codepoint)
+{
+    Character character = { glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+    SDFGlyph glyph;
+    if (!sdfFont.AddGlyph(codepoint, glyph))
+        return character;
+    character.Size = glyph.Size;
+    character.Bearing = glyph.Bearing;
+    character.Advance = glyph.Advance;
+    if (glyph.Size.x == 0 || glyph.Size.y == 0)
+        return character;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, sdfFont.AtlasSize);
+    glBindTexture(GL_TEXTURE_2D, sdfGlyphs.Atlas);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, glyph.Offset.x, glyph.Offset.y, glyph.Size.x, glyph.Size.y, GL_RED, GL_UNSIGNED_BYTE,
+        &sdfFont.Pixels[glyph.Offset.y * sdfFont.AtlasSize + glyph.Offset.x]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    character.UVMin = glm::vec2(glyph.Offset) / static_cast<float>(sdfFont.AtlasSize);
+    character.UVMax = glm::vec2(glyph.Offset + glyph.Size) / static_cast<float>(sdfFont.AtlasSize);
+    return character;
+}
+
+// returns the character of a codepoint, loading it into the atlas on first use
+// ----------------------------------------------------------------------------
+const Character &getCharacter(GlyphSet &glyphs, unsigned int codepoint)
+{
+    if (codepoint < glyphs.Characters.size())
+        return glyphs.Characters[codepoint];
+    auto it = glyphs.ExtendedCharacters.find(codepoint);
+    if (it == glyphs.ExtendedCharacters.end())
+        it = glyphs.ExtendedCharacters.insert(std::make_pair(codepoint, glyphs.Load(codepoint))).first;
+    return it->second;
+}
+
+// lays out a string once at glyph scale relative to its origin; the result is cached for static text
+// --------------------------------------------------------------------------------------------------
+const std::vector<float> &shapeText(GlyphSet &glyphs, const std::string &text)
+{
+    auto it = glyphs.ShapedRuns.find(text);
+    if (it != glyphs.ShapedRuns.end())
+        return it->second;
+    std::vector<float> &vertices = glyphs.ShapedRuns[text];
+    float x = 0.0f;
+    std::string::const_iterator c = text.begin();
+    while (c != text.end())
+    {
+        const Character &ch = getCharacter(glyphs, nextCodepoint(c, text.end()));
+
+        float xpos = x + ch.Bearing.x;
+        float ypos = static_cast<float>(-(ch.Size.y - ch.Bearing.y));
+
+        float w = static_cast<float>(ch.Size.x);
+        float h = static_cast<float>(ch.Size.y);
+        float quad[6][4] = {
+            { xpos,     ypos + h,   ch.UVMin.x, ch.UVMin.y },
+            { xpos,     ypos,       ch.UVMin.x, ch.UVMax.y },
+            { xpos + w, ypos,       ch.UVMax.x, ch.UVMax.y },
+
+            { xpos,     ypos + h,   ch.UVMin.x, ch.UVMin.y },
+            { xpos + w, ypos,       ch.UVMax.x, ch.UVMax.y },
+            { xpos + w, ypos + h,   ch.UVMax.x, ch.UVMin.y }
+        };
+        if (w > 0.0f && h > 0.0f)
+            vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
+        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+        x += (ch.Advance >> 6); // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+    }
+    return vertices;
+}
+
+// render line of text: all glyphs of the string are streamed to the VBO and drawn in one call
+// -------------------------------------------------------------------------------------------
+void RenderText(Shader &shader, GlyphSet &glyphs, std::string text, float x, float y, float scale, glm::vec3 color)
 {
     // activate corresponding render state	
     shader.use();
     glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
     glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, glyphs.Atlas);
     glBindVertexArray(VAO);
 
+    // position the cached run
+    const std::vector<float> &run = shapeText(glyphs, text);
+    scale *= glyphs.UnitScale;
+    textVertices.resize(run.size());
+    for (size_t i = 0; i < run.size(); i += 4)
+    {
+        textVertices[i + 0] = x + run[i + 0] * scale;
+        textVertices[i + 1] = y + run[i + 1] * scale;
+        textVertices[i + 2] = run[i + 2];
+        textVertices[i + 3] = run[i + 3];
+    }
+    // orphan the buffer (growing it if required) and upload the whole string at once
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (textVertices.size() > VBOCapacity)
+        VBOCapacity = static_cast<unsigned int>(textVertices.size() * 2);
+    glBufferData(GL_ARRAY_BUFFER, VBOCapacity * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, textVertices.size() * sizeof(float), textVertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // render all glyph quads
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(textVertices.size() / 4));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// render line of text the original way: a texture bind, buffer update and draw call per character
+// -----------------------------------------------------------------------------------------------
+void RenderTextPerGlyph(Shader &shader, std::string text, float x, float y, float scale, glm::vec3 color)
+{
+    // activate corresponding render state	
+    shader.use();
+    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(perGlyphVAO);
+
     // iterate through all characters
     std::string::const_iterator c;
     for (c = text.begin(); c != text.end(); c++) 
     {
-        Character ch = Characters[*c];
+        GlyphTexture ch = GlyphTextures[*c];
 
         float xpos = x + ch.Bearing.x * scale;
         float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
@@ -246,7 +534,7 @@ void RenderText(Shader &shader, std::string text, float x, float y, float scale,
         // render glyph texture over quad
         glBindTexture(GL_TEXTURE_2D, ch.TextureID);
         // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, perGlyphVBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -258,3 +546,28 @@ void RenderText(Shader &shader, std::string text, float x, float y, float scale,
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+// renders a block of text with both paths and prints the throughput in glyphs per millisecond
+// -------------------------------------------------------------------------------------------
+void benchmarkText(Shader &shader)
+{
+    const std::string text = "The quick brown fox jumps over the lazy dog 0123456789";
+    const unsigned int iterations = 2000;
+    const float glyphs = static_cast<float>(text.size() * iterations);
+
+    glFinish();
+    double start = glfwGetTime();
+    for (unsigned int i = 0; i < iterations; ++i)
+        RenderTextPerGlyph(shader, text, 25.0f, 300.0f, 0.5f, glm::vec3(1.0f));
+    glFinish();
+    double perGlyphTime = (glfwGetTime() - start) * 1000.0;
+
+    start = glfwGetTime();
+    for (unsigned int i = 0; i < iterations; ++i)
+        RenderText(shader, bitmapGlyphs, text, 25.0f, 300.0f, 0.5f, glm::vec3(1.0f));
+    glFinish();
+    double atlasTime = (glfwGetTime() - start) * 1000.0;
+
+    std::cout << "per-glyph textures: " << glyphs / perGlyphTime << " glyphs/ms" << std::endl;
+    std::cout << "batched atlas:      " << glyphs / atlasTime << " glyphs/ms" << std::endl;
+}
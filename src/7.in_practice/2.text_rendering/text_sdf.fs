@@ -0,0 +1,16 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 color;
+
+uniform sampler2D text;
+uniform vec3 textColor;
+
+void main()
+{    
+    // the atlas stores signed distances with the glyph outline at 0.5; fwidth keeps the
+    // anti-aliased edge about one screen pixel wide regardless of the text's scale
+    float distance = texture(text, TexCoords).r;
+    float width = fwidth(distance) * 0.75;
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(textColor, alpha);
+}
\ No newline at end of file
@@ -7,6 +7,7 @@
 ** option) any later version.
 ******************************************************************/
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <iostream>
 
@@ -35,10 +36,17 @@ ISoundEngine      *SoundEngine = createIrrKlangDevice();
 TextRenderer      *Text;
 
 float ShakeTime = 0.0f;
+bool  AudioEnabled = true;
 
+// plays a sound effect (unless audio is disabled, e.g. in headless runs)
+void PlayAudio(const char *file, bool loop = false)
+{
+    if (AudioEnabled && SoundEngine)
+        SoundEngine->play2D(FileSystem::getPath(file).c_str(), loop);
+}
 
 Game::Game(unsigned int width, unsigned int height) 
-    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3)
+    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3), Seed(0), ShowTimings(false)
 { 
 
 }
@@ -54,12 +62,13 @@ Game::~Game()
     SoundEngine->drop();
 }
 
-void Game::Init()
+void Game::Init(bool headless)
 {
+    AudioEnabled = !headless;
+    this->rng.Seed(this->Seed);
     // load shaders
     ResourceManager::LoadShader("sprite.vs", "sprite.fs", nullptr, "sprite");
     ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
-    ResourceManager::LoadShader("post_processing.vs", "post_processing.fs", nullptr, "postprocessing");
     // configure shaders
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
     ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
@@ -82,14 +91,15 @@ void Game::Init()
     // set render-specific controls
     Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
     Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-    Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
+    Particles->Seed(this->Seed + 1); // each system draws from its own sequence
+    Effects = new PostProcessor("post_processing.vs", "post_processing.fs", this->Width, this->Height);
     Text = new TextRenderer(this->Width, this->Height);
-    Text->Load(FileSystem::getPath("resources/fonts/OCRAEXT.TTF").c_str(), 24);
-    // load levels
-    GameLevel one; one.Load(FileSystem::getPath("resources/levels/one.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel two; two.Load(FileSystem::getPath("resources/levels/two.lvl").c_str(), this->Width, this->Height /2 );
-    GameLevel three; three.Load(FileSystem::getPath("resources/levels/three.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel four; four.Load(FileSystem::getPath("resources/levels/four.lvl").c_str(), this->Width, this->Height / 2);
+    Text->LoadSDF(FileSystem::getPath("resources/fonts/OCRAEXT.TTF").c_str(), 24, "OCRAEXT.sdf");
+    // load levels (converted from the text .lvl files with --convert-level)
+    GameLevel one; one.Load(FileSystem::getPath("resources/levels/one.blvl").c_str(), this->Width, this->Height / 2);
+    GameLevel two; two.Load(FileSystem::getPath("resources/levels/two.blvl").c_str(), this->Width, this->Height /2 );
+    GameLevel three; three.Load(FileSystem::getPath("resources/levels/three.blvl").c_str(), this->Width, this->Height / 2);
+    GameLevel four; four.Load(FileSystem::getPath("resources/levels/four.blvl").c_str(), this->Width, this->Height / 2);
     this->Levels.push_back(one);
     this->Levels.push_back(two);
     this->Levels.push_back(three);
@@ -101,11 +111,33 @@ void Game::Init()
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
     Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
     // audio
-    SoundEngine->play2D(FileSystem::getPath("resources/audio/breakout.mp3").c_str(), true);
+    PlayAudio("resources/audio/breakout.mp3", true);
+}
+
+void Game::SetKey(int key, bool pressed)
+{
+    if (key < 0 || key >= 1024)
+        return;
+    this->Keys[key] = pressed;
+    if (!pressed)
+        this->KeysProcessed[key] = false;
+}
+
+void Game::Tick(float dt)
+{
+    // remember where everything was so rendering can interpolate towards this tick's positions
+    Player->PreviousPosition = Player->Position;
+    Ball->PreviousPosition = Ball->Position;
+    for (PowerUp &powerUp : this->PowerUps)
+        powerUp.PreviousPosition = powerUp.Position;
+    this->ProcessInput(dt);
+    this->Update(dt);
 }
 
 void Game::Update(float dt)
 {
+    // scroll tall levels to the bricks that are left, decoding the rows that come into view
+    this->Levels[this->Level].Update(dt, LEVEL_SCROLL_SPEED);
     // update objects
     Ball->Move(dt, this->Width);
     // check for collisions
@@ -204,8 +236,10 @@ void Game::ProcessInput(float dt)
     }
 }
 
-void Game::Render()
+void Game::Render(float alpha)
 {
+    // all text of this frame is collected and drawn with a single draw call at the end
+    Text->BeginBatch();
     if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State == GAME_WIN)
     {
         // begin rendering to postprocessing framebuffer
@@ -215,15 +249,15 @@ void Game::Render()
             // draw level
             this->Levels[this->Level].Draw(*Renderer);
             // draw player
-            Player->Draw(*Renderer);
+            Player->Draw(*Renderer, alpha);
             // draw PowerUps
             for (PowerUp &powerUp : this->PowerUps)
                 if (!powerUp.Destroyed)
-                    powerUp.Draw(*Renderer);
+                    powerUp.Draw(*Renderer, alpha);
             // draw particles	
             Particles->Draw();
             // draw ball
-            Ball->Draw(*Renderer);            
+            Ball->Draw(*Renderer, alpha);            
         // end rendering to postprocessing framebuffer
         Effects->EndRender();
         // render postprocessing quad
@@ -231,6 +265,12 @@ void Game::Render()
         // render text (don't include in postprocessing)
         std::stringstream ss; ss << this->Lives;
         Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
+        if (this->ShowTimings)
+        {
+            std::stringstream timings; timings.precision(3); timings << std::fixed;
+            timings << "Resolve: " << Effects->ResolveTime << " ms  Effects: " << Effects->EffectTime << " ms";
+            Text->RenderText(timings.str(), 5.0f, 25.0f, 0.5f, glm::vec3(1.0f, 1.0f, 0.0f));
+        }
     }
     if (this->State == GAME_MENU)
     {
@@ -242,19 +282,20 @@ void Game::Render()
         Text->RenderText("You WON!!!", 320.0f, this->Height / 2.0f - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
         Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
     }
+    Text->EndBatch();
 }
 
 
 void Game::ResetLevel()
 {
     if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
+        this->Levels[0].Load(FileSystem::getPath("resources/levels/one.blvl").c_str(), this->Width, this->Height / 2);
     else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
+        this->Levels[1].Load(FileSystem::getPath("resources/levels/two.blvl").c_str(), this->Width, this->Height / 2);
     else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
+        this->Levels[2].Load(FileSystem::getPath("resources/levels/three.blvl").c_str(), this->Width, this->Height / 2);
     else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
+        this->Levels[3].Load(FileSystem::getPath("resources/levels/four.blvl").c_str(), this->Width, this->Height / 2);
 
     this->Lives = 3;
 }
@@ -265,6 +306,9 @@ void Game::ResetPlayer()
     Player->Size = PLAYER_SIZE;
     Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
     Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+    // don't interpolate the jump back to the start position
+    Player->PreviousPosition = Player->Position;
+    Ball->PreviousPosition = Ball->Position;
     // also disable all active powerups
     Effects->Chaos = Effects->Confuse = false;
     Ball->PassThrough = Ball->Sticky = false;
@@ -273,6 +317,48 @@ void Game::ResetPlayer()
 }
 
 
+// folds the bytes of a value into an FNV-1a hash
+template <typename T>
+void HashValue(unsigned long long &hash, const T &value)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (unsigned char byte : bytes)
+        hash = (hash ^ byte) * 1099511628211ull;
+}
+
+void HashObject(unsigned long long &hash, const GameObject &object)
+{
+    HashValue(hash, object.Position);
+    HashValue(hash, object.Size);
+    HashValue(hash, object.Velocity);
+    HashValue(hash, object.Destroyed);
+}
+
+unsigned long long Game::StateHash() const
+{
+    unsigned long long hash = 14695981039346656037ull;
+    HashValue(hash, this->State);
+    HashValue(hash, this->Level);
+    HashValue(hash, this->Lives);
+    HashValue(hash, ShakeTime);
+    HashObject(hash, *Player);
+    HashObject(hash, *Ball);
+    HashValue(hash, Ball->Stuck);
+    HashValue(hash, Ball->Sticky);
+    HashValue(hash, Ball->PassThrough);
+    HashValue(hash, this->Levels[this->Level].Scroll);
+    HashValue(hash, this->Levels[this->Level].DestroyedHash());
+    for (const PowerUp &powerUp : this->PowerUps)
+    {
+        HashObject(hash, powerUp);
+        HashValue(hash, powerUp.Activated);
+        HashValue(hash, powerUp.Duration);
+    }
+    return hash;
+}
+
+
 // powerups
 bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type);
 
@@ -330,25 +416,25 @@ void Game::UpdatePowerUps(float dt)
     ), this->PowerUps.end());
 }
 
-bool ShouldSpawn(unsigned int chance)
+bool ShouldSpawn(Random &rng, unsigned int chance)
 {
-    unsigned int random = rand() % chance;
+    unsigned int random = rng.Next(chance);
     return random == 0;
 }
-void Game::SpawnPowerUps(GameObject &block)
+void Game::SpawnPowerUps(glm::vec2 position)
 {
-    if (ShouldSpawn(75)) // 1 in 75 chance
-        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-    if (ShouldSpawn(15)) // Negative powerups should spawn more often
-        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-    if (ShouldSpawn(15))
-        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
+    if (ShouldSpawn(this->rng, 75)) // 1 in 75 chance
+        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, position, ResourceManager::GetTexture("powerup_speed")));
+    if (ShouldSpawn(this->rng, 75))
+        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, position, ResourceManager::GetTexture("powerup_sticky")));
+    if (ShouldSpawn(this->rng, 75))
+        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, position, ResourceManager::GetTexture("powerup_passthrough")));
+    if (ShouldSpawn(this->rng, 75))
+        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, position, ResourceManager::GetTexture("powerup_increase")));
+    if (ShouldSpawn(this->rng, 15)) // Negative powerups should spawn more often
+        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, position, ResourceManager::GetTexture("powerup_confuse")));
+    if (ShouldSpawn(this->rng, 15))
+        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, position, ResourceManager::GetTexture("powerup_chaos")));
 }
 
 void ActivatePowerUp(PowerUp &powerUp)
@@ -400,34 +486,48 @@ bool IsOtherPowerUpActive(std::vector<PowerUp> &powerUps, std::string type)
 // collision detection
 bool CheckCollision(GameObject &one, GameObject &two);
 Collision CheckCollision(BallObject &one, GameObject &two);
+Collision CheckCollision(BallObject &one, glm::vec2 position, glm::vec2 size);
 Direction VectorDirection(glm::vec2 closest);
 
 void Game::DoCollisions()
 {
-    for (GameObject &box : this->Levels[this->Level].Bricks)
+    // only test the tiles around the ball (with a margin of one tile, as collision resolution may move the ball)
+    GameLevel &level = this->Levels[this->Level];
+    glm::uvec2 first, last;
+    glm::vec2 ballMin = Ball->Position - level.TileSize, ballMax = Ball->Position + 2.0f * Ball->Radius + level.TileSize;
+    if (!level.TilesInRect(ballMin, ballMax, first, last))
+        first = glm::uvec2(1), last = glm::uvec2(0); // nothing to test
+    for (unsigned int y = first.y; y <= last.y; ++y)
     {
-        if (!box.Destroyed)
+        if (!level.IsLoaded(y))
+            continue;
+        for (unsigned int x = first.x; x <= last.x; ++x)
         {
-            Collision collision = CheckCollision(*Ball, box);
+            unsigned char type = level.Type(x, y);
+            if (type == TILE_EMPTY || level.IsDestroyed(x, y))
+                continue;
+            bool solid = type == TILE_SOLID;
+            glm::vec2 position = level.TilePosition(x, y);
+            Collision collision = CheckCollision(*Ball, position, level.TileSize);
             if (std::get<0>(collision)) // if collision is true
             {
                 // destroy block if not solid
-                if (!box.IsSolid)
+                if (!solid)
                 {
-                    box.Destroyed = true;
-                    this->SpawnPowerUps(box);
-                    SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.mp3").c_str(), false);
+                    level.Destroy(x, y);
+                    this->SpawnPowerUps(position);
+                    PlayAudio("resources/audio/bleep.mp3");
                 }
                 else
                 {   // if block is solid, enable shake effect
                     ShakeTime = 0.05f;
                     Effects->Shake = true;
-                    SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.mp3").c_str(), false);
+                    PlayAudio("resources/audio/bleep.mp3");
                 }
                 // collision resolution
                 Direction dir = std::get<1>(collision);
                 glm::vec2 diff_vector = std::get<2>(collision);
-                if (!(Ball->PassThrough && !box.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
+                if (!(Ball->PassThrough && !solid)) // don't do collision resolution on non-solid bricks if pass-through is activated
                 {
                     if (dir == LEFT || dir == RIGHT) // horizontal collision
                     {
@@ -468,7 +568,7 @@ void Game::DoCollisions()
                 ActivatePowerUp(powerUp);
                 powerUp.Destroyed = true;
                 powerUp.Activated = true;
-                SoundEngine->play2D(FileSystem::getPath("resources/audio/powerup.wav").c_str(), false);
+                PlayAudio("resources/audio/powerup.wav");
             }
         }
     }
@@ -493,7 +593,7 @@ void Game::DoCollisions()
         // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
         Ball->Stuck = Ball->Sticky;
 
-        SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.wav").c_str(), false);
+        PlayAudio("resources/audio/bleep.wav");
     }
 }
 
@@ -510,12 +610,17 @@ bool CheckCollision(GameObject &one, GameObject &two) // AABB - AABB collision
 }
 
 Collision CheckCollision(BallObject &one, GameObject &two) // AABB - Circle collision
+{
+    return CheckCollision(one, two.Position, two.Size);
+}
+
+Collision CheckCollision(BallObject &one, glm::vec2 position, glm::vec2 size) // AABB - Circle collision
 {
     // get center point circle first 
     glm::vec2 center(one.Position + one.Radius);
     // calculate AABB info (center, half-extents)
-    glm::vec2 aabb_half_extents(two.Size.x / 2.0f, two.Size.y / 2.0f);
-    glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
+    glm::vec2 aabb_half_extents(size.x / 2.0f, size.y / 2.0f);
+    glm::vec2 aabb_center(position.x + aabb_half_extents.x, position.y + aabb_half_extents.y);
     // get difference vector between both centers
     glm::vec2 difference = center - aabb_center;
     glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
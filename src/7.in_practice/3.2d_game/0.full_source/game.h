@@ -16,6 +16,7 @@
 
 #include "game_level.h"
 #include "power_up.h"
+#include "random.h"
 
 // Represents the current state of the game
 enum GameState {
@@ -42,6 +43,10 @@ const float PLAYER_VELOCITY(500.0f);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+// Speed (in pixels per second) at which levels taller than the screen scroll to the bricks that are left
+const float LEVEL_SCROLL_SPEED(100.0f);
+// Length of a single simulation step in seconds; the game always advances in steps of this size
+const float TIMESTEP = 1.0f / 120.0f;
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
@@ -58,22 +63,34 @@ public:
     std::vector<PowerUp>    PowerUps;
     unsigned int            Level;
     unsigned int            Lives;
+    // seed of all random number generators, set before Init to reproduce a session
+    unsigned int            Seed;
+    // shows the GPU time of the post-processing passes
+    bool                    ShowTimings;
     // constructor/destructor
     Game(unsigned int width, unsigned int height);
     ~Game();
-    // initialize game state (load all shaders/textures/levels)
-    void Init();
+    // initialize game state (load all shaders/textures/levels); headless games don't play audio
+    void Init(bool headless = false);
+    // applies a key press/release
+    void SetKey(int key, bool pressed);
     // game loop
+    void Tick(float dt); // advances the simulation by one fixed step: ProcessInput + Update
     void ProcessInput(float dt);
     void Update(float dt);
-    void Render();
+    void Render(float alpha = 1.0f); // alpha: fraction of the next tick that has elapsed, for interpolation
     void DoCollisions();
+    // hash of all gameplay state; equal seeds and inputs must give equal hashes
+    unsigned long long StateHash() const;
     // reset
     void ResetLevel();
     void ResetPlayer();
     // powerups
-    void SpawnPowerUps(GameObject &block);
+    void SpawnPowerUps(glm::vec2 position);
     void UpdatePowerUps(float dt);
+private:
+    // randomness of gameplay events (e.g. PowerUp spawns)
+    Random rng;
 };
 
 #endif
\ No newline at end of file
@@ -8,86 +8,411 @@
 ******************************************************************/
 #include "game_level.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <sstream>
 
+// "BLVL" when read as little-endian bytes
+const unsigned int LEVEL_MAGIC = 0x4C564C42;
+const unsigned int LEVEL_VERSION = 1;
+
+const unsigned int GameLevel::MAX_VISIBLE_ROWS;
+
 
 void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
 {
     // clear old data
-    this->Bricks.clear();
-    // load from file
-    unsigned int tileCode;
-    GameLevel level;
-    std::string line;
-    std::ifstream fstream(file);
-    std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
+    this->Columns = this->Rows = 0;
+    this->Scroll = 0.0f;
+    this->viewHeight = static_cast<float>(levelHeight);
+    this->chunks.clear();
+    this->tiles.clear();
+    this->resident.clear();
+    this->file.clear();
+    this->remaining = 0;
+    this->lowestChunk = 0;
+    // binary levels start with the magic number, anything else is parsed as text
+    unsigned int magic = 0;
+    std::ifstream fstream(file, std::ios::binary);
+    if (!fstream)
+        return;
+    fstream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    fstream.close();
+    bool loaded = magic == LEVEL_MAGIC ? this->loadBinary(file) : this->loadText(file);
+    if (!loaded || this->Rows == 0 || this->Columns == 0)
+        return;
+    // calculate dimensions
+    this->TileSize = glm::vec2(levelWidth / static_cast<float>(this->Columns), levelHeight / static_cast<float>(std::min(this->Rows, MAX_VISIBLE_ROWS)));
+    // start at the bottom rows, the ones the ball reaches first
+    this->lowestChunk = static_cast<unsigned int>(this->chunks.size());
+    this->Scroll = std::max(0.0f, this->Rows * this->TileSize.y - this->viewHeight);
+    // decode what's visible
+    this->Stream(this->Scroll, this->Scroll + this->viewHeight);
+}
+
+void GameLevel::Update(float dt, float scrollSpeed)
+{
+    if (this->chunks.empty())
+        return;
+    // chunks only ever lose bricks, so the lowest one with bricks left only moves up
+    while (this->lowestChunk > 0 && this->tiles[this->lowestChunk - 1].Remaining == 0)
+        --this->lowestChunk;
+    // show the lowest chunk with bricks left at the bottom of the view
+    float bottom = std::min(this->lowestChunk * this->rowsPerChunk, this->Rows) * this->TileSize.y;
+    float target = glm::clamp(bottom - this->viewHeight, 0.0f, std::max(0.0f, this->Rows * this->TileSize.y - this->viewHeight));
+    float step = scrollSpeed * dt;
+    this->Scroll = std::abs(target - this->Scroll) <= step ? target : this->Scroll + (target > this->Scroll ? step : -step);
+    this->Stream(this->Scroll, this->Scroll + this->viewHeight);
+}
+
+void GameLevel::Stream(float top, float bottom)
+{
+    if (this->chunks.empty() || this->TileSize.y <= 0.0f || bottom < 0.0f)
+        return;
+    float chunkHeight = this->rowsPerChunk * this->TileSize.y;
+    // evict what's more than a view's height away (text levels can't be decoded again, they always stay)
+    if (!this->file.empty())
     {
-        while (std::getline(fstream, line)) // read each line from level file
+        for (size_t i = 0; i < this->resident.size(); )
         {
-            std::istringstream sstream(line);
-            std::vector<unsigned int> row;
-            while (sstream >> tileCode) // read each word separated by spaces
-                row.push_back(tileCode);
-            tileData.push_back(row);
+            unsigned int c = this->resident[i];
+            if ((c + 1) * chunkHeight < top - this->viewHeight || c * chunkHeight > bottom + this->viewHeight)
+            {
+                this->evict(c);
+                this->resident[i] = this->resident.back();
+                this->resident.pop_back();
+            }
+            else
+                ++i;
         }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
+    }
+    unsigned int firstRow = static_cast<unsigned int>(std::max(0.0f, std::floor(top / this->TileSize.y)));
+    unsigned int lastRow = std::min(static_cast<unsigned int>(bottom / this->TileSize.y), this->Rows - 1);
+    if (firstRow > lastRow)
+        return;
+    std::ifstream fstream;
+    for (unsigned int c = firstRow / this->rowsPerChunk; c <= lastRow / this->rowsPerChunk; ++c)
+    {
+        if (!this->tiles[c].Types.empty())
+            continue;
+        // only (re)open the file once there's actually something to decode
+        if (!fstream.is_open())
+        {
+            fstream.open(this->file, std::ios::binary);
+            if (!fstream)
+            {
+                std::cout << "ERROR::LEVEL: Failed to open level file: " << this->file << std::endl;
+                return;
+            }
+        }
+        this->decode(fstream, c);
+        this->resident.push_back(c);
     }
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+void GameLevel::decode(std::ifstream &fstream, unsigned int c)
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.Destroyed)
-            tile.Draw(renderer);
+    LevelChunk &chunk = this->chunks[c];
+    ChunkTiles &tiles = this->tiles[c];
+    std::vector<unsigned char> encoded(chunk.Size);
+    fstream.clear();
+    fstream.seekg(chunk.Offset);
+    if (!fstream.read(reinterpret_cast<char*>(encoded.data()), chunk.Size))
+        encoded.clear();
+    // decode the <count, tile code> runs straight into the chunk's tile map
+    unsigned int end = (std::min((c + 1) * this->rowsPerChunk, this->Rows) - c * this->rowsPerChunk) * this->Columns;
+    tiles.Types.assign(end, TILE_EMPTY);
+    tiles.Destroyed.assign(end, false);
+    unsigned int index = 0, destructible = 0;
+    for (size_t i = 0; i + 1 < encoded.size() && index < end; i += 2)
+    {
+        unsigned int count = std::min<unsigned int>(encoded[i], end - index);
+        std::memset(&tiles.Types[index], encoded[i + 1], count);
+        if (encoded[i + 1] > TILE_SOLID)
+            destructible += count;
+        index += count;
+    }
+    if (index != end || destructible != chunk.Destructible)
+    {
+        std::cout << "ERROR::LEVEL: Corrupt chunk " << c << " in level file: " << this->file << std::endl;
+        // keep the level completable with whatever we could decode (the table is corrected, so the
+        // counts are only adjusted the first time the chunk is decoded)
+        this->remaining = this->remaining - chunk.Destructible + destructible;
+        tiles.Remaining = tiles.Remaining - chunk.Destructible + destructible;
+        chunk.Destructible = destructible;
+    }
+    // restore the tiles destroyed before the chunk was evicted
+    for (unsigned int destroyed : tiles.DestroyedList)
+        tiles.Destroyed[destroyed] = true;
+    tiles.DestroyedList.clear();
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::evict(unsigned int c)
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.IsSolid && !tile.Destroyed)
-            return false;
-    return true;
+    ChunkTiles &tiles = this->tiles[c];
+    tiles.DestroyedList.clear();
+    for (unsigned int i = 0; i < tiles.Destroyed.size(); ++i)
+        if (tiles.Destroyed[i])
+            tiles.DestroyedList.push_back(i);
+    std::vector<unsigned char>().swap(tiles.Types);
+    std::vector<unsigned char>().swap(tiles.Destroyed);
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Draw(SpriteRenderer &renderer)
 {
-    // calculate dimensions
-    unsigned int height = tileData.size();
-    unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
-    float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height; 
-    // initialize level tiles based on tileData		
-    for (unsigned int y = 0; y < height; ++y)
+    if (this->Rows == 0 || this->TileSize.y <= 0.0f)
+        return;
+    Texture2D block = ResourceManager::GetTexture("block");
+    Texture2D solid = ResourceManager::GetTexture("block_solid");
+    unsigned int firstRow = static_cast<unsigned int>(this->Scroll / this->TileSize.y);
+    unsigned int lastRow = std::min(static_cast<unsigned int>((this->Scroll + this->viewHeight) / this->TileSize.y), this->Rows - 1);
+    for (unsigned int y = firstRow; y <= lastRow; ++y)
     {
-        for (unsigned int x = 0; x < width; ++x)
+        if (!this->IsLoaded(y))
+            continue;
+        for (unsigned int x = 0; x < this->Columns; ++x)
         {
-            // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
+            unsigned char type = this->Type(x, y);
+            if (type == TILE_EMPTY || this->IsDestroyed(x, y))
+                continue;
+            // check block type from level data
+            if (type == TILE_SOLID)
             {
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
+                renderer.DrawSprite(solid, this->TilePosition(x, y), this->TileSize, 0.0f, glm::vec3(0.8f, 0.8f, 0.7f));
             }
-            else if (tileData[y][x] > 1)	// non-solid; now determine its color based on level data
+            else // non-solid; now determine its color based on level data
             {
                 glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
+                if (type == 2)
                     color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
+                else if (type == 3)
                     color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
+                else if (type == 4)
                     color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
+                else if (type == 5)
                     color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                renderer.DrawSprite(block, this->TilePosition(x, y), this->TileSize, 0.0f, color);
             }
         }
     }
+}
+
+bool GameLevel::IsCompleted()
+{
+    return this->remaining == 0;
+}
+
+unsigned char GameLevel::Type(unsigned int x, unsigned int y) const
+{
+    if (!this->IsLoaded(y))
+        return TILE_EMPTY;
+    unsigned int c = y / this->rowsPerChunk;
+    return this->tiles[c].Types[(y - c * this->rowsPerChunk) * this->Columns + x];
+}
+
+bool GameLevel::IsDestroyed(unsigned int x, unsigned int y) const
+{
+    if (!this->IsLoaded(y))
+        return false;
+    unsigned int c = y / this->rowsPerChunk;
+    return this->tiles[c].Destroyed[(y - c * this->rowsPerChunk) * this->Columns + x] != 0;
+}
+
+void GameLevel::Destroy(unsigned int x, unsigned int y)
+{
+    if (!this->IsLoaded(y))
+        return;
+    unsigned int c = y / this->rowsPerChunk;
+    unsigned int index = (y - c * this->rowsPerChunk) * this->Columns + x;
+    ChunkTiles &tiles = this->tiles[c];
+    if (!tiles.Destroyed[index] && tiles.Types[index] > TILE_SOLID)
+    {
+        --this->remaining;
+        --tiles.Remaining;
+    }
+    tiles.Destroyed[index] = true;
+}
+
+bool GameLevel::IsLoaded(unsigned int row) const
+{
+    return row < this->Rows && !this->tiles[row / this->rowsPerChunk].Types.empty();
+}
+
+unsigned int GameLevel::ResidentChunks() const
+{
+    return static_cast<unsigned int>(this->resident.size());
+}
+
+bool GameLevel::TilesInRect(glm::vec2 min, glm::vec2 max, glm::uvec2 &first, glm::uvec2 &last) const
+{
+    // only the rows in view collide
+    min.y = std::max(min.y, 0.0f) + this->Scroll;
+    max.y = std::min(max.y, this->viewHeight) + this->Scroll;
+    if (this->Columns == 0 || this->Rows == 0 || max.x < 0.0f || max.y < min.y)
+        return false;
+    glm::vec2 from = glm::max(glm::floor(min / this->TileSize), glm::vec2(0.0f));
+    glm::vec2 to = glm::min(glm::floor(max / this->TileSize), glm::vec2(this->Columns - 1, this->Rows - 1));
+    if (from.x >= this->Columns || from.y >= this->Rows)
+        return false;
+    first = glm::uvec2(from);
+    last = glm::uvec2(to);
+    return true;
+}
+
+unsigned long long GameLevel::DestroyedHash() const
+{
+    // FNV-1a over the (level wide) indices of all destroyed tiles, in order
+    unsigned long long hash = 14695981039346656037ull;
+    auto hashValue = [&hash](unsigned int value) {
+        for (unsigned int byte = 0; byte < 4; ++byte)
+            hash = (hash ^ ((value >> (byte * 8)) & 0xFF)) * 1099511628211ull;
+    };
+    for (unsigned int c = 0; c < this->tiles.size(); ++c)
+    {
+        const ChunkTiles &tiles = this->tiles[c];
+        unsigned int first = c * this->rowsPerChunk * this->Columns;
+        if (tiles.Types.empty())
+        {
+            for (unsigned int destroyed : tiles.DestroyedList)
+                hashValue(first + destroyed);
+        }
+        else
+        {
+            for (unsigned int i = 0; i < tiles.Destroyed.size(); ++i)
+                if (tiles.Destroyed[i])
+                    hashValue(first + i);
+        }
+    }
+    return hash;
+}
+
+bool GameLevel::loadText(const char *file, unsigned int rowsPerChunk)
+{
+    unsigned int tileCode;
+    std::string line;
+    std::ifstream fstream(file);
+    if (!fstream || rowsPerChunk == 0)
+        return false;
+    std::vector<unsigned char> types;
+    while (std::getline(fstream, line)) // read each line from level file
+    {
+        std::istringstream sstream(line);
+        unsigned int column = 0;
+        while (sstream >> tileCode) // read each word separated by spaces
+        {
+            // the first row determines the width of the level, other rows are cut or padded to it
+            if (this->Rows == 0)
+                ++this->Columns;
+            else if (column >= this->Columns)
+                break;
+            types.push_back(static_cast<unsigned char>(tileCode));
+            ++column;
+        }
+        if (column == 0)
+            continue; // skip empty lines
+        types.resize((this->Rows + 1) * this->Columns, TILE_EMPTY);
+        ++this->Rows;
+    }
+    if (this->Rows == 0)
+        return false;
+    // a text level is decoded as a whole, so all its chunks are resident (and can't be evicted)
+    this->rowsPerChunk = rowsPerChunk;
+    unsigned int chunkCount = (this->Rows + rowsPerChunk - 1) / rowsPerChunk;
+    this->chunks.assign(chunkCount, LevelChunk{ 0, 0, 0 });
+    this->tiles.assign(chunkCount, ChunkTiles());
+    for (unsigned int c = 0; c < chunkCount; ++c)
+    {
+        ChunkTiles &tiles = this->tiles[c];
+        unsigned int first = c * rowsPerChunk * this->Columns;
+        unsigned int end = std::min((c + 1) * rowsPerChunk, this->Rows) * this->Columns;
+        tiles.Types.assign(types.begin() + first, types.begin() + end);
+        tiles.Destroyed.assign(tiles.Types.size(), false);
+        tiles.Remaining = 0;
+        for (unsigned char type : tiles.Types)
+            if (type > TILE_SOLID)
+                ++tiles.Remaining;
+        this->chunks[c].Destructible = tiles.Remaining;
+        this->remaining += tiles.Remaining;
+        this->resident.push_back(c);
+    }
+    return true;
+}
+
+bool GameLevel::loadBinary(const char *file)
+{
+    std::ifstream fstream(file, std::ios::binary);
+    LevelHeader header;
+    fstream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!fstream || header.Magic != LEVEL_MAGIC || header.Version != LEVEL_VERSION || header.RowsPerChunk == 0 ||
+        header.ChunkCount != (header.Rows + header.RowsPerChunk - 1) / header.RowsPerChunk)
+    {
+        std::cout << "ERROR::LEVEL: Invalid level file: " << file << std::endl;
+        return false;
+    }
+    this->chunks.resize(header.ChunkCount);
+    fstream.read(reinterpret_cast<char*>(this->chunks.data()), header.ChunkCount * sizeof(LevelChunk));
+    if (!fstream)
+    {
+        std::cout << "ERROR::LEVEL: Invalid level file: " << file << std::endl;
+        this->chunks.clear();
+        return false;
+    }
+    this->Columns = header.Columns;
+    this->Rows = header.Rows;
+    this->rowsPerChunk = header.RowsPerChunk;
+    this->file = file;
+    // tiles are only allocated (2 bytes per tile) once their chunk is streamed in
+    this->tiles.assign(header.ChunkCount, ChunkTiles());
+    for (unsigned int c = 0; c < header.ChunkCount; ++c)
+    {
+        this->tiles[c].Remaining = this->chunks[c].Destructible;
+        this->remaining += this->chunks[c].Destructible;
+    }
+    return true;
+}
+
+bool GameLevel::Convert(const char *textFile, const char *binaryFile, unsigned int rowsPerChunk)
+{
+    GameLevel level;
+    if (!level.loadText(textFile, rowsPerChunk))
+    {
+        std::cout << "ERROR::LEVEL: Failed to read level file: " << textFile << std::endl;
+        return false;
+    }
+    LevelHeader header = { LEVEL_MAGIC, LEVEL_VERSION, level.Columns, level.Rows, rowsPerChunk, static_cast<unsigned int>(level.chunks.size()) };
+    std::vector<LevelChunk> chunks(header.ChunkCount);
+    std::vector<unsigned char> data;
+    unsigned int offset = sizeof(LevelHeader) + header.ChunkCount * sizeof(LevelChunk);
+    for (unsigned int c = 0; c < header.ChunkCount; ++c)
+    {
+        // run-length encode the rows of this chunk; runs never cross chunk boundaries
+        const std::vector<unsigned char> &types = level.tiles[c].Types;
+        size_t start = data.size();
+        for (unsigned int i = 0; i < types.size(); )
+        {
+            unsigned char type = types[i];
+            unsigned int count = 1;
+            while (i + count < types.size() && count < 255 && types[i + count] == type)
+                ++count;
+            data.push_back(static_cast<unsigned char>(count));
+            data.push_back(type);
+            i += count;
+        }
+        chunks[c].Offset = offset + static_cast<unsigned int>(start);
+        chunks[c].Size = static_cast<unsigned int>(data.size() - start);
+        chunks[c].Destructible = level.chunks[c].Destructible;
+    }
+    std::ofstream fstream(binaryFile, std::ios::binary);
+    fstream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fstream.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(LevelChunk));
+    fstream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!fstream)
+    {
+        std::cout << "ERROR::LEVEL: Failed to write level file: " << binaryFile << std::endl;
+        return false;
+    }
+    return true;
 }
\ No newline at end of file
@@ -8,34 +8,125 @@
 ******************************************************************/
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
+#include <fstream>
+#include <string>
 #include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "game_object.h"
 #include "sprite_renderer.h"
 #include "resource_manager.h"
 
 
+// Tile codes as used by the level files
+enum TileType {
+    TILE_EMPTY = 0,
+    TILE_SOLID = 1
+    // any code > 1 is a destructible brick, the code selects its color
+};
+
+// Header of a binary level file (.blvl). The header is followed by a
+// table of ChunkCount LevelChunk entries and the run-length encoded
+// chunks themselves. Each chunk holds RowsPerChunk rows (the last one
+// possibly less) as <count, tile code> byte pairs, so chunks can be
+// decoded independently of each other.
+struct LevelHeader {
+    unsigned int Magic;
+    unsigned int Version;
+    unsigned int Columns, Rows;
+    unsigned int RowsPerChunk;
+    unsigned int ChunkCount;
+};
+struct LevelChunk {
+    unsigned int Offset;        // byte offset of the encoded chunk from the start of the file
+    unsigned int Size;          // size of the encoded chunk in bytes
+    unsigned int Destructible;  // number of destructible bricks in this chunk
+};
+
+
 /// GameLevel holds all Tiles as part of a Breakout level and 
 /// hosts functionality to Load/render levels from the harddisk.
+/// Tiles are stored as a compact tile map (one byte per tile per
+/// attribute) instead of individual game objects; their position and
+/// size follow from their index. The tile map is kept per chunk, and
+/// only the chunks around the visible rows are resident: binary levels
+/// are decoded chunk by chunk once their rows scroll into view and
+/// evicted again once they're far out of view (see Stream). Levels
+/// with more than MAX_VISIBLE_ROWS rows scroll; the view starts at the
+/// bottom rows and follows the lowest chunk with bricks left.
 class GameLevel
 {
 public:
+    // most rows shown at once, taller levels scroll
+    static const unsigned int MAX_VISIBLE_ROWS = 32;
     // level state
-    std::vector<GameObject> Bricks;
+    unsigned int               Columns, Rows;
+    glm::vec2                  TileSize;
+    float                      Scroll;    // level space y of the top of the view
     // constructor
-    GameLevel() { }
-    // loads level from file
+    GameLevel() : Columns(0), Rows(0), TileSize(0.0f), Scroll(0.0f), viewHeight(0.0f), remaining(0), lowestChunk(0), rowsPerChunk(0) { }
+    // loads level from file; either a text (.lvl) or binary (.blvl) level. The level is shown in a
+    // levelWidth x levelHeight area: all columns fit its width and up to MAX_VISIBLE_ROWS rows its height.
+    // Only the chunks in view are decoded.
     void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-    // render level
+    // moves the view towards the lowest chunk with bricks left (by at most scrollSpeed * dt) and makes
+    // sure the chunks in view are decoded while evicting the ones far out of view
+    void Update(float dt, float scrollSpeed);
+    // makes sure all rows between top and bottom (in level space) are decoded and evicts the chunks
+    // more than a view's height outside of them
+    void Stream(float top, float bottom);
+    // render the rows in view
     void Draw(SpriteRenderer &renderer);
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
+    // tile code at the given column/row, TILE_EMPTY for rows that aren't decoded
+    unsigned char Type(unsigned int x, unsigned int y) const;
+    // whether the tile at the given column/row is destroyed
+    bool IsDestroyed(unsigned int x, unsigned int y) const;
+    // destroys the tile at the given column/row
+    void Destroy(unsigned int x, unsigned int y);
+    // whether the row is decoded; rows that aren't don't render or collide
+    bool IsLoaded(unsigned int row) const;
+    // number of chunks decoded at the moment
+    unsigned int ResidentChunks() const;
+    // returns the (inclusive) range of decoded tiles that overlap the given rectangle (in screen space),
+    // false if there are none
+    bool TilesInRect(glm::vec2 min, glm::vec2 max, glm::uvec2 &first, glm::uvec2 &last) const;
+    // screen position of the tile at the given column/row
+    glm::vec2 TilePosition(unsigned int x, unsigned int y) const { return glm::vec2(this->TileSize.x * x, this->TileSize.y * y - this->Scroll); }
+    // hash of which tiles are destroyed, the same whether their chunks are resident or not
+    unsigned long long DestroyedHash() const;
+    // converts a text level into a binary level, returns false if it couldn't be converted
+    static bool Convert(const char *textFile, const char *binaryFile, unsigned int rowsPerChunk = 16);
 private:
-    // initialize level from tile data
-    void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
+    // the tiles of a chunk; Types and Destroyed are only allocated while the chunk is resident,
+    // the tiles destroyed in it are kept as a list while it's not
+    struct ChunkTiles {
+        std::vector<unsigned char> Types;     // tile code of each tile (row-major)
+        std::vector<unsigned char> Destroyed; // whether the tile at the same index is destroyed
+        std::vector<unsigned int>  DestroyedList;
+        unsigned int               Remaining; // destructible tiles that aren't destroyed
+    };
+    float viewHeight;
+    // number of destructible tiles that aren't destroyed (including those in chunks not decoded yet)
+    unsigned int remaining;
+    // one past the lowest chunk with destructible tiles left, the view scrolls towards it
+    unsigned int lowestChunk;
+    // binary level streaming state
+    std::string file;
+    unsigned int rowsPerChunk;
+    std::vector<LevelChunk> chunks;
+    std::vector<ChunkTiles> tiles;
+    std::vector<unsigned int> resident; // indices of the decoded chunks
+    // parses a text level into resident chunks of rowsPerChunk rows
+    bool loadText(const char *file, unsigned int rowsPerChunk = 16);
+    // reads the header and chunk table of a binary level
+    bool loadBinary(const char *file);
+    // decodes a chunk from the level file
+    void decode(std::ifstream &fstream, unsigned int c);
+    // frees a chunk's tiles, keeping the list of destroyed ones
+    void evict(unsigned int c);
 };
 
 #endif
\ No newline at end of file
@@ -24,6 +24,7 @@ class GameObject
 public:
     // object state
     glm::vec2   Position, Size, Velocity;
+    glm::vec2   PreviousPosition; // position at the start of the current simulation tick
     glm::vec3   Color;
     float       Rotation;
     bool        IsSolid;
@@ -35,6 +36,8 @@ public:
     GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
     // draw sprite
     virtual void Draw(SpriteRenderer &renderer);
+    // draw sprite interpolated between the previous and current position (alpha in [0, 1])
+    virtual void Draw(SpriteRenderer &renderer, float alpha);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,61 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "input_recording.h"
+
+#include <fstream>
+#include <iostream>
+
+
+void InputRecording::Record(unsigned long long tick, int key, bool pressed)
+{
+    InputEvent event = { tick, key, pressed };
+    this->Events.push_back(event);
+}
+
+bool InputRecording::Save(const char *file) const
+{
+    std::ofstream fstream(file);
+    if (!fstream)
+    {
+        std::cout << "ERROR::INPUT_RECORDING: Failed to write " << file << std::endl;
+        return false;
+    }
+    for (const InputEvent &event : this->Events)
+        fstream << event.Tick << " " << event.Key << " " << (event.Pressed ? 1 : 0) << "\n";
+    return true;
+}
+
+bool InputRecording::Load(const char *file)
+{
+    // clear old data
+    this->Events.clear();
+    this->cursor = 0;
+    std::ifstream fstream(file);
+    if (!fstream)
+    {
+        std::cout << "ERROR::INPUT_RECORDING: Failed to read " << file << std::endl;
+        return false;
+    }
+    InputEvent event;
+    int pressed;
+    while (fstream >> event.Tick >> event.Key >> pressed)
+    {
+        event.Pressed = pressed != 0;
+        this->Events.push_back(event);
+    }
+    return true;
+}
+
+bool InputRecording::Next(unsigned long long tick, InputEvent &event)
+{
+    if (this->cursor >= this->Events.size() || this->Events[this->cursor].Tick > tick)
+        return false;
+    event = this->Events[this->cursor++];
+    return true;
+}
\ No newline at end of file
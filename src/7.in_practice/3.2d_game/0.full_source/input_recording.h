@@ -0,0 +1,46 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef INPUT_RECORDING_H
+#define INPUT_RECORDING_H
+#include <cstddef>
+#include <vector>
+
+
+// A single key press or release, stamped with the simulation tick it was applied at
+struct InputEvent {
+    unsigned long long Tick;
+    int                Key;
+    bool               Pressed;
+};
+
+
+// InputRecording stores the key events of a play session in the order
+// they were applied to the simulation. As the simulation runs at a
+// fixed timestep and all of its randomness is seeded, replaying the
+// same events from the same seed reproduces the session exactly.
+class InputRecording
+{
+public:
+    // recorded events, sorted by tick
+    std::vector<InputEvent> Events;
+    // constructor
+    InputRecording() : cursor(0) { }
+    // appends an event; ticks must not decrease
+    void Record(unsigned long long tick, int key, bool pressed);
+    // writes/reads the recording as plain text (one "tick key pressed" triple per line)
+    bool Save(const char *file) const;
+    bool Load(const char *file);
+    // retrieves the next event of the given tick, returns false once all of the tick's events are consumed
+    bool Next(unsigned long long tick, InputEvent &event);
+private:
+    // index of the next event to replay
+    size_t cursor;
+};
+
+#endif
\ No newline at end of file
@@ -9,7 +9,7 @@
 #include "particle_generator.h"
 
 ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+    : amount(amount), lastUsedParticle(0), shader(shader), texture(texture)
 {
     this->init();
 }
@@ -57,6 +57,11 @@ void ParticleGenerator::Draw()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void ParticleGenerator::Seed(unsigned int seed)
+{
+    this->rng.Seed(seed);
+}
+
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
@@ -86,33 +91,31 @@ void ParticleGenerator::init()
         this->particles.push_back(Particle());
 }
 
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
 unsigned int ParticleGenerator::firstUnusedParticle()
 {
     // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i){
+    for (unsigned int i = this->lastUsedParticle; i < this->amount; ++i){
         if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
+            this->lastUsedParticle = i;
             return i;
         }
     }
     // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i){
+    for (unsigned int i = 0; i < this->lastUsedParticle; ++i){
         if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
+            this->lastUsedParticle = i;
             return i;
         }
     }
     // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
+    this->lastUsedParticle = 0;
     return 0;
 }
 
 void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
 {
-    float random = ((rand() % 100) - 50) / 10.0f;
-    float rColor = 0.5f + ((rand() % 100) / 100.0f);
+    float random = (static_cast<int>(this->rng.Next(100)) - 50) / 10.0f;
+    float rColor = 0.5f + (this->rng.Next(100) / 100.0f);
     particle.Position = object.Position + random + offset;
     particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
     particle.Life = 1.0f;
@@ -16,6 +16,7 @@
 #include "shader.h"
 #include "texture.h"
 #include "game_object.h"
+#include "random.h"
 
 
 // Represents a single particle and its state
@@ -40,10 +41,14 @@ public:
     void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
     // render all particles
     void Draw();
+    // restarts the generator's random sequence so particle spawns are reproducible
+    void Seed(unsigned int seed);
 private:
     // state
     std::vector<Particle> particles;
     unsigned int amount;
+    unsigned int lastUsedParticle;
+    Random rng;
     // render state
     Shader shader;
     Texture2D texture;
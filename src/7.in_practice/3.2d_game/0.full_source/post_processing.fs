@@ -3,44 +3,48 @@ in vec2 TexCoords;
 out vec4 color;
 
 uniform sampler2D scene;
-uniform vec2  offsets[9];
-uniform int     edge_kernel[9];
-uniform float  blur_kernel[9];
 
-uniform bool chaos;
-uniform bool confuse;
-uniform bool shake;
+// the set of effects is selected at compile time: CHAOS, CONFUSE and/or SHAKE are defined per permutation
+const float offset = 1.0 / 300.0;
+const vec2 offsets[9] = vec2[](
+    vec2(-offset,  offset), // top-left
+    vec2( 0.0,     offset), // top-center
+    vec2( offset,  offset), // top-right
+    vec2(-offset,  0.0),    // center-left
+    vec2( 0.0,     0.0),    // center-center
+    vec2( offset,  0.0),    // center-right
+    vec2(-offset, -offset), // bottom-left
+    vec2( 0.0,    -offset), // bottom-center
+    vec2( offset, -offset)  // bottom-right
+);
+const float edge_kernel[9] = float[](
+    -1.0, -1.0, -1.0,
+    -1.0,  8.0, -1.0,
+    -1.0, -1.0, -1.0
+);
+const float blur_kernel[9] = float[](
+    1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0,
+    2.0 / 16.0, 4.0 / 16.0, 2.0 / 16.0,
+    1.0 / 16.0, 2.0 / 16.0, 1.0 / 16.0
+);
 
-void main()
+vec3 convolute(const float kernel[9])
 {
-    // zero out memory since an out variable is initialized with undefined values by default 
-    color = vec4(0.0f);
-
-    vec3 sample[9];
-    // sample from texture offsets if using convolution matrix
-    if(chaos || shake)
-        for(int i = 0; i < 9; i++)
-            sample[i] = vec3(texture(scene, TexCoords.st + offsets[i]));
+    vec3 result = vec3(0.0);
+    for(int i = 0; i < 9; i++)
+        result += texture(scene, TexCoords.st + offsets[i]).rgb * kernel[i];
+    return result;
+}
 
-    // process effects
-    if(chaos)
-    {           
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * edge_kernel[i], 0.0f);
-        color.a = 1.0f;
-    }
-    else if(confuse)
-    {
-        color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
-    }
-    else if(shake)
-    {
-        for(int i = 0; i < 9; i++)
-            color += vec4(sample[i] * blur_kernel[i], 0.0f);
-        color.a = 1.0f;
-    }
-    else
-    {
-        color =  texture(scene, TexCoords);
-    }
+void main()
+{
+#if defined(CHAOS)
+    color = vec4(convolute(edge_kernel), 1.0);
+#elif defined(CONFUSE)
+    color = vec4(1.0 - texture(scene, TexCoords).rgb, 1.0);
+#elif defined(SHAKE)
+    color = vec4(convolute(blur_kernel), 1.0);
+#else
+    color = texture(scene, TexCoords);
+#endif
 }
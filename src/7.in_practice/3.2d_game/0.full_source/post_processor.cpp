@@ -7,11 +7,15 @@
 ** option) any later version.
 ******************************************************************/
 #include "post_processor.h"
+#include "resource_manager.h"
 
 #include <iostream>
 
-PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height) 
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false)
+// indices of the timed passes
+enum { PASS_RESOLVE = 0, PASS_EFFECTS = 1 };
+
+PostProcessor::PostProcessor(const char *vShaderFile, const char *fShaderFile, unsigned int width, unsigned int height) 
+    : Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false), ResolveTime(0.0f), EffectTime(0.0f), frame(0), effectPass(false), directResolve(false)
 {
     // initialize renderbuffer/framebuffer object
     glGenFramebuffers(1, &this->MSFBO);
@@ -30,35 +34,68 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // attach texture to framebuffer as its color attachment
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
+    // a blit resolving multisamples needs identical formats on both sides, so the scene can only be resolved
+    // straight into the default framebuffer if it has the very same color format as the MS renderbuffer
+    int msSizes[4], defaultSizes[4];
+    const GLenum sizeParameters[4][2] = {
+        { GL_RENDERBUFFER_RED_SIZE, GL_FRAMEBUFFER_ATTACHMENT_RED_SIZE }, { GL_RENDERBUFFER_GREEN_SIZE, GL_FRAMEBUFFER_ATTACHMENT_GREEN_SIZE },
+        { GL_RENDERBUFFER_BLUE_SIZE, GL_FRAMEBUFFER_ATTACHMENT_BLUE_SIZE }, { GL_RENDERBUFFER_ALPHA_SIZE, GL_FRAMEBUFFER_ATTACHMENT_ALPHA_SIZE }
+    };
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    // initialize render data and uniforms
+    int defaultSamples = 0;
+    glGetIntegerv(GL_SAMPLES, &defaultSamples);
+    this->directResolve = defaultSamples == 0;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        glGetRenderbufferParameteriv(GL_RENDERBUFFER, sizeParameters[i][0], &msSizes[i]);
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT, sizeParameters[i][1], &defaultSizes[i]);
+        this->directResolve = this->directResolve && msSizes[i] == defaultSizes[i];
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    // initialize render data
     this->initRenderData();
-    this->PostProcessingShader.SetInteger("scene", 0, true);
-    float offset = 1.0f / 300.0f;
-    float offsets[9][2] = {
-        { -offset,  offset  },  // top-left
-        {  0.0f,    offset  },  // top-center
-        {  offset,  offset  },  // top-right
-        { -offset,  0.0f    },  // center-left
-        {  0.0f,    0.0f    },  // center-center
-        {  offset,  0.0f    },  // center - right
-        { -offset, -offset  },  // bottom-left
-        {  0.0f,   -offset  },  // bottom-center
-        {  offset, -offset  }   // bottom-right    
-    };
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
-    int edge_kernel[9] = {
-        -1, -1, -1,
-        -1,  8, -1,
-        -1, -1, -1
-    };
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
-    float blur_kernel[9] = {
-        1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
-        2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
-        1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
-    };
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);    
+    // compile a shader permutation for each visible combination of effects up-front so toggling an
+    // effect never stalls on a shader compile; the convolution kernels are constants inside the shader
+    for (unsigned int effects = 1; effects < EFFECT_PERMUTATIONS; ++effects)
+    {
+        if ((effects & EFFECT_CHAOS) && (effects & EFFECT_CONFUSE))
+            continue; // chaos overrides confuse, so this combination is never rendered
+        std::string defines;
+        if (effects & EFFECT_CHAOS)
+            defines += "#define CHAOS\n";
+        if (effects & EFFECT_CONFUSE)
+            defines += "#define CONFUSE\n";
+        if (effects & EFFECT_SHAKE)
+            defines += "#define SHAKE\n";
+        std::string name = "postprocessing" + std::to_string(effects);
+        this->permutations[effects] = ResourceManager::LoadShader(vShaderFile, fShaderFile, nullptr, name, defines);
+        this->permutations[effects].SetInteger("scene", 0, true);
+    }
+    // timer queries
+    glGenQueries(4, &this->timerQueries[0][0]);
+    for (unsigned int i = 0; i < 2; ++i)
+        this->timerIssued[i][PASS_RESOLVE] = this->timerIssued[i][PASS_EFFECTS] = false;
+}
+
+PostProcessor::~PostProcessor()
+{
+    glDeleteQueries(4, &this->timerQueries[0][0]);
+    glDeleteFramebuffers(1, &this->MSFBO);
+    glDeleteFramebuffers(1, &this->FBO);
+    glDeleteRenderbuffers(1, &this->RBO);
+    glDeleteVertexArrays(1, &this->VAO);
+}
+
+unsigned int PostProcessor::ActiveEffects() const
+{
+    unsigned int effects = 0;
+    if (this->Chaos)
+        effects |= EFFECT_CHAOS;
+    else if (this->Confuse)
+        effects |= EFFECT_CONFUSE;
+    if (this->Shake)
+        effects |= EFFECT_SHAKE;
+    return effects;
 }
 
 void PostProcessor::BeginRender()
@@ -69,29 +106,90 @@ void PostProcessor::BeginRender()
 }
 void PostProcessor::EndRender()
 {
-    // now resolve multisampled color-buffer into intermediate FBO to store to texture
+    this->readTimers();
+    this->effectPass = this->ActiveEffects() != 0;
+    unsigned int *queries = this->timerQueries[this->frame % 2];
+    glBeginQuery(GL_TIME_ELAPSED, queries[PASS_RESOLVE]);
+    int viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
     glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
-    glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    if (!this->effectPass && this->directResolve && viewport[0] == 0 && viewport[1] == 0
+        && (unsigned int)viewport[2] == this->Width && (unsigned int)viewport[3] == this->Height)
+    {
+        // no effect samples the scene and the default framebuffer matches the MS buffer 1:1, so resolve
+        // directly into it and skip the intermediate texture entirely
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    else
+    {
+        // resolve multisampled color-buffer into intermediate FBO to store to texture
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
+        glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        if (!this->effectPass)
+        {
+            // no effect samples the scene: copy the resolved (single sampled) texture to the viewport, which
+            // may scale and convert formats, instead of running the full-screen pass
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, this->FBO);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, this->Width, this->Height, viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3], GL_COLOR_BUFFER_BIT, (unsigned int)viewport[2] == this->Width && (unsigned int)viewport[3] == this->Height ? GL_NEAREST : GL_LINEAR);
+        }
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    this->timerIssued[this->frame % 2][PASS_RESOLVE] = true;
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
 }
 
 void PostProcessor::Render(float time)
 {
-    // set uniforms/options
-    this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
+    if (!this->effectPass)
+    {
+        ++this->frame; // scene was already presented by EndRender
+        return;
+    }
+    unsigned int *queries = this->timerQueries[this->frame % 2];
+    glBeginQuery(GL_TIME_ELAPSED, queries[PASS_EFFECTS]);
+    // select the permutation of the enabled effects
+    Shader &shader = this->permutations[this->ActiveEffects()];
+    shader.Use();
+    shader.SetFloat("time", time);
     // render textured quad
     glActiveTexture(GL_TEXTURE0);
     this->Texture.Bind();	
     glBindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    glEndQuery(GL_TIME_ELAPSED);
+    this->timerIssued[this->frame % 2][PASS_EFFECTS] = true;
+    ++this->frame;
 }
 
+void PostProcessor::readTimers()
+{
+    // the queries of this slot were issued two frames ago, so their results are almost always available; if
+    // one isn't yet, its result is dropped (the query is reused this frame) rather than waited for
+    unsigned int slot = this->frame % 2;
+    float *times[2] = { &this->ResolveTime, &this->EffectTime };
+    for (unsigned int pass = PASS_RESOLVE; pass <= PASS_EFFECTS; ++pass)
+    {
+        if (this->timerIssued[slot][pass])
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(this->timerQueries[slot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(this->timerQueries[slot][pass], GL_QUERY_RESULT, &elapsed);
+                *times[pass] = elapsed / 1000000.0f;
+            }
+            this->timerIssued[slot][pass] = false;
+        }
+        else if (pass == PASS_EFFECTS)
+        {
+            *times[pass] = 0.0f; // pass was skipped
+        }
+    }
+}
 void PostProcessor::initRenderData()
 {
     // configure VAO/VBO
@@ -9,6 +9,8 @@
 #ifndef POST_PROCESSOR_H
 #define POST_PROCESSOR_H
 
+#include <string>
+
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -17,36 +19,69 @@
 #include "shader.h"
 
 
+// Bit flags of the individual post-processing effects; each combination
+// is compiled into its own shader permutation.
+enum PostProcessingEffect {
+    EFFECT_CHAOS   = 1 << 0,
+    EFFECT_CONFUSE = 1 << 1,
+    EFFECT_SHAKE   = 1 << 2
+};
+const unsigned int EFFECT_PERMUTATIONS = 8;
+
 // PostProcessor hosts all PostProcessing effects for the Breakout
 // Game. It renders the game on a textured quad after which one can
 // enable specific effects by enabling either the Confuse, Chaos or 
 // Shake boolean. 
+// All enabled effects are applied in a single full-screen pass by a
+// shader permutation compiled for exactly that set of effects, so the
+// fragment shader never branches on effect uniforms. When no effect is
+// enabled the full-screen pass is skipped altogether: the multisampled
+// scene is resolved straight into the default framebuffer if that has the
+// same size and format, or else blitted there from the resolved texture.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
 class PostProcessor
 {
 public:
     // state
-    Shader PostProcessingShader;
     Texture2D Texture;
     unsigned int Width, Height;
     // options
     bool Confuse, Chaos, Shake;
-    // constructor
-    PostProcessor(Shader shader, unsigned int width, unsigned int height);
+    // GPU time (in milliseconds) of the MSAA resolve and of the effect pass, as measured a couple of frames ago
+    float ResolveTime, EffectTime;
+    // constructor (compiles all effect permutations of the given shader sources)
+    PostProcessor(const char *vShaderFile, const char *fShaderFile, unsigned int width, unsigned int height);
+    // destructor
+    ~PostProcessor();
     // prepares the postprocessor's framebuffer operations before rendering the game
     void BeginRender();
     // should be called after rendering the game, so it stores all the rendered data into a texture object
+    // (or directly into the default framebuffer if no effect is enabled)
     void EndRender();
     // renders the PostProcessor texture quad (as a screen-encompassing large sprite)
     void Render(float time);
+    // returns the set of effects that is actually visible (Chaos overrides Confuse)
+    unsigned int ActiveEffects() const;
 private:
     // render state
     unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
     unsigned int RBO; // RBO is used for multisampled color buffer
     unsigned int VAO;
+    // one specialized shader per effect combination; index 0 is unused as no pass is required
+    Shader permutations[EFFECT_PERMUTATIONS];
+    // timer queries of the resolve and effect pass, double buffered so we never wait on the GPU
+    unsigned int timerQueries[2][2];
+    bool timerIssued[2][2];
+    unsigned int frame;
+    // whether the effect pass needs to run this frame (decided in EndRender)
+    bool effectPass;
+    // whether the default framebuffer has the MS buffer's color format, so it can be resolved into directly
+    bool directResolve;
     // initialize quad for rendering postprocessing texture
     void initRenderData();
+    // reads back the results of the queries issued two frames ago
+    void readTimers();
 };
 
 #endif
\ No newline at end of file
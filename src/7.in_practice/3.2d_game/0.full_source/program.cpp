@@ -11,8 +11,14 @@
 
 #include "game.h"
 #include "resource_manager.h"
+#include "input_recording.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -25,8 +31,52 @@ const unsigned int SCREEN_HEIGHT = 600;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+// simulation state: the game only advances in fixed ticks of TIMESTEP seconds
+unsigned long long CurrentTick = 0;
+// key events received since the last tick; they're applied at the start of the next one
+std::vector<InputEvent> PendingInput;
+// input of the session (to record) or of a previous session (to replay)
+InputRecording Recording;
+bool Replaying = false;
+
+// applies this tick's input and advances the game by a single fixed step
+void simulateTick();
+
+// Usage: breakout [--seed N] [--record file] [--replay file] [--headless ticks]
+//        breakout --convert-level in.lvl out.blvl
+// --headless runs the simulation (without rendering or audio) as fast as possible
+// for the given number of ticks and reports the tick rate and final state hash.
+// --convert-level converts a text level into the binary level format and exits.
 int main(int argc, char *argv[])
 {
+    if (argc == 4 && std::strcmp(argv[1], "--convert-level") == 0)
+        return GameLevel::Convert(argv[2], argv[3]) ? 0 : -1;
+    const char *recordFile = nullptr;
+    const char *replayFile = nullptr;
+    unsigned long long headlessTicks = 0;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+            Breakout.Seed = static_cast<unsigned int>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (std::strcmp(argv[i], "--record") == 0)
+            recordFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--replay") == 0)
+            replayFile = argv[i + 1];
+        else if (std::strcmp(argv[i], "--headless") == 0)
+            headlessTicks = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    bool headless = headlessTicks > 0;
+    if (replayFile)
+        Replaying = Recording.Load(replayFile);
+    else if (headless)
+    {
+        // without a recording, start the game and launch the ball so there's something to simulate
+        Recording.Record(0, GLFW_KEY_ENTER, true);
+        Recording.Record(1, GLFW_KEY_ENTER, false);
+        Recording.Record(2, GLFW_KEY_SPACE, true);
+        Replaying = true;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -35,6 +85,8 @@ int main(int argc, char *argv[])
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
     glfwWindowHint(GLFW_RESIZABLE, false);
+    // headless runs still need a GL context for loading resources, but never show the window
+    glfwWindowHint(GLFW_VISIBLE, !headless);
 
     GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
     glfwMakeContextCurrent(window);
@@ -58,39 +110,55 @@ int main(int argc, char *argv[])
 
     // initialize game
     // ---------------
-    Breakout.Init();
+    Breakout.Init(headless);
 
-    // deltaTime variables
-    // -------------------
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    if (headless)
+    {
+        // simulate as fast as possible
+        // ----------------------------
+        double start = glfwGetTime();
+        while (CurrentTick < headlessTicks)
+            simulateTick();
+        double elapsed = glfwGetTime() - start;
+        std::cout << "simulated " << CurrentTick << " ticks in " << elapsed << "s (" << CurrentTick / elapsed << " ticks/s)" << std::endl;
+        std::cout << "state hash: " << std::hex << Breakout.StateHash() << std::dec << std::endl;
+    }
+
+    // frame timing variables
+    // ----------------------
+    double lastFrame = glfwGetTime();
+    double accumulator = 0.0;
 
-    while (!glfwWindowShouldClose(window))
+    while (!headless && !glfwWindowShouldClose(window))
     {
-        // calculate delta time
-        // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        // accumulate elapsed time; clamped so a long stall (e.g. dragging the window) doesn't
+        // make us simulate a huge number of ticks at once
+        // ------------------------------------------------------------------------------------
+        double currentFrame = glfwGetTime();
+        accumulator += std::min(currentFrame - lastFrame, 0.25);
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
-
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // manage user input and update game state in fixed steps
+        // ------------------------------------------------------
+        while (accumulator >= TIMESTEP)
+        {
+            simulateTick();
+            accumulator -= TIMESTEP;
+        }
 
-        // render
-        // ------
+        // render, interpolating between the last two ticks
+        // ------------------------------------------------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        Breakout.Render(static_cast<float>(accumulator / TIMESTEP));
 
         glfwSwapBuffers(window);
     }
 
+    if (recordFile)
+        Recording.Save(recordFile);
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
     ResourceManager::Clear();
@@ -104,16 +172,40 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
-    if (key >= 0 && key < 1024)
+    // F1 toggles the post-processing timings; it's not part of the simulation so it isn't recorded
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+    {
+        Breakout.ShowTimings = !Breakout.ShowTimings;
+        return;
+    }
+    // queue the event so it's applied at a tick boundary (and can be recorded as such)
+    if (key >= 0 && key < 1024 && (action == GLFW_PRESS || action == GLFW_RELEASE))
+    {
+        InputEvent event = { 0, key, action == GLFW_PRESS };
+        PendingInput.push_back(event);
+    }
+}
+
+void simulateTick()
+{
+    if (Replaying)
+    {
+        // live input is ignored while replaying
+        InputEvent event;
+        while (Recording.Next(CurrentTick, event))
+            Breakout.SetKey(event.Key, event.Pressed);
+    }
+    else
     {
-        if (action == GLFW_PRESS)
-            Breakout.Keys[key] = true;
-        else if (action == GLFW_RELEASE)
+        for (const InputEvent &event : PendingInput)
         {
-            Breakout.Keys[key] = false;
-            Breakout.KeysProcessed[key] = false;
+            Breakout.SetKey(event.Key, event.Pressed);
+            Recording.Record(CurrentTick, event.Key, event.Pressed);
         }
     }
+    PendingInput.clear();
+    Breakout.Tick(TIMESTEP);
+    ++CurrentTick;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
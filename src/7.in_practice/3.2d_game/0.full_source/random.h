@@ -0,0 +1,44 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef RANDOM_H
+#define RANDOM_H
+
+
+// Small seedable pseudo random number generator (xorshift32). Each
+// system that needs randomness owns its own generator so a given
+// seed always produces the same sequence, independent of how often
+// other systems draw numbers; this keeps simulations reproducible.
+class Random
+{
+public:
+    // constructor
+    explicit Random(unsigned int seed = 1) { this->Seed(seed); }
+    // restarts the sequence from the given seed
+    void Seed(unsigned int seed)
+    {
+        // scramble the seed so nearby seeds give unrelated sequences; xorshift needs a non-zero state
+        this->state = seed * 2654435761u ^ 0x9E3779B9u;
+        if (this->state == 0)
+            this->state = 0x9E3779B9u;
+    }
+    // returns the next number in the sequence
+    unsigned int Next()
+    {
+        this->state ^= this->state << 13;
+        this->state ^= this->state >> 17;
+        this->state ^= this->state << 5;
+        return this->state;
+    }
+    // returns a number in [0, bound)
+    unsigned int Next(unsigned int bound) { return this->Next() % bound; }
+private:
+    unsigned int state;
+};
+
+#endif
\ No newline at end of file
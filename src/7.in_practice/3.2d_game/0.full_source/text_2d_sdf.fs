@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 TexCoords;
+in vec3 TextColor;
+out vec4 color;
+
+uniform sampler2D text;
+
+void main()
+{    
+    // the atlas stores signed distances with the outline at 0.5; smooth over about one screen pixel
+    float distance = texture(text, TexCoords).r;
+    float width = fwidth(distance) * 0.75;
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color = vec4(TextColor, alpha);
+}
\ No newline at end of file
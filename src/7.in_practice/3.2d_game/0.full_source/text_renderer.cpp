@@ -12,129 +12,321 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <learnopengl/sdf_font.h>
+
 #include "text_renderer.h"
 #include "resource_manager.h"
 
+// dimensions of the glyph atlas texture
+const unsigned int ATLAS_SIZE = 1024;
+// padding between glyphs in the atlas to avoid bleeding when sampling with linear filtering
+const unsigned int ATLAS_PADDING = 1;
+// number of floats per text vertex: <vec2 pos, vec2 tex, vec3 color>
+const unsigned int VERTEX_FLOATS = 7;
+// upper bound on the number of cached shaped strings before the cache is flushed
+const unsigned int MAX_SHAPED_RUNS = 256;
+
+// decodes the next codepoint of a UTF-8 string and advances the iterator (invalid bytes decode as '?')
+unsigned int nextCodepoint(std::string::const_iterator &it, std::string::const_iterator end);
+
 
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+    : bufferCapacity(0), batching(false), ft(nullptr), face(nullptr), penX(0), penY(0), rowHeight(0), lineTop(0), sdf(nullptr), unitScale(1.0f)
 {
-    // load and configure shader
+    // load and configure shaders
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f);
     this->TextShader = ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text");
-    this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
+    this->TextShader.SetMatrix4("projection", projection, true);
     this->TextShader.SetInteger("text", 0);
-    // configure VAO/VBO for texture quads
+    Shader sdfShader = ResourceManager::LoadShader("text_2d.vs", "text_2d_sdf.fs", nullptr, "text_sdf");
+    sdfShader.SetMatrix4("projection", projection, true);
+    sdfShader.SetInteger("text", 0);
+    // configure VAO/VBO for texture quads; the buffer is (re)allocated on demand when flushing
     glGenVertexArrays(1, &this->VAO);
     glGenBuffers(1, &this->VBO);
     glBindVertexArray(this->VAO);
     glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_FLOATS * sizeof(float), (void*)(4 * sizeof(float)));
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
+    // configure the (single channel) glyph atlas
+    this->Atlas.Internal_Format = GL_RED;
+    this->Atlas.Image_Format = GL_RED;
+    this->Atlas.Wrap_S = GL_CLAMP_TO_EDGE;
+    this->Atlas.Wrap_T = GL_CLAMP_TO_EDGE;
 }
 
-void TextRenderer::Load(std::string font, unsigned int fontSize)
+TextRenderer::~TextRenderer()
+{
+    this->unload();
+    if (this->ft)
+        FT_Done_FreeType(this->ft);
+}
+
+void TextRenderer::unload()
 {
-    // first clear the previously loaded Characters
     this->Characters.clear();
-    // then initialize and load the FreeType library
-    FT_Library ft;    
-    if (FT_Init_FreeType(&ft)) // all functions return a value different than 0 whenever an error occurred
+    this->ExtendedCharacters.clear();
+    this->shapedRuns.clear();
+    this->penX = this->penY = this->rowHeight = 0;
+    if (this->face)
+        FT_Done_Face(this->face);
+    this->face = nullptr;
+    delete this->sdf;
+    this->sdf = nullptr;
+}
+
+void TextRenderer::Load(std::string font, unsigned int fontSize)
+{
+    // first clear the previously loaded Characters and any state depending on them
+    this->unload();
+    this->TextShader = ResourceManager::GetShader("text");
+    this->unitScale = 1.0f;
+    // then initialize and load the FreeType library; it stays alive for lazily loaded glyphs
+    if (!this->ft && FT_Init_FreeType(&this->ft)) // all functions return a value different than 0 whenever an error occurred
+    {
         std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        this->ft = nullptr;
+        return;
+    }
     // load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, font.c_str(), 0, &face))
+    if (FT_New_Face(this->ft, font.c_str(), 0, &this->face))
+    {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        this->face = nullptr;
+        return;
+    }
     // set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
-    // disable byte-alignment restriction
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); 
+    FT_Set_Pixel_Sizes(this->face, 0, fontSize);
+    // allocate an empty atlas; glyphs are copied into it as they're loaded
+    std::vector<unsigned char> empty(ATLAS_SIZE * ATLAS_SIZE, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->Atlas.Generate(ATLAS_SIZE, ATLAS_SIZE, empty.data());
     // then for the first 128 ASCII characters, pre-load/compile their characters and store them
-    for (GLubyte c = 0; c < 128; c++) // lol see what I did there 
+    this->Characters.reserve(128);
+    for (unsigned int c = 0; c < 128; c++)
+        this->Characters.push_back(this->loadCharacter(c));
+    this->lineTop = this->Characters['H'].Bearing.y;
+}
+
+void TextRenderer::LoadSDF(std::string font, unsigned int fontSize, std::string cachePath)
+{
+    this->unload();
+    this->TextShader = ResourceManager::GetShader("text_sdf");
+    // generate (or load from cache) the distance fields of the ASCII range
+    this->sdf = new SDFFont();
+    if (!this->sdf->Load(font, 0, 128, cachePath))
+        return;
+    this->unitScale = static_cast<float>(fontSize) / this->sdf->GlyphSize;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->Atlas.Generate(this->sdf->AtlasSize, this->sdf->AtlasSize, this->sdf->Pixels.data());
+    // then build the flat ASCII table from the generated glyphs
+    this->Characters.assign(128, Character{ glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 });
+    float atlasSize = static_cast<float>(this->sdf->AtlasSize);
+    for (const SDFGlyph &glyph : this->sdf->Glyphs)
     {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-            continue;
-        }
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-            );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-       
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
+        Character &ch = this->Characters[glyph.Codepoint];
+        ch.UVMin = glm::vec2(glyph.Offset) / atlasSize;
+        ch.UVMax = glm::vec2(glyph.Offset + glyph.Size) / atlasSize;
+        ch.Size = glyph.Size;
+        ch.Bearing = glyph.Bearing;
+        ch.Advance = glyph.Advance;
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
-    // destroy FreeType once we're finished
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    // the fields include a border of Spread pixels, which shouldn't offset the line
+    this->lineTop = this->Characters['H'].Bearing.y - static_cast<int>(this->sdf->Spread);
 }
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
-    // activate corresponding render state	
+    // append the (cached) shaped string to the pending vertices
+    scale *= this->unitScale;
+    for (const GlyphQuad &quad : this->shape(text))
+    {
+        float xpos = x + quad.Position.x * scale;
+        float ypos = y + quad.Position.y * scale;
+        float w = quad.Size.x * scale;
+        float h = quad.Size.y * scale;
+        float quadVertices[6][VERTEX_FLOATS] = {
+            { xpos,     ypos + h,   quad.UVMin.x, quad.UVMax.y, color.r, color.g, color.b },
+            { xpos + w, ypos,       quad.UVMax.x, quad.UVMin.y, color.r, color.g, color.b },
+            { xpos,     ypos,       quad.UVMin.x, quad.UVMin.y, color.r, color.g, color.b },
+
+            { xpos,     ypos + h,   quad.UVMin.x, quad.UVMax.y, color.r, color.g, color.b },
+            { xpos + w, ypos + h,   quad.UVMax.x, quad.UVMax.y, color.r, color.g, color.b },
+            { xpos + w, ypos,       quad.UVMax.x, quad.UVMin.y, color.r, color.g, color.b }
+        };
+        this->vertices.insert(this->vertices.end(), &quadVertices[0][0], &quadVertices[0][0] + 6 * VERTEX_FLOATS);
+    }
+    if (!this->batching)
+        this->flush();
+}
+
+void TextRenderer::BeginBatch()
+{
+    this->batching = true;
+}
+
+void TextRenderer::EndBatch()
+{
+    this->batching = false;
+    this->flush();
+}
+
+void TextRenderer::flush()
+{
+    if (this->vertices.empty())
+        return;
+    unsigned int vertexCount = static_cast<unsigned int>(this->vertices.size() / VERTEX_FLOATS);
+    // activate corresponding render state
     this->TextShader.Use();
-    this->TextShader.SetVector3f("textColor", color);
     glActiveTexture(GL_TEXTURE0);
+    this->Atlas.Bind();
     glBindVertexArray(this->VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
+    // orphan the previous buffer storage so we don't stall on a draw still using it; grow if required
+    if (vertexCount > this->bufferCapacity)
+        this->bufferCapacity = vertexCount * 2;
+    glBufferData(GL_ARRAY_BUFFER, this->bufferCapacity * VERTEX_FLOATS * sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, this->vertices.size() * sizeof(float), this->vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // render all glyph quads in one go
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->vertices.clear();
+}
 
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
+const std::vector<GlyphQuad> &TextRenderer::shape(const std::string &text)
+{
+    auto it = this->shapedRuns.find(text);
+    if (it != this->shapedRuns.end())
+        return it->second;
+    // dynamic strings (e.g. counters) would otherwise grow the cache without bound
+    if (this->shapedRuns.size() >= MAX_SHAPED_RUNS)
+        this->shapedRuns.clear();
+    std::vector<GlyphQuad> &quads = this->shapedRuns[text];
+    quads.reserve(text.size());
+    float x = 0.0f;
+    std::string::const_iterator c = text.begin();
+    while (c != text.end())
     {
-        Character ch = Characters[*c];
-
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
-
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
-
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        const Character &ch = this->getCharacter(nextCodepoint(c, text.end()));
+        if (ch.Size.x > 0 && ch.Size.y > 0)
+        {
+            GlyphQuad quad;
+            quad.Position = glm::vec2(x + ch.Bearing.x, static_cast<float>(this->lineTop - ch.Bearing.y));
+            quad.Size = glm::vec2(ch.Size);
+            quad.UVMin = ch.UVMin;
+            quad.UVMax = ch.UVMax;
+            quads.push_back(quad);
+        }
         // now advance cursors for next glyph
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+        x += (ch.Advance >> 6); // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
     }
-    glBindVertexArray(0);
+    return quads;
+}
+
+const Character &TextRenderer::getCharacter(unsigned int codepoint)
+{
+    if (codepoint < this->Characters.size())
+        return this->Characters[codepoint];
+    auto it = this->ExtendedCharacters.find(codepoint);
+    if (it == this->ExtendedCharacters.end())
+    {
+        Character ch = this->sdf ? this->loadSDFCharacter(codepoint) : this->loadCharacter(codepoint);
+        it = this->ExtendedCharacters.insert(std::make_pair(codepoint, ch)).first;
+    }
+    return it->second;
+}
+
+Character TextRenderer::loadCharacter(unsigned int codepoint)
+{
+    Character character = { glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+    // load character glyph
+    if (!this->face || FT_Load_Char(this->face, codepoint, FT_LOAD_RENDER))
+    {
+        std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+        return character;
+    }
+    FT_GlyphSlot glyph = this->face->glyph;
+    unsigned int width = glyph->bitmap.width;
+    unsigned int rows = glyph->bitmap.rows;
+    character.Size = glm::ivec2(width, rows);
+    character.Bearing = glm::ivec2(glyph->bitmap_left, glyph->bitmap_top);
+    character.Advance = static_cast<unsigned int>(glyph->advance.x);
+    if (width == 0 || rows == 0)
+        return character;
+    // find a spot for the glyph: move to the next shelf if it doesn't fit on the current one
+    if (this->penX + width + ATLAS_PADDING > ATLAS_SIZE)
+    {
+        this->penX = 0;
+        this->penY += this->rowHeight + ATLAS_PADDING;
+        this->rowHeight = 0;
+    }
+    if (this->penY + rows > ATLAS_SIZE)
+    {
+        std::cout << "ERROR::TEXTRENDERER: Glyph atlas is full" << std::endl;
+        character.Size = glm::ivec2(0);
+        return character;
+    }
+    // copy the glyph bitmap into the atlas
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    this->Atlas.Bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, this->penX, this->penY, width, rows, GL_RED, GL_UNSIGNED_BYTE, glyph->bitmap.buffer);
     glBindTexture(GL_TEXTURE_2D, 0);
-}
\ No newline at end of file
+    character.UVMin = glm::vec2(this->penX, this->penY) / static_cast<float>(ATLAS_SIZE);
+    character.UVMax = glm::vec2(this->penX + width, this->penY + rows) / static_cast<float>(ATLAS_SIZE);
+    this->penX += width + ATLAS_PADDING;
+    if (rows > this->rowHeight)
+        this->rowHeight = rows;
+    return character;
+}
+
+Character TextRenderer::loadSDFCharacter(unsigned int codepoint)
+{
+    Character character = { glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0 };
+    SDFGlyph glyph;
+    if (!this->sdf->AddGlyph(codepoint, glyph))
+        return character;
+    character.Size = glyph.Size;
+    character.Bearing = glyph.Bearing;
+    character.Advance = glyph.Advance;
+    if (glyph.Size.x == 0 || glyph.Size.y == 0)
+        return character;
+    // copy the glyph's region of the CPU side atlas into the texture
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, this->sdf->AtlasSize);
+    this->Atlas.Bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, glyph.Offset.x, glyph.Offset.y, glyph.Size.x, glyph.Size.y, GL_RED, GL_UNSIGNED_BYTE,
+        &this->sdf->Pixels[glyph.Offset.y * this->sdf->AtlasSize + glyph.Offset.x]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    float atlasSize = static_cast<float>(this->sdf->AtlasSize);
+    character.UVMin = glm::vec2(glyph.Offset) / atlasSize;
+    character.UVMax = glm::vec2(glyph.Offset + glyph.Size) / atlasSize;
+    return character;
+}
+
+unsigned int nextCodepoint(std::string::const_iterator &it, std::string::const_iterator end)
+{
+    unsigned char lead = static_cast<unsigned char>(*it++);
+    unsigned int codepoint;
+    int continuation;
+    if (lead < 0x80)
+        return lead;
+    else if ((lead & 0xE0) == 0xC0) { codepoint = lead & 0x1F; continuation = 1; }
+    else if ((lead & 0xF0) == 0xE0) { codepoint = lead & 0x0F; continuation = 2; }
+    else if ((lead & 0xF8) == 0xF0) { codepoint = lead & 0x07; continuation = 3; }
+    else
+        return '?';
+    for (int i = 0; i < continuation; ++i)
+    {
+        if (it == end || (static_cast<unsigned char>(*it) & 0xC0) != 0x80)
+            return '?';
+        codepoint = (codepoint << 6) | (static_cast<unsigned char>(*it++) & 0x3F);
+    }
+    return codepoint;
+}
@@ -9,7 +9,9 @@
 #ifndef TEXT_RENDERER_H
 #define TEXT_RENDERER_H
 
-#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -17,35 +19,93 @@
 #include "texture.h"
 #include "shader.h"
 
+// forward declarations of the FreeType handles so we don't leak ft2build.h into every includer
+struct FT_LibraryRec_;
+struct FT_FaceRec_;
+class SDFFont;
+
 
 /// Holds all state information relevant to a character as loaded using FreeType
 struct Character {
-    unsigned int TextureID; // ID handle of the glyph texture
+    glm::vec2    UVMin;     // top-left texture coordinate of the glyph inside the atlas
+    glm::vec2    UVMax;     // bottom-right texture coordinate of the glyph inside the atlas
     glm::ivec2   Size;      // size of glyph
     glm::ivec2   Bearing;   // offset from baseline to left/top of glyph
     unsigned int Advance;   // horizontal offset to advance to next glyph
 };
 
+/// A single positioned glyph quad of a shaped string, relative to the string origin at scale 1
+struct GlyphQuad {
+    glm::vec2 Position;
+    glm::vec2 Size;
+    glm::vec2 UVMin;
+    glm::vec2 UVMax;
+};
+
 
-// A renderer class for rendering text displayed by a font loaded using the 
-// FreeType library. A single font is loaded, processed into a list of Character
-// items for later rendering.
+// A renderer class for rendering text displayed by a font loaded using the
+// FreeType library. All glyphs are packed into a single atlas texture; the
+// ASCII range is kept in a flat table and any other codepoint is rasterized
+// into the atlas the first time it is encountered. Shaped strings are cached
+// so static text (e.g. HUD labels) is only laid out once and every string (or
+// batch of strings) is submitted with a single draw call.
+// Alternatively the font can be loaded as signed distance fields (LoadSDF) in
+// which case a single, smaller atlas renders sharp text at any scale.
 class TextRenderer
 {
 public:
-    // holds a list of pre-compiled Characters
-    std::map<char, Character> Characters; 
+    // flat table of the first 128 (ASCII) characters, indexed by codepoint
+    std::vector<Character> Characters;
+    // lazily loaded characters outside of the ASCII range
+    std::unordered_map<unsigned int, Character> ExtendedCharacters;
+    // single texture holding all rasterized glyphs
+    Texture2D Atlas;
     // shader used for text rendering
     Shader TextShader;
-    // constructor
+    // constructor/destructor
     TextRenderer(unsigned int width, unsigned int height);
-    // pre-compiles a list of characters from the given font
+    ~TextRenderer();
+    // pre-compiles the ASCII characters from the given font into the atlas
     void Load(std::string font, unsigned int fontSize);
-    // renders a string of text using the precompiled list of characters
+    // same as Load, but stores the characters as distance fields (cached on disk at cachePath);
+    // text rendered at scale 1 has the same size as text from a font loaded at fontSize
+    void LoadSDF(std::string font, unsigned int fontSize, std::string cachePath);
+    // renders a (UTF-8) string of text; drawn directly unless a batch is active
     void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+    // collects all RenderText calls until EndBatch so they are drawn with a single draw call
+    void BeginBatch();
+    void EndBatch();
 private:
     // render state
     unsigned int VAO, VBO;
+    unsigned int bufferCapacity; // size of VBO in vertices
+    std::vector<float> vertices; // pending <vec2 pos, vec2 tex, vec3 color> vertices
+    bool batching;
+    // FreeType state kept alive for lazily loaded glyphs
+    FT_LibraryRec_ *ft;
+    FT_FaceRec_    *face;
+    // atlas packing state (simple shelf packer)
+    unsigned int penX, penY, rowHeight;
+    // bearing of 'H', used to align text to the top of its line
+    int lineTop;
+    // distance field glyph source, only set when loaded through LoadSDF
+    SDFFont *sdf;
+    // scale from glyph units to the requested font size (differs from 1 for distance fields)
+    float unitScale;
+    // cache of shaped strings
+    std::unordered_map<std::string, std::vector<GlyphQuad>> shapedRuns;
+    // returns the character for the given codepoint, loading it into the atlas if required
+    const Character &getCharacter(unsigned int codepoint);
+    // rasterizes a single codepoint with FreeType and packs it into the atlas
+    Character loadCharacter(unsigned int codepoint);
+    // generates the distance field of a single codepoint and copies it into the atlas
+    Character loadSDFCharacter(unsigned int codepoint);
+    // releases the FreeType/distance field state of the previously loaded font
+    void unload();
+    // lays out a string at scale 1 relative to its origin (cached)
+    const std::vector<GlyphQuad> &shape(const std::string &text);
+    // uploads all pending vertices and draws them
+    void flush();
 };
 
-#endif 
\ No newline at end of file
+#endif
@@ -9,6 +9,10 @@ layout (binding = 0) uniform sampler2D accum;
 // revealage threshold buffer
 layout (binding = 1) uniform sampler2D reveal;
 
+// accumulated weight buffer of the packed targets, whose accumulation buffer has no alpha channel
+layout (binding = 2) uniform sampler2D accum_weight;
+uniform bool packed_targets;
+
 // epsilon number
 const float EPSILON = 0.00001f;
 
@@ -38,6 +42,8 @@ void main()
  
 	// fragment color
 	vec4 accumulation = texelFetch(accum, coords, 0);
+	if (packed_targets)
+		accumulation.a = texelFetch(accum_weight, coords, 0).r;
 	
 	// suppress overflow
 	if (isinf(max3(abs(accumulation.rgb)))) 
@@ -0,0 +1,26 @@
+#version 420 core
+
+// shader inputs
+layout (location = 0) in vec3 position;
+
+// screen tiles containing transparent fragments, one instance is drawn per tile
+layout (binding = 3) uniform usampler2D tile_mask;
+uniform int tile_size;
+uniform vec2 screen_size;
+
+void main()
+{
+	ivec2 tiles = textureSize(tile_mask, 0);
+	ivec2 tile = ivec2(gl_InstanceID % tiles.x, gl_InstanceID / tiles.x);
+
+	// tiles without transparent fragments collapse to a point outside the screen, so they're never rasterized
+	if (texelFetch(tile_mask, tile, 0).r == 0u)
+	{
+		gl_Position = vec4(-2.0f, -2.0f, 0.0f, 1.0f);
+		return;
+	}
+
+	// the screen quad's corner, scaled to the tile; the last row and column of tiles are cut off at the screen's edge
+	vec2 pixel = (vec2(tile) + position.xy * 0.5f + 0.5f) * float(tile_size);
+	gl_Position = vec4(min(pixel / screen_size, vec2(1.0f)) * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,38 @@
+#version 430 core
+
+// the opaque depth is tested before the shader runs, so hidden transparent fragments never take a node
+layout (early_fragment_tests) in;
+
+// material color
+uniform vec4 color;
+
+// a node of a pixel's fragment list, 12 bytes
+struct Node
+{
+	uint color; // unorm RGBA8
+	float depth;
+	uint next;  // 0xFFFFFFFF ends the list
+};
+
+// pool of list nodes, allocated by the counter
+layout (std430, binding = 0) writeonly buffer Nodes
+{
+	Node nodes[];
+};
+layout (binding = 0, offset = 0) uniform atomic_uint node_counter;
+uniform uint max_nodes;
+
+// index of the first node of each pixel's list
+layout (r32ui, binding = 1) uniform coherent uimage2D head_pointers;
+
+void main()
+{
+	// the counter keeps counting past a full pool, so the dropped fragments can be reported
+	uint index = atomicCounterIncrement(node_counter);
+	if (index >= max_nodes)
+		return;
+
+	// push the fragment to the front of its pixel's list
+	uint next = imageAtomicExchange(head_pointers, ivec2(gl_FragCoord.xy), index);
+	nodes[index] = Node(packUnorm4x8(color), gl_FragCoord.z, next);
+}
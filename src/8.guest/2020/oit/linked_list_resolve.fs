@@ -0,0 +1,78 @@
+#version 430 core
+
+// shader outputs
+layout (location = 0) out vec4 frag;
+
+// a node of a pixel's fragment list
+struct Node
+{
+	uint color;
+	float depth;
+	uint next;
+};
+
+layout (std430, binding = 0) readonly buffer Nodes
+{
+	Node nodes[];
+};
+
+// pixels with more fragments than fit the sort
+layout (binding = 0, offset = 4) uniform atomic_uint truncated_pixels;
+
+layout (r32ui, binding = 1) uniform readonly uimage2D head_pointers;
+
+// fragments sorted per pixel; beyond that only the nearest ones are kept
+const int MAX_FRAGMENTS = 16;
+
+void main()
+{
+	uint index = imageLoad(head_pointers, ivec2(gl_FragCoord.xy)).r;
+
+	// save the blending cost if there is not a transparent fragment
+	if (index == 0xFFFFFFFFu)
+		discard;
+
+	// insertion sort of the list by depth, into arrays small enough to stay in registers
+	uint colors[MAX_FRAGMENTS];
+	float depths[MAX_FRAGMENTS];
+	int count = 0;
+	bool truncated = false;
+	while (index != 0xFFFFFFFFu)
+	{
+		Node node = nodes[index];
+		index = node.next;
+
+		// arrays full: drop the farthest fragment, unless the new one is farther still
+		if (count == MAX_FRAGMENTS)
+		{
+			truncated = true;
+			if (node.depth >= depths[MAX_FRAGMENTS - 1])
+				continue;
+			count--;
+		}
+
+		int i = count;
+		while (i > 0 && depths[i - 1] > node.depth)
+		{
+			depths[i] = depths[i - 1];
+			colors[i] = colors[i - 1];
+			i--;
+		}
+		depths[i] = node.depth;
+		colors[i] = node.color;
+		count++;
+	}
+	if (truncated)
+		atomicCounterIncrement(truncated_pixels);
+
+	// blend front to back; the result is premultiplied, so it's blended over the opaque image with (ONE, ONE_MINUS_SRC_ALPHA)
+	vec3 color = vec3(0.0f);
+	float transmittance = 1.0f;
+	for (int i = 0; i < count; i++)
+	{
+		vec4 fragment = unpackUnorm4x8(colors[i]);
+		color += transmittance * fragment.a * fragment.rgb;
+		transmittance *= 1.0f - fragment.a;
+	}
+	frag = vec4(color, 1.0f - transmittance);
+}
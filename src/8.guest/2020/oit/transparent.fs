@@ -1,12 +1,23 @@
 #version 420 core
 
+// the opaque depth is tested before the shader runs, so hidden transparent fragments are never shaded and
+// never mark their tile (image stores would otherwise force the depth test after the shader)
+layout (early_fragment_tests) in;
+
 // shader outputs
 layout (location = 0) out vec4 accum;
 layout (location = 1) out float reveal;
+// accumulated weight, only written to when the packed targets are bound (accum has no alpha then)
+layout (location = 2) out float accum_weight;
 
 // material color
 uniform vec4 color;
 
+// screen tiles containing transparent fragments
+layout (r8ui, binding = 0) uniform writeonly uimage2D tile_mask;
+uniform bool mark_tiles;
+uniform int tile_size;
+
 void main()
 {
 	// weight function
@@ -14,7 +25,12 @@ void main()
 	
 	// store pixel color accumulation
 	accum = vec4(color.rgb * color.a, color.a) * weight;
+	accum_weight = color.a * weight;
 	
 	// store pixel revealage threshold
 	reveal = color.a;
-}
\ No newline at end of file
+
+	// mark the tile for the composite pass
+	if (mark_tiles)
+		imageStore(tile_mask, ivec2(gl_FragCoord.xy) / tile_size, uvec4(1u));
+}
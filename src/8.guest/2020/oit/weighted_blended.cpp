@@ -9,6 +9,8 @@
 #include <learnopengl/camera.h>
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -16,6 +18,20 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void process_input(GLFWwindow *window);
 glm::mat4 calculate_model_matrix(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f));
 
+// accumulation targets of the transparent pass
+// full: RGBA16F accumulation (color and weight) + R8 revealage, 9 bytes per pixel
+// packed: R11G11B10F accumulated color + R16F accumulated weight + R8 revealage, 7 bytes per pixel
+struct TransparentTargets
+{
+	unsigned int fbo;
+	unsigned int accumTexture;
+	unsigned int weightTexture; // 0 for the full targets, their weight is in the accumulation's alpha
+	unsigned int revealTexture;
+	unsigned int bytesPerPixel;
+};
+TransparentTargets create_transparent_targets(bool packed, unsigned int depthTexture);
+void delete_transparent_targets(TransparentTargets& targets);
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -30,13 +46,34 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// transparency settings
+// composite only the screen tiles the transparent pass touched
+const int TILE_SIZE = 16;
+bool tiledComposite = true;
+bool tiledCompositeKeyPressed = false;
+// packed accumulation targets
+bool packedTargets = true;
+bool packedTargetsKeyPressed = false;
+// a field of overlapping transparent quads, partly behind an opaque wall
+bool stressScene = false;
+bool stressSceneKeyPressed = false;
+// times all combinations of the settings
+bool benchmarkOIT = false;
+bool benchmarkKeyPressed = false;
+// exact transparency from per-pixel fragment lists instead of weighted blended
+bool linkedLists = false;
+bool linkedListsKeyPressed = false;
+// times both techniques at increasing depth complexity
+bool benchmarkDepthComplexity = false;
+bool depthComplexityKeyPressed = false;
+
 int main(int argc, char* argv[])
 {
 	// glfw: initialize and configure
 	// ------------------------------
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // the linked lists' storage buffer requires OpenGL 4.3
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 	#ifdef __APPLE__
@@ -73,6 +110,9 @@ int main(int argc, char* argv[])
 	Shader solidShader("solid.vs", "solid.fs");
 	Shader transparentShader("transparent.vs", "transparent.fs");
 	Shader compositeShader("composite.vs", "composite.fs");
+	Shader tiledCompositeShader("composite_tiled.vs", "composite.fs");
+	Shader linkedListBuildShader("transparent.vs", "linked_list_build.fs");
+	Shader linkedListResolveShader("composite.vs", "linked_list_resolve.fs");
 	Shader screenShader("screen.vs", "screen.fs");
 
 	// set up vertex data (and buffer(s)) and configure vertex attributes
@@ -103,9 +143,8 @@ int main(int argc, char* argv[])
 
 	// set up framebuffers and their texture attachments
 	// ------------------------------------------------------------------
-	unsigned int opaqueFBO, transparentFBO;
+	unsigned int opaqueFBO;
 	glGenFramebuffers(1, &opaqueFBO);
-	glGenFramebuffers(1, &transparentFBO);
 
 	// set up attachments for opaque framebuffer
 	unsigned int opaqueTexture;
@@ -131,46 +170,294 @@ int main(int argc, char* argv[])
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	// set up attachments for transparent framebuffer
-	unsigned int accumTexture;
-	glGenTextures(1, &accumTexture);
-	glBindTexture(GL_TEXTURE_2D, accumTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// set up both kinds of transparent framebuffers, they share the opaque framebuffer's depth texture
+	TransparentTargets fullTargets = create_transparent_targets(false, depthTexture);
+	TransparentTargets packedTransparentTargets = create_transparent_targets(true, depthTexture);
+
+	// set up the tile mask: one texel per screen tile, set by the transparent pass
+	const int tilesX = (SCR_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+	const int tilesY = (SCR_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+	unsigned int tileMaskTexture;
+	glGenTextures(1, &tileMaskTexture);
+	glBindTexture(GL_TEXTURE_2D, tileMaskTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, tilesX, tilesY);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	unsigned int revealTexture;
-	glGenTextures(1, &revealTexture);
-	glBindTexture(GL_TEXTURE_2D, revealTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, SCR_WIDTH, SCR_HEIGHT, 0, GL_RED, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// the tile mask is cleared through a framebuffer
+	unsigned int tileMaskFBO;
+	glGenFramebuffers(1, &tileMaskFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, tileMaskFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tileMaskTexture, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Tile mask framebuffer is not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// set up the fragment lists: a head pointer per pixel and a fixed pool of nodes for all pixels
+	const unsigned int LIST_NODE_SIZE = 12; // color, depth and next index
+	const unsigned int maxListNodes = SCR_WIDTH * SCR_HEIGHT * 8; // 8 fragments per pixel on average
+	unsigned int headPointerTexture;
+	glGenTextures(1, &headPointerTexture);
+	glBindTexture(GL_TEXTURE_2D, headPointerTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, SCR_WIDTH, SCR_HEIGHT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, transparentFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumTexture, 0);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, revealTexture, 0);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0); // opaque framebuffer's depth texture
+	// the head pointers are cleared through a framebuffer
+	unsigned int headPointerFBO;
+	glGenFramebuffers(1, &headPointerFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, headPointerFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, headPointerTexture, 0);
 
-	const GLenum transparentDrawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-	glDrawBuffers(2, transparentDrawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Head pointer framebuffer is not complete!" << std::endl;
+
+	// the lists are built with the opaque depth only, the fragments go to the storage buffer
+	unsigned int linkedListFBO;
+	glGenFramebuffers(1, &linkedListFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, linkedListFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0); // opaque framebuffer's depth texture
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "ERROR::FRAMEBUFFER:: Transparent framebuffer is not complete!" << std::endl;
+		std::cout << "ERROR::FRAMEBUFFER:: Linked list framebuffer is not complete!" << std::endl;
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	unsigned int listNodeBuffer;
+	glGenBuffers(1, &listNodeBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, listNodeBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)maxListNodes * LIST_NODE_SIZE, NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// counters: allocated nodes (past maxListNodes on overflow) and pixels with more fragments than the resolve sorts
+	const GLuint zeroCounters[2] = { 0, 0 };
+	unsigned int listCounterBuffer;
+	glGenBuffers(1, &listCounterBuffer);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, listCounterBuffer);
+	glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(zeroCounters), zeroCounters, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+	linkedListBuildShader.use();
+	glUniform1ui(glGetUniformLocation(linkedListBuildShader.ID, "max_nodes"), maxListNodes);
+
 	// set up transformation matrices
 	// ------------------------------------------------------------------
 	glm::mat4 redModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 1.0f));
 	glm::mat4 greenModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 0.0f));
 	glm::mat4 blueModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 2.0f));
 
+	// stress scene: layers of overlapping glass and foliage like quads, and an opaque wall hiding the left half of
+	// the deeper layers
+	std::vector<glm::mat4> stressModelMats;
+	std::vector<glm::vec4> stressColors;
+	for (int layer = 0; layer < 16; layer++)
+	{
+		for (int i = 0; i < 24; i++)
+		{
+			// deterministic scattering, so all runs of the benchmark see the same scene
+			float x = std::sin(i * 12.9898f + layer * 78.233f) * 4.0f;
+			float y = std::sin(i * 39.3468f + layer * 11.135f) * 3.0f;
+			float z = -0.5f - layer * 0.4f;
+			stressModelMats.push_back(calculate_model_matrix(glm::vec3(x, y, z), glm::vec3(0.0f, 0.0f, i * 15.0f), glm::vec3(0.8f)));
+			stressColors.push_back(glm::vec4(0.5f + 0.5f * std::sin(i * 1.7f), 0.5f + 0.5f * std::sin(layer * 0.9f),
+			                                 0.5f + 0.5f * std::sin((i + layer) * 2.3f), 0.3f + 0.05f * (i % 8)));
+		}
+	}
+	unsigned int stressQuadCount = stressModelMats.size();
+	glm::mat4 wallModelMat = calculate_model_matrix(glm::vec3(-4.0f, 0.0f, -3.0f), glm::vec3(0.0f), glm::vec3(4.0f, 6.0f, 1.0f));
+
 	// set up intermediate variables
 	// ------------------------------------------------------------------
 	glm::vec4 zeroFillerVec(0.0f);
 	glm::vec4 oneFillerVec(1.0f);
+	glm::uvec4 zeroMaskVec(0u);
+	glm::uvec4 listEndVec(0xFFFFFFFFu);
+
+	// draws the transparent objects with the shader of either technique
+	// ------------------------------------------------------------------
+	auto drawTransparentObjects = [&](Shader& shader, const glm::mat4& vp) {
+		glBindVertexArray(quadVAO);
+		if (stressScene)
+		{
+			for (unsigned int i = 0; i < stressQuadCount; i++)
+			{
+				shader.setMat4("mvp", vp * stressModelMats[i]);
+				shader.setVec4("color", stressColors[i]);
+				glDrawArrays(GL_TRIANGLES, 0, 6);
+			}
+		}
+		else
+		{
+			// draw green quad
+			shader.setMat4("mvp", vp * greenModelMat);
+			shader.setVec4("color", glm::vec4(0.0f, 1.0f, 0.0f, 0.5f));
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+
+			// draw blue quad
+			shader.setMat4("mvp", vp * blueModelMat);
+			shader.setVec4("color", glm::vec4(0.0f, 0.0f, 1.0f, 0.5f));
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
+	};
+
+	// transparent and composite passes
+	// ------------------------------------------------------------------
+	auto renderTransparency = [&](const glm::mat4& vp, const TransparentTargets& targets, bool tiled) {
+		// clear the tile mask
+		if (tiled)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, tileMaskFBO);
+			glClearBufferuiv(GL_COLOR, 0, &zeroMaskVec[0]);
+		}
+
+		// draw transparent objects (transparent pass)
+		// -----
+
+		// configure render states: the opaque depth is tested, but not written
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_FALSE);
+		glEnable(GL_BLEND);
+		glBlendFunci(0, GL_ONE, GL_ONE);
+		glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+		glBlendFunci(2, GL_ONE, GL_ONE);
+		glBlendEquation(GL_FUNC_ADD);
+
+		// bind transparent framebuffer to render transparent objects
+		glBindFramebuffer(GL_FRAMEBUFFER, targets.fbo);
+		glClearBufferfv(GL_COLOR, 0, &zeroFillerVec[0]);
+		glClearBufferfv(GL_COLOR, 1, &oneFillerVec[0]);
+		if (targets.weightTexture != 0)
+			glClearBufferfv(GL_COLOR, 2, &zeroFillerVec[0]);
+
+		// use transparent shader
+		transparentShader.use();
+		transparentShader.setBool("mark_tiles", tiled);
+		transparentShader.setInt("tile_size", TILE_SIZE);
+		glBindImageTexture(0, tileMaskTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R8UI);
+		drawTransparentObjects(transparentShader, vp);
+
+		// draw composite image (composite pass)
+		// -----
+
+		// set render states
+		glDepthFunc(GL_ALWAYS);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		// bind opaque framebuffer
+		glBindFramebuffer(GL_FRAMEBUFFER, opaqueFBO);
+
+		// bind the accumulated textures
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, targets.accumTexture);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, targets.revealTexture);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, targets.weightTexture);
+		glBindVertexArray(quadVAO);
+
+		if (tiled)
+		{
+			// the tile mask written by the transparent pass' image stores is read by the composite's vertex shader
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+			glActiveTexture(GL_TEXTURE3);
+			glBindTexture(GL_TEXTURE_2D, tileMaskTexture);
+
+			// draw a quad per tile, the ones without transparent fragments are collapsed by the vertex shader
+			tiledCompositeShader.use();
+			tiledCompositeShader.setBool("packed_targets", targets.weightTexture != 0);
+			tiledCompositeShader.setInt("tile_size", TILE_SIZE);
+			tiledCompositeShader.setVec2("screen_size", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+			glDrawArraysInstanced(GL_TRIANGLES, 0, 6, tilesX * tilesY);
+		}
+		else
+		{
+			// draw screen quad
+			compositeShader.use();
+			compositeShader.setBool("packed_targets", targets.weightTexture != 0);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
+		glActiveTexture(GL_TEXTURE0);
+	};
+
+	// exact transparency: per-pixel fragment lists, sorted and blended by the resolve pass
+	// ------------------------------------------------------------------
+	auto renderLinkedLists = [&](const glm::mat4& vp) {
+		// reset the lists and the counters
+		glBindFramebuffer(GL_FRAMEBUFFER, headPointerFBO);
+		glClearBufferuiv(GL_COLOR, 0, &listEndVec[0]);
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, listCounterBuffer);
+		glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zeroCounters), zeroCounters);
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+		// build the lists (transparent pass)
+		// -----
+
+		// configure render states: the opaque depth is tested, but not written, and there's nothing to blend
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_FALSE);
+		glDisable(GL_BLEND);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, linkedListFBO);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, listNodeBuffer);
+		glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, listCounterBuffer);
+		glBindImageTexture(1, headPointerTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+		linkedListBuildShader.use();
+		drawTransparentObjects(linkedListBuildShader, vp);
+
+		// sort and blend the lists over the opaque image (resolve pass)
+		// -----
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT);
+
+		glDepthFunc(GL_ALWAYS);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, opaqueFBO);
+		linkedListResolveShader.use();
+		glBindVertexArray(quadVAO);
+		glDrawArrays(GL_TRIANGLES, 0, 6);
+	};
+
+	// reads back the counters of the last lists, this waits for them to be resolved
+	struct ListStats
+	{
+		unsigned int fragments, truncatedPixels;
+	};
+	auto readListStats = [&]() {
+		GLuint counters[2];
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, listCounterBuffer);
+		glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counters), counters);
+		glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+		return ListStats{ counters[0], counters[1] };
+	};
+	auto printListStats = [&](const ListStats& stats) {
+		unsigned int stored = std::min(stats.fragments, maxListNodes);
+		std::cout << "    " << stats.fragments << " fragments (" << stats.fragments - stored << " dropped, pool of " << maxListNodes
+		          << "), " << stats.truncatedPixels << " pixels with more than 16 fragments; "
+		          << (4.0 * SCR_WIDTH * SCR_HEIGHT + (double)LIST_NODE_SIZE * stored) / (1024.0 * 1024.0) << " MB used of "
+		          << (4.0 * SCR_WIDTH * SCR_HEIGHT + (double)LIST_NODE_SIZE * maxListNodes) / (1024.0 * 1024.0) << " MB" << std::endl;
+	};
+
+	// timing of the transparent and composite passes
+	unsigned int oitQuery, benchmarkQuery;
+	glGenQueries(1, &oitQuery);
+	glGenQueries(1, &benchmarkQuery);
+	unsigned int frameCount = 0;
+	double oitTimeSum = 0.0;
+
+	std::cout << "Press M to toggle the tiled composite, F to toggle the packed targets, G to toggle the stress scene, "
+	          << "T to time all combinations, L to toggle the exact linked lists, B to time both techniques at increasing "
+	          << "depth complexity" << std::endl;
 	
 	// render loop
 	// -----------
@@ -217,57 +504,123 @@ int main(int argc, char* argv[])
 		glBindVertexArray(quadVAO);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 
-		// draw transparent objects (transparent pass)
-		// -----
-
-		// configure render states
-		glDepthMask(GL_FALSE);
-		glEnable(GL_BLEND);
-		glBlendFunci(0, GL_ONE, GL_ONE);
-		glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-		glBlendEquation(GL_FUNC_ADD);
-
-		// bind transparent framebuffer to render transparent objects
-		glBindFramebuffer(GL_FRAMEBUFFER, transparentFBO);
-		glClearBufferfv(GL_COLOR, 0, &zeroFillerVec[0]);
-		glClearBufferfv(GL_COLOR, 1, &oneFillerVec[0]);
-
-		// use transparent shader
-		transparentShader.use();
+		if (stressScene)
+		{
+			solidShader.setMat4("mvp", vp * wallModelMat);
+			solidShader.setVec3("color", glm::vec3(0.3f, 0.3f, 0.3f));
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
 
-		// draw green quad
-		transparentShader.setMat4("mvp", vp * greenModelMat);
-		transparentShader.setVec4("color", glm::vec4(0.0f, 1.0f, 0.0f, 0.5f));
-		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		// draw blue quad
-		transparentShader.setMat4("mvp", vp * blueModelMat);
-		transparentShader.setVec4("color", glm::vec4(0.0f, 0.0f, 1.0f, 0.5f));
-		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		// draw composite image (composite pass)
+		// draw transparent objects and composite them over the opaque image
 		// -----
 
-		// set render states
-		glDepthFunc(GL_ALWAYS);
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		// bind opaque framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, opaqueFBO);
-
-		// use composite shader
-		compositeShader.use();
-
-		// draw screen quad
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, accumTexture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, revealTexture);
-		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		// the previous frame's timing is read before its query is reused
+		if (frameCount > 0)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(oitQuery, GL_QUERY_RESULT, &elapsed);
+			oitTimeSum += elapsed / 1000000.0;
+		}
+		const TransparentTargets& targets = packedTargets ? packedTransparentTargets : fullTargets;
+		glBeginQuery(GL_TIME_ELAPSED, oitQuery);
+		if (linkedLists)
+			renderLinkedLists(vp);
+		else
+			renderTransparency(vp, targets, tiledComposite);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		if (++frameCount % 120 == 0 && linkedLists)
+		{
+			std::cout << "linked lists: " << oitTimeSum / 120.0 << " ms" << std::endl;
+			printListStats(readListStats());
+			oitTimeSum = 0.0;
+		}
+		else if (frameCount % 120 == 0)
+		{
+			std::cout << (tiledComposite ? "tiled" : "full screen") << " composite, " << (packedTargets ? "packed" : "full") << " targets ("
+			          << targets.bytesPerPixel << " bytes per pixel): " << oitTimeSum / 120.0 << " ms" << std::endl;
+			oitTimeSum = 0.0;
+		}
+
+		// benchmark: all combinations of the settings on the current view; the repeated composites are blended over
+		// the opaque image, so this frame looks off
+		// -----
+		if (benchmarkOIT)
+		{
+			benchmarkOIT = false;
+			const unsigned int REPEATS = 20;
+			for (int packed = 0; packed < 2; packed++)
+			{
+				for (int tiled = 0; tiled < 2; tiled++)
+				{
+					const TransparentTargets& benchmarkTargets = packed ? packedTransparentTargets : fullTargets;
+					renderTransparency(vp, benchmarkTargets, tiled); // warm up
+					glBeginQuery(GL_TIME_ELAPSED, benchmarkQuery);
+					for (unsigned int i = 0; i < REPEATS; i++)
+						renderTransparency(vp, benchmarkTargets, tiled);
+					glEndQuery(GL_TIME_ELAPSED);
+					GLuint64 elapsed = 0;
+					glGetQueryObjectui64v(benchmarkQuery, GL_QUERY_RESULT, &elapsed);
+					std::cout << (packed ? "packed" : "full") << " targets (" << benchmarkTargets.bytesPerPixel << " bytes per pixel), "
+					          << (tiled ? "tiled" : "full screen") << " composite: " << elapsed / 1000000.0 / REPEATS << " ms" << std::endl;
+				}
+			}
+
+			// how much of the screen the tiled composite covers; the mask is written with image stores, which the
+			// readback only sees after this barrier
+			glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+			std::vector<unsigned char> mask(tilesX * tilesY);
+			glBindTexture(GL_TEXTURE_2D, tileMaskTexture);
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, mask.data());
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			unsigned int touched = 0;
+			for (unsigned char tile : mask)
+				touched += tile != 0;
+			std::cout << "tiles with transparent fragments: " << touched << " of " << mask.size() << std::endl;
+		}
+
+		// benchmark: weighted blended (with the current settings) against the linked lists, on the current view of the
+		// stress scene with 1 to 16 of its layers
+		// -----
+		if (benchmarkDepthComplexity)
+		{
+			benchmarkDepthComplexity = false;
+			const unsigned int REPEATS = 20;
+			bool showStressScene = stressScene;
+			stressScene = true;
+			for (unsigned int layers = 1; layers <= 16; layers *= 2)
+			{
+				stressQuadCount = layers * 24;
+				double times[2];
+				for (int exact = 0; exact < 2; exact++)
+				{
+					if (exact)
+						renderLinkedLists(vp); // warm up
+					else
+						renderTransparency(vp, targets, tiledComposite);
+					glBeginQuery(GL_TIME_ELAPSED, benchmarkQuery);
+					for (unsigned int i = 0; i < REPEATS; i++)
+					{
+						if (exact)
+							renderLinkedLists(vp);
+						else
+							renderTransparency(vp, targets, tiledComposite);
+					}
+					glEndQuery(GL_TIME_ELAPSED);
+					GLuint64 elapsed = 0;
+					glGetQueryObjectui64v(benchmarkQuery, GL_QUERY_RESULT, &elapsed);
+					times[exact] = elapsed / 1000000.0 / REPEATS;
+				}
+				std::cout << layers << " layers: weighted blended " << times[0] << " ms ("
+				          << targets.bytesPerPixel * SCR_WIDTH * SCR_HEIGHT / (1024.0 * 1024.0) << " MB), linked lists "
+				          << times[1] << " ms" << std::endl;
+				printListStats(readListStats());
+			}
+			stressQuadCount = stressModelMats.size();
+			stressScene = showStressScene;
+		}
 
 		// draw to backbuffer (final pass)
 		// -----
@@ -303,10 +656,18 @@ int main(int argc, char* argv[])
 	glDeleteBuffers(1, &quadVBO);
 	glDeleteTextures(1, &opaqueTexture);
 	glDeleteTextures(1, &depthTexture);
-	glDeleteTextures(1, &accumTexture);
-	glDeleteTextures(1, &revealTexture);
+	glDeleteTextures(1, &tileMaskTexture);
 	glDeleteFramebuffers(1, &opaqueFBO);
-	glDeleteFramebuffers(1, &transparentFBO);
+	glDeleteFramebuffers(1, &tileMaskFBO);
+	delete_transparent_targets(fullTargets);
+	delete_transparent_targets(packedTransparentTargets);
+	glDeleteQueries(1, &oitQuery);
+	glDeleteQueries(1, &benchmarkQuery);
+	glDeleteTextures(1, &headPointerTexture);
+	glDeleteFramebuffers(1, &headPointerFBO);
+	glDeleteFramebuffers(1, &linkedListFBO);
+	glDeleteBuffers(1, &listNodeBuffer);
+	glDeleteBuffers(1, &listCounterBuffer);
 
 	glfwTerminate();
 
@@ -364,6 +725,54 @@ void process_input(GLFWwindow *window)
 		camera.ProcessKeyboard(LEFT, deltaTime);
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 		camera.ProcessKeyboard(RIGHT, deltaTime);
+
+	if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !tiledCompositeKeyPressed)
+	{
+		tiledComposite = !tiledComposite;
+		tiledCompositeKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE)
+		tiledCompositeKeyPressed = false;
+
+	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !packedTargetsKeyPressed)
+	{
+		packedTargets = !packedTargets;
+		packedTargetsKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE)
+		packedTargetsKeyPressed = false;
+
+	if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !stressSceneKeyPressed)
+	{
+		stressScene = !stressScene;
+		stressSceneKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+		stressSceneKeyPressed = false;
+
+	if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !benchmarkKeyPressed)
+	{
+		benchmarkOIT = true;
+		benchmarkKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+		benchmarkKeyPressed = false;
+
+	if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !linkedListsKeyPressed)
+	{
+		linkedLists = !linkedLists;
+		linkedListsKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE)
+		linkedListsKeyPressed = false;
+
+	if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !depthComplexityKeyPressed)
+	{
+		benchmarkDepthComplexity = true;
+		depthComplexityKeyPressed = true;
+	}
+	if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+		depthComplexityKeyPressed = false;
 }
 
 // generate a model matrix
@@ -380,3 +789,65 @@ glm::mat4 calculate_model_matrix(const glm::vec3& position, const glm::vec3& rot
 
 	return trans;
 }
+
+// create the framebuffer and attachments of the transparent pass
+// ---------------------------------------------------------------------------------------------------------
+TransparentTargets create_transparent_targets(bool packed, unsigned int depthTexture)
+{
+	TransparentTargets targets;
+	targets.weightTexture = 0;
+	targets.bytesPerPixel = packed ? 4 + 2 + 1 : 8 + 1;
+
+	glGenTextures(1, &targets.accumTexture);
+	glBindTexture(GL_TEXTURE_2D, targets.accumTexture);
+	if (packed)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGB, GL_FLOAT, NULL);
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// R11G11B10F has no alpha channel for the accumulated weight, so it gets its own target
+	if (packed)
+	{
+		glGenTextures(1, &targets.weightTexture);
+		glBindTexture(GL_TEXTURE_2D, targets.weightTexture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RED, GL_HALF_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+
+	glGenTextures(1, &targets.revealTexture);
+	glBindTexture(GL_TEXTURE_2D, targets.revealTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, SCR_WIDTH, SCR_HEIGHT, 0, GL_RED, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &targets.fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, targets.fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targets.accumTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, targets.revealTexture, 0);
+	if (packed)
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, targets.weightTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0); // opaque framebuffer's depth texture
+
+	const GLenum transparentDrawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+	glDrawBuffers(packed ? 3 : 2, transparentDrawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Transparent framebuffer is not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return targets;
+}
+
+// delete the framebuffer and attachments of the transparent pass
+// ---------------------------------------------------------------------------------------------------------
+void delete_transparent_targets(TransparentTargets& targets)
+{
+	glDeleteTextures(1, &targets.accumTexture);
+	glDeleteTextures(1, &targets.weightTexture);
+	glDeleteTextures(1, &targets.revealTexture);
+	glDeleteFramebuffers(1, &targets.fbo);
+}
@@ -0,0 +1,18 @@
+#version 410 core
+
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+flat in int Layer[];
+
+void main()
+{
+	// fallback for when the vertex shader can't write gl_Layer: route the triangle to the layer of its instance
+	for (int i = 0; i < 3; ++i)
+	{
+		gl_Position = gl_in[i].gl_Position;
+		gl_Layer = Layer[0];
+		EmitVertex();
+	}
+	EndPrimitive();
+}
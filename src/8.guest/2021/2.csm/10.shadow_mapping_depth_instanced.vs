@@ -0,0 +1,18 @@
+#version 410 core
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aLayer;
+
+layout (std140) uniform LightSpaceMatrices
+{
+    mat4 lightSpaceMatrices[16];
+};
+
+void main()
+{
+    // every instance is a caster in a single cascade, so the layer is selected right here
+    gl_Layer = aLayer;
+    gl_Position = lightSpaceMatrices[aLayer] * aModel * vec4(aPos, 1.0);
+}
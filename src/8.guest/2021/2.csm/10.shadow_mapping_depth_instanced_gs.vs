@@ -0,0 +1,17 @@
+#version 410 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in int aLayer;
+
+layout (std140) uniform LightSpaceMatrices
+{
+    mat4 lightSpaceMatrices[16];
+};
+
+flat out int Layer;
+
+void main()
+{
+    Layer = aLayer;
+    gl_Position = lightSpaceMatrices[aLayer] * aModel * vec4(aPos, 1.0);
+}
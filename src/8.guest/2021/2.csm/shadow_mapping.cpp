@@ -10,6 +10,7 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/shadow_pass.h>
 
 #include <iostream>
 #include <random>
@@ -20,7 +21,10 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
 void renderScene(const Shader &shader);
+void generateCasters(unsigned int count = 10);
+void updateCasters(float time);
 void renderCube();
+unsigned int getCubeVAO();
 void renderQuad();
 std::vector<glm::mat4> getLightSpaceMatrices();
 std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& projview);
@@ -66,6 +70,27 @@ std::mt19937 generator = std::mt19937(device());
 
 std::vector<glm::mat4> lightMatricesCache;
 
+// shadow casters
+struct Caster {
+    glm::vec3 Position;
+    float Rotation;
+    float Scale;
+    glm::mat4 Model;
+};
+std::vector<Caster> casters;
+bool animateCasters = false;
+
+// cascade update scheduling: a cascade is only re-rendered when its (texel snapped) light matrix
+// changed or the casters moved, and the distant cascades at most every cascadeUpdateInterval frames
+bool incrementalCascades = true;
+constexpr unsigned int alwaysUpdatedCascades = 2;
+constexpr unsigned int cascadeUpdateInterval = 4;
+std::vector<glm::mat4> cascadeMatrices; // light matrices the layers were last rendered with
+std::vector<bool> cascadeDirty;
+unsigned int frameIndex = 0;
+
+bool benchmark = false;
+
 int main()
 {
     //generator.seed(2);
@@ -114,6 +139,13 @@ int main()
     // -------------------------
     Shader shader("10.shadow_mapping.vs", "10.shadow_mapping.fs");
     Shader simpleDepthShader("10.shadow_mapping_depth.vs", "10.shadow_mapping_depth.fs", "10.shadow_mapping_depth.gs");
+    // layered shadow pass: all cascades in a single instanced draw; the layer is selected by the
+    // vertex shader if supported, otherwise by a (pass-through) geometry shader
+    ShadowPass shadowPass(2);
+    Shader layeredDepthShaderGS("10.shadow_mapping_depth_instanced_gs.vs", "10.shadow_mapping_depth.fs", "10.shadow_mapping_depth_instanced.gs");
+    Shader *layeredDepthShader = nullptr;
+    if (shadowPass.VertexLayer)
+        layeredDepthShader = new Shader("10.shadow_mapping_depth_instanced.vs", "10.shadow_mapping_depth.fs");
     Shader debugDepthQuad("10.debug_quad.vs", "10.debug_quad_depth.fs");
     Shader debugCascadeShader("10.debug_cascade.vs", "10.debug_cascade.fs");
 
@@ -147,6 +179,10 @@ int main()
     // -------------
     unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str());
 
+    // shadow casters
+    // --------------
+    generateCasters();
+
     // configure light FBO
     // -----------------------
     glGenFramebuffers(1, &lightFBO);
@@ -196,6 +232,104 @@ int main()
     debugDepthQuad.use();
     debugDepthQuad.setInt("depthMap", 0);
 
+    // shadow pass timing
+    // ------------------
+    unsigned int shadowQueries[2];
+    glGenQueries(2, shadowQueries);
+    bool shadowQueryIssued[2] = { false, false };
+    double shadowTime = 0.0;
+    unsigned int timedFrames = 0, cascadesRendered = 0, castersRendered = 0;
+
+    // 1. render depth of scene to texture (from light's perspective); only the cascades enabled in
+    // renderCascade are updated and it returns the number of (caster, cascade) pairs rendered
+    // ------------------------------------------------------------------------------------------------
+    auto renderShadowMaps = [&](bool layered, bool vertexLayer, const std::vector<bool>& renderCascade)
+    {
+        unsigned int instances = 0;
+        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+        glViewport(0, 0, depthMapResolution, depthMapResolution);
+        glCullFace(GL_FRONT);  // peter panning
+        if (layered)
+        {
+            // clear the outdated layers only, then render them all at once: every caster is
+            // instanced into each of those cascades its bounding sphere intersects
+            for (size_t i = 0; i < renderCascade.size(); ++i)
+            {
+                if (!renderCascade[i])
+                    continue;
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0, int(i));
+                glClear(GL_DEPTH_BUFFER_BIT);
+            }
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0);
+            shadowPass.Begin(cascadeMatrices, renderCascade);
+            shadowPass.Add(0, glm::mat4(1.0f), glm::vec3(0.0f, -2.0f, 0.0f), 35.36f); // floor
+            for (const auto& caster : casters)
+            {
+                shadowPass.Add(1, caster.Model, glm::vec3(0.0f), 1.7320508f); // the cube spans [-1, 1]
+            }
+            shadowPass.Upload();
+            if (vertexLayer)
+                layeredDepthShader->use();
+            else
+                layeredDepthShaderGS.use();
+            shadowPass.Draw(0, planeVAO, 6);
+            shadowPass.Draw(1, getCubeVAO(), 36);
+            instances = shadowPass.InstancesAdded;
+        }
+        else
+        {
+            // the geometry shader amplifies every triangle of every caster into all cascades
+            simpleDepthShader.use();
+            glClear(GL_DEPTH_BUFFER_BIT);
+            renderScene(simpleDepthShader);
+            instances = (unsigned int)(casters.size() + 1) * (unsigned int)renderCascade.size();
+        }
+        glCullFace(GL_BACK);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return instances;
+    };
+
+    // renders all cascades with 10 and 10k casters using each shadow pass path and reports the GPU time
+    // --------------------------------------------------------------------------------------------------
+    auto runBenchmark = [&]()
+    {
+        const auto sceneCasters = casters;
+        const std::vector<bool> allCascades(cascadeMatrices.size(), true);
+        const unsigned int casterCounts[] = { 10, 10000 };
+        const char* pathNames[] = { "geometry shader amplification", "culled + instanced (geometry shader layer)", "culled + instanced (vertex shader layer)" };
+        const int frames = 16;
+        unsigned int query;
+        glGenQueries(1, &query);
+        for (unsigned int count : casterCounts)
+        {
+            generateCasters(count);
+            for (int path = 0; path < 3; ++path)
+            {
+                if (path == 2 && !shadowPass.VertexLayer)
+                {
+                    std::cout << count << " casters, " << pathNames[path] << ": not supported" << std::endl;
+                    continue;
+                }
+                double totalTime = 0.0;
+                unsigned int instances = 0;
+                for (int frame = -1; frame < frames; ++frame) // first frame is a warm-up
+                {
+                    glBeginQuery(GL_TIME_ELAPSED, query);
+                    instances = renderShadowMaps(path != 0, path == 2, allCascades);
+                    glEndQuery(GL_TIME_ELAPSED);
+                    GLuint64 elapsed = 0;
+                    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                    if (frame >= 0)
+                        totalTime += elapsed / 1000000.0;
+                }
+                std::cout << count << " casters, " << pathNames[path] << ": " << totalTime / frames << " ms, " << instances << " caster instances" << std::endl;
+            }
+        }
+        glDeleteQueries(1, &query);
+        casters = sceneCasters;
+        glViewport(0, 0, fb_width, fb_height);
+    };
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -220,28 +354,75 @@ int main()
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 0. UBO setup
+        // move the casters (if enabled); this invalidates every cascade
+        if (animateCasters)
+        {
+            updateCasters(currentFrame);
+            cascadeDirty.assign(cascadeDirty.size(), true);
+        }
+
+        // 0. UBO setup: decide which cascades need to be re-rendered this frame
         const auto lightMatrices = getLightSpaceMatrices();
-        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+        if (cascadeMatrices.size() != lightMatrices.size())
+        {
+            cascadeMatrices = lightMatrices;
+            cascadeDirty.assign(lightMatrices.size(), true);
+        }
+        std::vector<bool> renderCascade(lightMatrices.size(), !incrementalCascades);
         for (size_t i = 0; i < lightMatrices.size(); ++i)
         {
-            glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &lightMatrices[i]);
+            if (lightMatrices[i] != cascadeMatrices[i])
+                cascadeDirty[i] = true;
+            // the near cascades follow the camera every frame, the distant ones round-robin
+            const bool scheduled = i < alwaysUpdatedCascades || (frameIndex + i) % cascadeUpdateInterval == 0;
+            if (cascadeDirty[i] && scheduled)
+                renderCascade[i] = true;
+            if (renderCascade[i])
+            {
+                cascadeMatrices[i] = lightMatrices[i];
+                cascadeDirty[i] = false;
+            }
         }
+        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, cascadeMatrices.size() * sizeof(glm::mat4x4), &cascadeMatrices[0]);
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+        if (benchmark)
+        {
+            runBenchmark();
+            benchmark = false;
+            // the benchmark overwrote every layer
+            renderCascade.assign(renderCascade.size(), true);
+        }
+
         // 1. render depth of scene to texture (from light's perspective)
         // --------------------------------------------------------------
         //lightProjection = glm::perspective(glm::radians(45.0f), (GLfloat)SHADOW_WIDTH / (GLfloat)SHADOW_HEIGHT, near_plane, far_plane); // note that if you use a perspective projection matrix you'll have to change the light position as the current light position isn't enough to reflect the whole scene
         // render scene from light's point of view
-        simpleDepthShader.use();
-
-        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-        glViewport(0, 0, depthMapResolution, depthMapResolution);
-        glClear(GL_DEPTH_BUFFER_BIT);
-        glCullFace(GL_FRONT);  // peter panning
-        renderScene(simpleDepthShader);
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        const unsigned int query = frameIndex % 2;
+        if (shadowQueryIssued[query])
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(shadowQueries[query], GL_QUERY_RESULT, &elapsed);
+            shadowTime += elapsed / 1000000.0;
+            timedFrames++;
+        }
+        glBeginQuery(GL_TIME_ELAPSED, shadowQueries[query]);
+        castersRendered += renderShadowMaps(incrementalCascades, shadowPass.VertexLayer, renderCascade);
+        for (bool rendered : renderCascade)
+        {
+            cascadesRendered += rendered ? 1 : 0;
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        shadowQueryIssued[query] = true;
+        if (timedFrames == 120)
+        {
+            std::cout << "shadow pass (" << (incrementalCascades ? "incremental" : "full") << "): " << shadowTime / timedFrames << " ms/frame, "
+                      << float(cascadesRendered) / timedFrames << " cascades/frame, " << float(castersRendered) / timedFrames << " caster instances/frame" << std::endl;
+            shadowTime = 0.0;
+            timedFrames = cascadesRendered = castersRendered = 0;
+        }
+        frameIndex++;
 
         // reset viewport
         glViewport(0, 0, fb_width, fb_height);
@@ -303,6 +484,9 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &planeVAO);
     glDeleteBuffers(1, &planeVBO);
+    glDeleteQueries(2, shadowQueries);
+    shadowPass.Delete();
+    delete layeredDepthShader;
 
     glfwTerminate();
     return 0;
@@ -318,27 +502,44 @@ void renderScene(const Shader &shader)
     glBindVertexArray(planeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
-    static std::vector<glm::mat4> modelMatrices;
-    if (modelMatrices.size() == 0)
+    for (const auto& caster : casters)
     {
-        for (int i = 0; i < 10; ++i)
-        {
-            static std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-10, 10);
-            static std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
-            static std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
-
-            auto model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(offsetDistribution(generator), offsetDistribution(generator) + 10.0f, offsetDistribution(generator)));
-            model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
-            model = glm::scale(model, glm::vec3(scaleDistribution(generator)));
-            modelMatrices.push_back(model);
-        }
+        shader.setMat4("model", caster.Model);
+        renderCube();
+    }
+}
+
+// generates the randomly placed cubes of the scene; larger numbers of cubes are spread over a larger area
+// -------------------------------------------------------------------------------------------------------
+void generateCasters(unsigned int count)
+{
+    const float extent = 10.0f * std::sqrt(count / 10.0f);
+    std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-extent, extent);
+    std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
+    std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
+    casters.clear();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Caster caster;
+        caster.Position = glm::vec3(offsetDistribution(generator), std::min(offsetDistribution(generator), 10.0f) + 10.0f, offsetDistribution(generator));
+        caster.Rotation = rotationDistribution(generator);
+        caster.Scale = scaleDistribution(generator);
+        casters.push_back(caster);
     }
+    updateCasters(0.0f);
+}
 
-    for (const auto& model : modelMatrices)
+// updates the casters' model matrices; they slowly spin over time
+// ---------------------------------------------------------------
+void updateCasters(float time)
+{
+    for (auto& caster : casters)
     {
-        shader.setMat4("model", model);
-        renderCube();
+        auto model = glm::mat4(1.0f);
+        model = glm::translate(model, caster.Position);
+        model = glm::rotate(model, glm::radians(caster.Rotation + time * 20.0f), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
+        model = glm::scale(model, glm::vec3(caster.Scale));
+        caster.Model = model;
     }
 }
 
@@ -347,7 +548,7 @@ void renderScene(const Shader &shader)
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
 unsigned int cubeVBO = 0;
-void renderCube()
+unsigned int getCubeVAO()
 {
     // initialize (if necessary)
     if (cubeVAO == 0)
@@ -412,8 +613,13 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
+    return cubeVAO;
+}
+
+void renderCube()
+{
     // render Cube
-    glBindVertexArray(cubeVAO);
+    glBindVertexArray(getCubeVAO());
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glBindVertexArray(0);
 }
@@ -561,6 +767,28 @@ void processInput(GLFWwindow *window)
         lightMatricesCache = getLightSpaceMatrices();
     }
     cPress = glfwGetKey(window, GLFW_KEY_C);
+
+    static int iPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_RELEASE && iPress == GLFW_PRESS)
+    {
+        incrementalCascades = !incrementalCascades;
+        std::cout << "cascade updates: " << (incrementalCascades ? "incremental (culled, layered instancing)" : "full (geometry shader amplification)") << std::endl;
+    }
+    iPress = glfwGetKey(window, GLFW_KEY_I);
+
+    static int mPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE && mPress == GLFW_PRESS)
+    {
+        animateCasters = !animateCasters;
+    }
+    mPress = glfwGetKey(window, GLFW_KEY_M);
+
+    static int bPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE && bPress == GLFW_PRESS)
+    {
+        benchmark = true;
+    }
+    bPress = glfwGetKey(window, GLFW_KEY_B);
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -666,6 +894,10 @@ std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& proj, const
     return getFrustumCornersWorldSpace(proj * view);
 }
 
+// fits a cascade to the bounding sphere of its slice of the camera frustum. As the sphere's size
+// doesn't depend on the camera's orientation and its center is snapped to whole shadow map texels,
+// the cascade doesn't shimmer while the camera moves and its matrix only changes once the camera
+// moved by at least a texel.
 glm::mat4 getLightSpaceMatrix(const float nearPlane, const float farPlane)
 {
     const auto proj = glm::perspective(
@@ -680,45 +912,25 @@ glm::mat4 getLightSpaceMatrix(const float nearPlane, const float farPlane)
     }
     center /= corners.size();
 
-    const auto lightView = glm::lookAt(center + lightDir, center, glm::vec3(0.0f, 1.0f, 0.0f));
-
-    float minX = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::lowest();
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::lowest();
-    float minZ = std::numeric_limits<float>::max();
-    float maxZ = std::numeric_limits<float>::lowest();
+    float radius = 0.0f;
     for (const auto& v : corners)
     {
-        const auto trf = lightView * v;
-        minX = std::min(minX, trf.x);
-        maxX = std::max(maxX, trf.x);
-        minY = std::min(minY, trf.y);
-        maxY = std::max(maxY, trf.y);
-        minZ = std::min(minZ, trf.z);
-        maxZ = std::max(maxZ, trf.z);
+        radius = std::max(radius, glm::length(glm::vec3(v) - center));
     }
+    // round the radius up so floating point noise doesn't change the cascade's size
+    radius = std::ceil(radius * 16.0f) / 16.0f;
 
-    // Tune this parameter according to the scene
-    constexpr float zMult = 10.0f;
-    if (minZ < 0)
-    {
-        minZ *= zMult;
-    }
-    else
-    {
-        minZ /= zMult;
-    }
-    if (maxZ < 0)
-    {
-        maxZ /= zMult;
-    }
-    else
-    {
-        maxZ *= zMult;
-    }
+    // the light's orientation is fixed, only the ortho volume moves with the cascade
+    const auto lightView = glm::lookAt(glm::vec3(0.0f), -lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
+    const float texelSize = 2.0f * radius / depthMapResolution;
+    glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+    lightCenter = glm::floor(lightCenter / texelSize) * texelSize;
 
-    const glm::mat4 lightProjection = glm::ortho(minX, maxX, minY, maxY, minZ, maxZ);
+    // Tune this parameter according to the scene; extends the volume towards the light to include casters outside the slice
+    constexpr float zMult = 10.0f;
+    const glm::mat4 lightProjection = glm::ortho(
+        lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius, lightCenter.y + radius,
+        -lightCenter.z - radius * zMult, -lightCenter.z + radius);
     return lightProjection * lightView;
 }
 
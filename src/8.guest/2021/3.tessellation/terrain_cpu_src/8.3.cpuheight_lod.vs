@@ -0,0 +1,33 @@
+#version 330 core
+layout (location = 0) in vec2 aHeights; // height, height on the parent node's surface
+
+out float Height;
+out vec3 Position;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+// the node being drawn, see TerrainLOD::Draw
+uniform vec2 nodeOrigin;   // world (x, z) of its first vertex
+uniform float nodeSpacing; // distance between its vertices
+uniform vec2 morphRange;   // camera distances over which it morphs to its parent's surface
+uniform vec2 terrainMax;   // world (x, z) of the heightmap's last pixel
+uniform vec3 cameraPosition;
+
+const int VERTICES = 65;   // per node side
+
+void main()
+{
+    // every node has the same grid; the node's slot is its base vertex, so the grid position is what's left over
+    int vertex = gl_VertexID % (VERTICES * VERTICES);
+    vec2 grid = vec2(vertex / VERTICES, vertex % VERTICES); // (row, column), rows run along x
+    vec2 xz = min(nodeOrigin + grid * nodeSpacing, terrainMax);
+
+    // measured from the vertex's position on the parent's surface, which both sides of an edge between two levels agree on
+    float morph = clamp((distance(cameraPosition, vec3(xz.x, aHeights.y, xz.y)) - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+    vec3 position = vec3(xz.x, mix(aHeights.x, aHeights.y, morph), xz.y);
+
+    Height = position.y;
+    Position = (view * vec4(position, 1.0)).xyz;
+    gl_Position = projection * view * vec4(position, 1.0);
+}
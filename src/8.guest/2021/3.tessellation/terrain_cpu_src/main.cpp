@@ -9,8 +9,12 @@
 
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/terrain_lod.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <string>
 #include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -19,11 +23,24 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 
+// the original terrain: one triangle strip per heightmap row, of every pixel
+struct MonolithicMesh {
+    unsigned int VAO, VBO, IBO;
+    int NumStrips, NumTrisPerStrip;
+    size_t VertexCount;
+    double BuildTimeMs;
+};
+bool buildMonolithicMesh(const char *path, MonolithicMesh &mesh);
+void drawMonolithicMesh(const MonolithicMesh &mesh);
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 int useWireframe = 0;
 int displayGrayscale = 0;
+bool useMonolithic = false; // draw the original full resolution mesh instead of the quadtree
+bool runBenchmark = false;
+float maxPixelError = 2.0f;
 
 // camera - give pretty starting point
 Camera camera(glm::vec3(67.0f, 627.5f, 169.9f),
@@ -83,14 +100,225 @@ int main()
     // build and compile our shader program
     // ------------------------------------
     Shader heightMapShader("8.3.cpuheight.vs","8.3.cpuheight.fs");
+    Shader terrainLODShader("8.3.cpuheight_lod.vs", "8.3.cpuheight.fs");
+
+    // split the heightmap into a quadtree of chunks on disk; the pack is kept next to the heightmap and only
+    // rebuilt when the heightmap changes, after that nothing is read from disk but the chunks in view
+    // ------------------------------------------------------------------
+    typedef std::chrono::high_resolution_clock myclock;
+    const std::string heightmapPath = "heightmaps/iceland_heightmap.png";
+    const std::string packPath = heightmapPath + ".terrain";
+    float yScale = 64.0f / 256.0f, yShift = 16.0f;
+    myclock::time_point packStart = myclock::now();
+    uint64_t heightmapHash = FileHash::Hash(heightmapPath);
+    TerrainPack pack;
+    if (!pack.Open(packPath, heightmapHash))
+    {
+        stbi_set_flip_vertically_on_load(true);
+        int width, height, nrChannels;
+        unsigned char *data = stbi_load(heightmapPath.c_str(), &width, &height, &nrChannels, 0);
+        if (!data)
+        {
+            std::cout << "Failed to load texture" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        TerrainPack::Build(packPath, heightmapHash, data, width, height, nrChannels);
+        stbi_image_free(data);
+        if (!pack.Open(packPath, heightmapHash))
+        {
+            glfwTerminate();
+            return -1;
+        }
+        std::cout << "Built terrain pack of " << pack.NodeCount() << " nodes in " << pack.Levels << " levels in "
+                  << std::chrono::duration<double, std::milli>(myclock::now() - packStart).count() << " ms" << std::endl;
+    }
+    else
+    {
+        std::cout << "Opened terrain pack of " << pack.NodeCount() << " nodes in "
+                  << std::chrono::duration<double, std::milli>(myclock::now() - packStart).count() << " ms" << std::endl;
+    }
+    TerrainLOD terrain(pack, 512, yScale, yShift);
+
+    // the original mesh is only built once it's drawn or benchmarked
+    MonolithicMesh monolithic = {};
+    bool monolithicBuilt = false;
+
+    unsigned int timeQuery;
+    glGenQueries(1, &timeQuery);
+    bool queryIssued = false;
+    GLuint64 totalQueryTimeNs = 0;
+    unsigned int queryCount = 0; // frames whose query result was available in time
+    double totalSelectTimeMs = 0.0;
+    unsigned int frameCount = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        if ((useMonolithic || runBenchmark) && !monolithicBuilt)
+        {
+            if (!buildMonolithicMesh(heightmapPath.c_str(), monolithic))
+            {
+                useMonolithic = false;
+                runBenchmark = false;
+            }
+            monolithicBuilt = useMonolithic || runBenchmark;
+        }
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glPolygonMode(GL_FRONT_AND_BACK, useWireframe ? GL_LINE : GL_FILL);
+
+        // view/projection transformations
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100000.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        heightMapShader.use();
+        heightMapShader.setMat4("projection", projection);
+        heightMapShader.setMat4("view", view);
+        heightMapShader.setMat4("model", glm::mat4(1.0f));
+        terrainLODShader.use();
+        terrainLODShader.setMat4("projection", projection);
+        terrainLODShader.setMat4("view", view);
+
+        // benchmark: both meshes from the current view, CPU time of the quadtree's selection and GPU time of
+        // drawing them
+        if (runBenchmark)
+        {
+            runBenchmark = false;
+            const int REPEATS = 20;
+            GLuint64 elapsed[2] = { 0, 0 };
+            double selectTimeMs = 0.0;
+            for (int i = 0; i < REPEATS; i++)
+            {
+                myclock::time_point selectStart = myclock::now();
+                terrain.Update(camera.Position, projection, view, (float)SCR_HEIGHT);
+                selectTimeMs += std::chrono::duration<double, std::milli>(myclock::now() - selectStart).count();
+                for (int mode = 0; mode < 2; mode++)
+                {
+                    GLuint64 time;
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    glBeginQuery(GL_TIME_ELAPSED, timeQuery);
+                    if (mode == 0)
+                    {
+                        heightMapShader.use();
+                        drawMonolithicMesh(monolithic);
+                    }
+                    else
+                    {
+                        terrainLODShader.use();
+                        terrain.Draw(terrainLODShader, camera.Position);
+                    }
+                    glEndQuery(GL_TIME_ELAPSED);
+                    glGetQueryObjectui64v(timeQuery, GL_QUERY_RESULT, &time);
+                    elapsed[mode] += time;
+                }
+            }
+            const TerrainLODStats &stats = terrain.Stats();
+            std::cout << "monolithic: " << monolithic.VertexCount << " vertices, built in " << monolithic.BuildTimeMs << " ms, "
+                      << elapsed[0] * 1.0e-6 / REPEATS << " ms GPU" << std::endl;
+            std::cout << "quadtree:   " << stats.VerticesDrawn << " vertices in " << stats.NodesDrawn << " nodes, selected in "
+                      << selectTimeMs / REPEATS << " ms, " << elapsed[1] * 1.0e-6 / REPEATS << " ms GPU" << std::endl;
+            queryIssued = false;
+        }
+
+        // result of last frame's query, read before the query is reused; if the GPU isn't done with it yet
+        // the frame isn't timed instead of waiting for it
+        if (queryIssued)
+        {
+            GLuint available = 0;
+            glGetQueryObjectuiv(timeQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                GLuint64 elapsed;
+                glGetQueryObjectui64v(timeQuery, GL_QUERY_RESULT, &elapsed);
+                totalQueryTimeNs += elapsed;
+                queryCount++;
+            }
+            frameCount++;
+            if (frameCount % 120 == 0)
+            {
+                const TerrainLODStats &stats = terrain.Stats();
+                if (useMonolithic)
+                    std::cout << "monolithic: " << monolithic.VertexCount << " vertices";
+                else
+                    std::cout << "quadtree: " << stats.VerticesDrawn << " vertices in " << stats.NodesDrawn << " nodes, "
+                              << stats.NodesResident << " resident, select " << totalSelectTimeMs / 120.0 << " ms";
+                if (queryCount > 0)
+                    std::cout << ", terrain " << totalQueryTimeNs * 1.0e-6 / queryCount << " ms GPU";
+                std::cout << std::endl;
+                totalQueryTimeNs = 0;
+                queryCount = 0;
+                totalSelectTimeMs = 0.0;
+            }
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, timeQuery);
+        if (useMonolithic)
+        {
+            heightMapShader.use();
+            drawMonolithicMesh(monolithic);
+        }
+        else
+        {
+            // selecting the nodes includes streaming in the ones that came into view
+            terrain.MaxPixelError = maxPixelError;
+            myclock::time_point selectStart = myclock::now();
+            terrain.Update(camera.Position, projection, view, (float)SCR_HEIGHT);
+            totalSelectTimeMs += std::chrono::duration<double, std::milli>(myclock::now() - selectStart).count();
+            terrainLODShader.use();
+            terrain.Draw(terrainLODShader, camera.Position);
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        queryIssued = true;
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
 
-    // load and create a texture
-    // -------------------------
-    // load image, create texture and generate mipmaps
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    if (monolithicBuilt)
+    {
+        glDeleteVertexArrays(1, &monolithic.VAO);
+        glDeleteBuffers(1, &monolithic.VBO);
+        glDeleteBuffers(1, &monolithic.IBO);
+    }
+    terrain.Delete();
+    glDeleteQueries(1, &timeQuery);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// builds the original mesh, timing how long it takes
+// ---------------------------------------------------------------------------------------------------------
+bool buildMonolithicMesh(const char *path, MonolithicMesh &mesh)
+{
+    typedef std::chrono::high_resolution_clock myclock;
+    myclock::time_point buildStart = myclock::now();
+
+    // load image
     // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
     stbi_set_flip_vertically_on_load(true);
     int width, height, nrChannels;
-    unsigned char *data = stbi_load("heightmaps/iceland_heightmap.png", &width, &height, &nrChannels, 0);
+    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
     if (data)
     {
         std::cout << "Loaded heightmap of size " << height << " x " << width << std::endl;
@@ -98,9 +326,9 @@ int main()
     else
     {
         std::cout << "Failed to load texture" << std::endl;
+        return false;
     }
 
-
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
     std::vector<float> vertices;
@@ -142,83 +370,43 @@ int main()
     std::cout << "Created " << numStrips * numTrisPerStrip << " triangles total" << std::endl;
 
     // first, configure the cube's VAO (and terrainVBO + terrainIBO)
-    unsigned int terrainVAO, terrainVBO, terrainIBO;
-    glGenVertexArrays(1, &terrainVAO);
-    glBindVertexArray(terrainVAO);
+    glGenVertexArrays(1, &mesh.VAO);
+    glBindVertexArray(mesh.VAO);
 
-    glGenBuffers(1, &terrainVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
+    glGenBuffers(1, &mesh.VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
 
     // position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glGenBuffers(1, &terrainIBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainIBO);
+    glGenBuffers(1, &mesh.IBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.IBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
+    glBindVertexArray(0);
+
+    mesh.NumStrips = numStrips;
+    mesh.NumTrisPerStrip = numTrisPerStrip;
+    mesh.VertexCount = vertices.size() / 3;
+    mesh.BuildTimeMs = std::chrono::duration<double, std::milli>(myclock::now() - buildStart).count();
+    std::cout << "Built monolithic mesh in " << mesh.BuildTimeMs << " ms" << std::endl;
+    return true;
+}
 
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
+// draws the original mesh strip by strip
+// ---------------------------------------------------------------------------------------------------------
+void drawMonolithicMesh(const MonolithicMesh &mesh)
+{
+    glBindVertexArray(mesh.VAO);
+    for(int strip = 0; strip < mesh.NumStrips; strip++)
     {
-        // per-frame time logic
-        // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-
-//        std::cout << deltaTime << "ms (" << 1.0f / deltaTime << " FPS)" << std::endl;
-
-        // input
-        // -----
-        processInput(window);
-
-        // render
-        // ------
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // be sure to activate shader when setting uniforms/drawing objects
-        heightMapShader.use();
-
-        // view/projection transformations
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100000.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        heightMapShader.setMat4("projection", projection);
-        heightMapShader.setMat4("view", view);
-
-        // world transformation
-        glm::mat4 model = glm::mat4(1.0f);
-        heightMapShader.setMat4("model", model);
-        
-        // render the cube
-        glBindVertexArray(terrainVAO);
-//        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        for(unsigned strip = 0; strip < numStrips; strip++)
-        {
-            glDrawElements(GL_TRIANGLE_STRIP,   // primitive type
-                           numTrisPerStrip+2,   // number of indices to render
-                           GL_UNSIGNED_INT,     // index data type
-                           (void*)(sizeof(unsigned) * (numTrisPerStrip+2) * strip)); // offset to starting index
-        }
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        glDrawElements(GL_TRIANGLE_STRIP,   // primitive type
+                       mesh.NumTrisPerStrip+2,   // number of indices to render
+                       GL_UNSIGNED_INT,     // index data type
+                       (void*)(sizeof(unsigned) * (mesh.NumTrisPerStrip+2) * strip)); // offset to starting index
     }
-
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &terrainVAO);
-    glDeleteBuffers(1, &terrainVBO);
-    glDeleteBuffers(1, &terrainIBO);
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    glBindVertexArray(0);
 }
 
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
@@ -261,6 +449,22 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             case GLFW_KEY_G:
                 displayGrayscale = 1 - displayGrayscale;
                 break;
+            case GLFW_KEY_M:
+                useMonolithic = !useMonolithic;
+                std::cout << (useMonolithic ? "monolithic mesh" : "quadtree") << std::endl;
+                break;
+            case GLFW_KEY_B:
+                runBenchmark = true;
+                break;
+            // screen-space error the quadtree's levels are chosen for
+            case GLFW_KEY_LEFT_BRACKET:
+                maxPixelError = std::max(maxPixelError * 0.5f, 0.25f);
+                std::cout << "max pixel error: " << maxPixelError << std::endl;
+                break;
+            case GLFW_KEY_RIGHT_BRACKET:
+                maxPixelError = std::min(maxPixelError * 2.0f, 64.0f);
+                std::cout << "max pixel error: " << maxPixelError << std::endl;
+                break;
             default:
                 break;
         }
@@ -0,0 +1,265 @@
+#version 430 core
+
+// Produces the whole bloom mip chain in a single dispatch, in the spirit of
+// AMD's single pass downsampler (SPD): every work group filters its tile of
+// the first three mips in shared memory, and the last work group to finish
+// (found through a global atomic counter) filters the remaining small mips
+// and already performs the upsamples between them.
+// The filter is the same 13 tap filter as 6.new_downsample.fs.
+layout (local_size_x = 16, local_size_y = 16) in;
+
+// the HDR color buffer
+uniform sampler2D srcTexture;
+
+// the levels of the bloom mip chain texture
+const int MAX_MIPS = 8;
+layout (r11f_g11f_b10f, binding = 0) coherent uniform image2D mips[MAX_MIPS];
+uniform int mipCount;
+uniform float filterRadius;
+
+// counts the work groups that finished their tile; reset by the last one
+layout (std430, binding = 0) coherent buffer SPDCounter
+{
+	uint finishedGroups;
+};
+
+// per work group: 8x8 texels of mip 2, the 16x16 of mip 1 and 32x32 of mip 0
+// below them, plus the apron the 13 tap filter reads around each tile. The 6x6
+// footprint of a downsampled texel grows the apron by 2 texels per level, so
+// mip 1 needs 16 + 2 * 2 texels and mip 0 2 * 20 + 2 * 2. Colors are stored
+// as two packed halfs to stay well within the minimum shared memory size.
+const int LOCAL_MIPS = 3;
+const int TILE0 = 32;
+const int TILE1 = 16;
+const int TILE2 = 8;
+const int CACHE0 = 44;
+const int CACHE1 = 20;
+shared uvec2 cache0[CACHE0 * CACHE0];
+shared uvec2 cache1[CACHE1 * CACHE1];
+shared bool lastGroup;
+
+const int THREADS = 16 * 16;
+
+uvec2 packColor(vec3 color)  { return uvec2(packHalf2x16(color.rg), packHalf2x16(vec2(color.b, 0.0))); }
+vec3 unpackColor(uvec2 data) { return vec3(unpackHalf2x16(data.x), unpackHalf2x16(data.y).x); }
+
+vec3 PowVec3(vec3 v, float p)
+{
+	return vec3(pow(v.x, p), pow(v.y, p), pow(v.z, p));
+}
+
+const float invGamma = 1.0 / 2.2;
+vec3 ToSRGB(vec3 v)   { return PowVec3(v, invGamma); }
+
+float sRGBToLuma(vec3 col)
+{
+	return dot(col, vec3(0.299f, 0.587f, 0.114f));
+}
+
+float KarisAverage(vec3 col)
+{
+	// Formula is 1 / (1 + luma)
+	float luma = sRGBToLuma(ToSRGB(col)) * 0.25f;
+	return 1.0f / (1.0f + luma);
+}
+
+// mip 0 from the HDR color buffer, with the Karis average against fireflies;
+// identical to the mipLevel 0 case of 6.new_downsample.fs
+vec3 downsampleSource(ivec2 texel, ivec2 size)
+{
+	vec2 texCoord = (vec2(texel) + 0.5) / vec2(size);
+	vec2 srcTexelSize = 1.0 / vec2(textureSize(srcTexture, 0));
+	float x = srcTexelSize.x;
+	float y = srcTexelSize.y;
+
+	vec3 a = texture(srcTexture, vec2(texCoord.x - 2*x, texCoord.y + 2*y)).rgb;
+	vec3 b = texture(srcTexture, vec2(texCoord.x,       texCoord.y + 2*y)).rgb;
+	vec3 c = texture(srcTexture, vec2(texCoord.x + 2*x, texCoord.y + 2*y)).rgb;
+	vec3 d = texture(srcTexture, vec2(texCoord.x - 2*x, texCoord.y)).rgb;
+	vec3 e = texture(srcTexture, vec2(texCoord.x,       texCoord.y)).rgb;
+	vec3 f = texture(srcTexture, vec2(texCoord.x + 2*x, texCoord.y)).rgb;
+	vec3 g = texture(srcTexture, vec2(texCoord.x - 2*x, texCoord.y - 2*y)).rgb;
+	vec3 h = texture(srcTexture, vec2(texCoord.x,       texCoord.y - 2*y)).rgb;
+	vec3 i = texture(srcTexture, vec2(texCoord.x + 2*x, texCoord.y - 2*y)).rgb;
+	vec3 j = texture(srcTexture, vec2(texCoord.x - x, texCoord.y + y)).rgb;
+	vec3 k = texture(srcTexture, vec2(texCoord.x + x, texCoord.y + y)).rgb;
+	vec3 l = texture(srcTexture, vec2(texCoord.x - x, texCoord.y - y)).rgb;
+	vec3 m = texture(srcTexture, vec2(texCoord.x + x, texCoord.y - y)).rgb;
+
+	vec3 groups[5];
+	groups[0] = (a+b+d+e) * (0.125f/4.0f);
+	groups[1] = (b+c+e+f) * (0.125f/4.0f);
+	groups[2] = (d+e+g+h) * (0.125f/4.0f);
+	groups[3] = (e+f+h+i) * (0.125f/4.0f);
+	groups[4] = (j+k+l+m) * (0.5f/4.0f);
+	groups[0] *= KarisAverage(groups[0]);
+	groups[1] *= KarisAverage(groups[1]);
+	groups[2] *= KarisAverage(groups[2]);
+	groups[3] *= KarisAverage(groups[3]);
+	groups[4] *= KarisAverage(groups[4]);
+	return max(groups[0]+groups[1]+groups[2]+groups[3]+groups[4], 0.0001f);
+}
+
+// a texel of the level above the one being filtered: from one of the shared
+// caches (whose tiles start at origin) or, for the tail levels, from the image
+const int FROM_CACHE0 = 0;
+const int FROM_CACHE1 = 1;
+const int FROM_IMAGE = 2;
+vec3 loadTexel(int source, int level, ivec2 texel, ivec2 origin)
+{
+	ivec2 local = texel - origin;
+	if (source == FROM_CACHE0)
+		return unpackColor(cache0[local.y * CACHE0 + local.x]);
+	if (source == FROM_CACHE1)
+		return unpackColor(cache1[local.y * CACHE1 + local.x]);
+	texel = clamp(texel, ivec2(0), imageSize(mips[level]) - 1);
+	return imageLoad(mips[level], texel).rgb;
+}
+
+// the bilinear sample halfway between two texels on both axes, which is where
+// all 13 taps of the filter land when the level is exactly half the size
+vec3 tap(int source, int level, ivec2 texel, ivec2 origin)
+{
+	return (loadTexel(source, level, texel, origin) + loadTexel(source, level, texel + ivec2(1, 0), origin) +
+	        loadTexel(source, level, texel + ivec2(0, 1), origin) + loadTexel(source, level, texel + ivec2(1, 1), origin)) * 0.25;
+}
+
+// a texel of the next level, the default case of 6.new_downsample.fs
+vec3 downsample(int source, int level, ivec2 texel, ivec2 origin)
+{
+	ivec2 p = texel * 2;
+	vec3 a = tap(source, level, p + ivec2(-2,  2), origin);
+	vec3 b = tap(source, level, p + ivec2( 0,  2), origin);
+	vec3 c = tap(source, level, p + ivec2( 2,  2), origin);
+	vec3 d = tap(source, level, p + ivec2(-2,  0), origin);
+	vec3 e = tap(source, level, p + ivec2( 0,  0), origin);
+	vec3 f = tap(source, level, p + ivec2( 2,  0), origin);
+	vec3 g = tap(source, level, p + ivec2(-2, -2), origin);
+	vec3 h = tap(source, level, p + ivec2( 0, -2), origin);
+	vec3 i = tap(source, level, p + ivec2( 2, -2), origin);
+	vec3 j = tap(source, level, p + ivec2(-1,  1), origin);
+	vec3 k = tap(source, level, p + ivec2( 1,  1), origin);
+	vec3 l = tap(source, level, p + ivec2(-1, -1), origin);
+	vec3 m = tap(source, level, p + ivec2( 1, -1), origin);
+
+	vec3 result = e*0.125;
+	result += (a+c+g+i)*0.03125;
+	result += (b+d+f+h)*0.0625;
+	result += (j+k+l+m)*0.125;
+	return result;
+}
+
+// bilinear image read with edge clamping, as the image can't be sampled
+vec3 sampleLevel(int level, vec2 texCoord)
+{
+	ivec2 size = imageSize(mips[level]);
+	vec2 position = texCoord * vec2(size) - 0.5;
+	ivec2 texel = ivec2(floor(position));
+	vec2 weight = position - vec2(texel);
+	vec3 bottom = mix(loadTexel(FROM_IMAGE, level, texel, ivec2(0)), loadTexel(FROM_IMAGE, level, texel + ivec2(1, 0), ivec2(0)), weight.x);
+	vec3 top = mix(loadTexel(FROM_IMAGE, level, texel + ivec2(0, 1), ivec2(0)), loadTexel(FROM_IMAGE, level, texel + ivec2(1, 1), ivec2(0)), weight.x);
+	return mix(bottom, top, weight.y);
+}
+
+// the 3x3 tent of 6.new_upsample.fs, added to the texel of the level below
+vec3 upsample(int level, vec2 texCoord)
+{
+	float x = filterRadius;
+	float y = filterRadius;
+	vec3 result = sampleLevel(level, texCoord) * 4.0;
+	result += (sampleLevel(level, vec2(texCoord.x,     texCoord.y + y)) + sampleLevel(level, vec2(texCoord.x - x, texCoord.y)) +
+	           sampleLevel(level, vec2(texCoord.x + x, texCoord.y))     + sampleLevel(level, vec2(texCoord.x,     texCoord.y - y))) * 2.0;
+	result += sampleLevel(level, vec2(texCoord.x - x, texCoord.y + y)) + sampleLevel(level, vec2(texCoord.x + x, texCoord.y + y)) +
+	          sampleLevel(level, vec2(texCoord.x - x, texCoord.y - y)) + sampleLevel(level, vec2(texCoord.x + x, texCoord.y - y));
+	return result * (1.0 / 16.0);
+}
+
+void main()
+{
+	int index = int(gl_LocalInvocationIndex);
+	ivec2 group = ivec2(gl_WorkGroupID.xy);
+
+	// 1. mip 0 from the color buffer; texels outside the level repeat its edge,
+	// like the clamped sampling of the fragment shader path
+	ivec2 size0 = imageSize(mips[0]);
+	ivec2 origin0 = group * TILE0 - 6;
+	for (int i = index; i < CACHE0 * CACHE0; i += THREADS)
+	{
+		ivec2 texel = origin0 + ivec2(i % CACHE0, i / CACHE0);
+		vec3 color = downsampleSource(clamp(texel, ivec2(0), size0 - 1), size0);
+		cache0[i] = packColor(color);
+		if (all(greaterThanEqual(texel, group * TILE0)) && all(lessThan(texel, min(group * TILE0 + TILE0, size0))))
+			imageStore(mips[0], texel, vec4(color, 1.0));
+	}
+	barrier();
+
+	// 2. mip 1 from the cached mip 0
+	ivec2 size1 = imageSize(mips[1]);
+	ivec2 origin1 = group * TILE1 - 2;
+	for (int i = index; i < CACHE1 * CACHE1; i += THREADS)
+	{
+		ivec2 texel = origin1 + ivec2(i % CACHE1, i / CACHE1);
+		vec3 color = downsample(FROM_CACHE0, 0, clamp(texel, ivec2(0), size1 - 1), origin0);
+		cache1[i] = packColor(color);
+		if (all(greaterThanEqual(texel, group * TILE1)) && all(lessThan(texel, min(group * TILE1 + TILE1, size1))))
+			imageStore(mips[1], texel, vec4(color, 1.0));
+	}
+	barrier();
+
+	// 3. mip 2 from the cached mip 1
+	ivec2 size2 = imageSize(mips[2]);
+	if (index < TILE2 * TILE2)
+	{
+		ivec2 texel = group * TILE2 + ivec2(index % TILE2, index / TILE2);
+		if (all(lessThan(texel, size2)))
+			imageStore(mips[2], texel, vec4(downsample(FROM_CACHE1, 1, texel, origin1), 1.0));
+	}
+
+	// 4. the tile is done; only the last group to get here continues
+	memoryBarrierImage();
+	barrier();
+	if (index == 0)
+	{
+		uint groups = gl_NumWorkGroups.x * gl_NumWorkGroups.y;
+		lastGroup = atomicAdd(finishedGroups, 1u) == groups - 1u;
+	}
+	barrier();
+	// (barriers are only allowed in uniform control flow, so no early return)
+	if (lastGroup)
+	{
+		// 5. the remaining mips, each from the level above, read from the images
+		// all other groups wrote
+		for (int level = LOCAL_MIPS; level < mipCount; ++level)
+		{
+			ivec2 size = imageSize(mips[level]);
+			for (int i = index; i < size.x * size.y; i += THREADS)
+			{
+				ivec2 texel = ivec2(i % size.x, i / size.x);
+				imageStore(mips[level], texel, vec4(downsample(FROM_IMAGE, level - 1, texel, ivec2(0)), 1.0));
+			}
+			memoryBarrierImage();
+			barrier();
+		}
+
+		// 6. while this group still owns the small mips, it upsamples them into each
+		// other as well, down to the last local mip; the larger levels are upsampled
+		// by separate dispatches of 6.bloom_upsample.cs
+		for (int level = mipCount - 1; level > LOCAL_MIPS; --level)
+		{
+			ivec2 size = imageSize(mips[level - 1]);
+			for (int i = index; i < size.x * size.y; i += THREADS)
+			{
+				ivec2 texel = ivec2(i % size.x, i / size.x);
+				vec2 texCoord = (vec2(texel) + 0.5) / vec2(size);
+				vec3 color = imageLoad(mips[level - 1], texel).rgb + upsample(level, texCoord);
+				imageStore(mips[level - 1], texel, vec4(color, 1.0));
+			}
+			memoryBarrierImage();
+			barrier();
+		}
+
+		// ready for the next frame
+		if (index == 0)
+			finishedGroups = 0u;
+	}
+}
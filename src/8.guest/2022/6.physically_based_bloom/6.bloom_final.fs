@@ -8,6 +8,13 @@ uniform sampler2D bloomBlur;
 uniform float exposure;
 uniform float bloomStrength = 0.04f;
 uniform int programChoice;
+// the exposure measured by the auto exposure, the manual one then compensates it
+uniform bool useAutoExposure;
+layout (std140) uniform AutoExposure
+{
+    float adaptedExposure;
+    float averageLuminance;
+};
 
 vec3 bloom_none()
 {
@@ -42,7 +49,8 @@ void main()
         result = bloom_none(); break;
     }
     // tone mapping
-    result = vec3(1.0) - exp(-result * exposure);
+    float finalExposure = useAutoExposure ? adaptedExposure * exposure : exposure;
+    result = vec3(1.0) - exp(-result * finalExposure);
     // also gamma correct while we're at it
     const float gamma = 2.2;
     result = pow(result, vec3(1.0 / gamma));
@@ -0,0 +1,45 @@
+#version 430 core
+
+// Merged upsample: adds the 3x3 tent filtered level srcLevel to level
+// srcLevel - 1 of the same mip chain texture. Reading both levels in one
+// shader replaces the framebuffer switch and additive blending of the
+// fragment shader path (6.new_upsample.fs).
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// the mip chain, sampled at srcLevel only
+uniform sampler2D bloomMips;
+uniform int srcLevel;
+uniform float filterRadius;
+
+// level srcLevel - 1 of the mip chain
+layout (r11f_g11f_b10f, binding = 0) uniform image2D dstMip;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(dstMip);
+	if (texel.x >= size.x || texel.y >= size.y)
+		return;
+
+	vec2 texCoord = (vec2(texel) + 0.5) / vec2(size);
+	float x = filterRadius;
+	float y = filterRadius;
+	float lod = float(srcLevel);
+
+	vec3 a = textureLod(bloomMips, vec2(texCoord.x - x, texCoord.y + y), lod).rgb;
+	vec3 b = textureLod(bloomMips, vec2(texCoord.x,     texCoord.y + y), lod).rgb;
+	vec3 c = textureLod(bloomMips, vec2(texCoord.x + x, texCoord.y + y), lod).rgb;
+	vec3 d = textureLod(bloomMips, vec2(texCoord.x - x, texCoord.y), lod).rgb;
+	vec3 e = textureLod(bloomMips, vec2(texCoord.x,     texCoord.y), lod).rgb;
+	vec3 f = textureLod(bloomMips, vec2(texCoord.x + x, texCoord.y), lod).rgb;
+	vec3 g = textureLod(bloomMips, vec2(texCoord.x - x, texCoord.y - y), lod).rgb;
+	vec3 h = textureLod(bloomMips, vec2(texCoord.x,     texCoord.y - y), lod).rgb;
+	vec3 i = textureLod(bloomMips, vec2(texCoord.x + x, texCoord.y - y), lod).rgb;
+
+	vec3 upsample = e*4.0;
+	upsample += (b+d+f+h)*2.0;
+	upsample += (a+c+g+i);
+	upsample *= 1.0 / 16.0;
+
+	imageStore(dstMip, texel, vec4(imageLoad(dstMip, texel).rgb + upsample, 1.0));
+}
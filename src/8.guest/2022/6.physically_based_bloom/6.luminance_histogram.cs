@@ -0,0 +1,42 @@
+#version 430 core
+layout (local_size_x = 16, local_size_y = 16) in;
+
+// 256 bin histogram of the log2 luminance of the HDR color buffer. Bin 0 counts the (nearly) black pixels, bins
+// 1-255 split [minLogLuminance, minLogLuminance + range] evenly; brighter pixels go to the last bin.
+uniform sampler2D hdrBuffer;
+uniform float minLogLuminance;
+uniform float inverseLogLuminanceRange;
+
+layout (std430, binding = 0) buffer LuminanceHistogram
+{
+    uint histogram[256];
+};
+
+// every work group counts its pixels in shared memory first, so the global histogram only gets (at most) one
+// atomic add per bin and group instead of one per pixel
+shared uint bins[256];
+
+uint luminanceBin(vec3 color)
+{
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (luminance < exp2(minLogLuminance))
+        return 0u;
+    float position = clamp((log2(luminance) - minLogLuminance) * inverseLogLuminanceRange, 0.0, 1.0);
+    return uint(position * 254.0 + 1.0);
+}
+
+void main()
+{
+    bins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = textureSize(hdrBuffer, 0);
+    if (texel.x < size.x && texel.y < size.y)
+        atomicAdd(bins[luminanceBin(texelFetch(hdrBuffer, texel, 0).rgb)], 1u);
+    barrier();
+
+    uint count = bins[gl_LocalInvocationIndex];
+    if (count > 0u)
+        atomicAdd(histogram[gl_LocalInvocationIndex], count);
+}
@@ -8,8 +8,10 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/auto_exposure.h>
 
 #include <iostream>
 #include <vector>
@@ -27,8 +29,17 @@ const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 bool bloom = true;
 float exposure = 1.0f;
+// with auto exposure the measured exposure is used, scaled by the manual one as compensation
+bool autoExposure = true;
+bool autoExposureKeyPressed = false;
 int programChoice = 1;
 float bloomFilterRadius = 0.005f;
+// the physically based bloom's mip chain in a single compute dispatch or with a draw per mip
+bool singleDispatch = true;
+bool singleDispatchKeyPressed = false;
+// times both ways of building the mip chain at 1080p and 4K
+bool benchmarkBloom = false;
+bool benchmarkKeyPressed = false;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
@@ -45,9 +56,13 @@ struct bloomMip
 {
 	glm::vec2 size;
 	glm::ivec2 intSize;
-	unsigned int texture;
+	unsigned int level; // mip level of the bloom texture
 };
 
+// the mips the single dispatch downsample filters per work group (see 6.bloom_downsample.cs)
+const int SPD_LOCAL_MIPS = 3;
+const int SPD_MAX_MIPS = 8;
+
 class bloomFBO
 {
 public:
@@ -56,11 +71,15 @@ public:
 	bool Init(unsigned int windowWidth, unsigned int windowHeight, unsigned int mipChainLength);
 	void Destroy();
 	void BindForWriting();
+	void SampleOnlyLevel(int level);
+	void SampleAllLevels();
 	const std::vector<bloomMip>& MipChain() const;
+	unsigned int Texture() const;
 
 private:
 	bool mInit;
 	unsigned int mFBO;
+	unsigned int mTexture;
 	std::vector<bloomMip> mMipChain;
 };
 
@@ -82,6 +101,18 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
 		return false;
 	}
 
+	// the whole chain is a single texture: mip i of the bloom is mip level i,
+	// starting at half the window size
+	glGenTextures(1, &mTexture);
+	glBindTexture(GL_TEXTURE_2D, mTexture);
+	// we are downscaling an HDR color buffer, so we need a float texture format
+	glTexStorage2D(GL_TEXTURE_2D, mipChainLength, GL_R11F_G11F_B10F, (int)windowWidth / 2, (int)windowHeight / 2);
+	// levels are selected explicitly (textureLod or the base/max level), so no filtering between them
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
 	for (GLuint i = 0; i < mipChainLength; i++)
 	{
 		bloomMip mip;
@@ -90,24 +121,14 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
 		mipIntSize /= 2;
 		mip.size = mipSize;
 		mip.intSize = mipIntSize;
-
-		glGenTextures(1, &mip.texture);
-		glBindTexture(GL_TEXTURE_2D, mip.texture);
-		// we are downscaling an HDR color buffer, so we need a float texture format
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F,
-		             (int)mipSize.x, (int)mipSize.y,
-		             0, GL_RGB, GL_FLOAT, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		mip.level = i;
 
 		std::cout << "Created bloom mip " << mipIntSize.x << 'x' << mipIntSize.y << std::endl;
 		mMipChain.emplace_back(mip);
 	}
 
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-	                       GL_TEXTURE_2D, mMipChain[0].texture, 0);
+	                       GL_TEXTURE_2D, mTexture, 0);
 
 	// setup attachments
 	unsigned int attachments[1] = { GL_COLOR_ATTACHMENT0 };
@@ -129,10 +150,9 @@ bool bloomFBO::Init(unsigned int windowWidth, unsigned int windowHeight, unsigne
 
 void bloomFBO::Destroy()
 {
-	for (int i = 0; i < (int)mMipChain.size(); i++) {
-		glDeleteTextures(1, &mMipChain[i].texture);
-		mMipChain[i].texture = 0;
-	}
+	glDeleteTextures(1, &mTexture);
+	mTexture = 0;
+	mMipChain.clear();
 	glDeleteFramebuffers(1, &mFBO);
 	mFBO = 0;
 	mInit = false;
@@ -143,11 +163,31 @@ void bloomFBO::BindForWriting()
 	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
 }
 
+// Restricts sampling of the (bound) bloom texture to one level, so another level
+// can be rendered to without forming a feedback loop
+void bloomFBO::SampleOnlyLevel(int level)
+{
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+}
+
+void bloomFBO::SampleAllLevels()
+{
+	glBindTexture(GL_TEXTURE_2D, mTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)mMipChain.size() - 1);
+}
+
 const std::vector<bloomMip>& bloomFBO::MipChain() const
 {
 	return mMipChain;
 }
 
+unsigned int bloomFBO::Texture() const
+{
+	return mTexture;
+}
+
 
 
 class BloomRenderer
@@ -159,11 +199,14 @@ public:
 	void Destroy();
 	void RenderBloomTexture(unsigned int srcTexture, float filterRadius);
 	unsigned int BloomTexture();
-	unsigned int BloomMip_i(int index);
+	void SetSingleDispatch(bool singleDispatch);
+	bool SingleDispatch() const;
 
 private:
 	void RenderDownsamples(unsigned int srcTexture);
 	void RenderUpsamples(float filterRadius);
+	void RenderDownsamplesCompute(unsigned int srcTexture, float filterRadius);
+	void RenderUpsamplesCompute(float filterRadius);
 
 	bool mInit;
 	bloomFBO mFBO;
@@ -171,8 +214,12 @@ private:
 	glm::vec2 mSrcViewportSizeFloat;
 	Shader* mDownsampleShader;
 	Shader* mUpsampleShader;
+	ComputeShader* mDownsampleCompute;
+	ComputeShader* mUpsampleCompute;
+	unsigned int mCounterBuffer;
 
 	bool mKarisAverageOnDownsample = true;
+	bool mSingleDispatch = true;
 };
 
 BloomRenderer::BloomRenderer() : mInit(false) {}
@@ -186,6 +233,7 @@ bool BloomRenderer::Init(unsigned int windowWidth, unsigned int windowHeight)
 
 	// Framebuffer
 	const unsigned int num_bloom_mips = 6; // TODO: Play around with this value
+	static_assert(num_bloom_mips >= SPD_LOCAL_MIPS && num_bloom_mips <= SPD_MAX_MIPS, "mip count not supported by the single dispatch downsample");
 	bool status = mFBO.Init(windowWidth, windowHeight, num_bloom_mips);
 	if (!status) {
 		std::cerr << "Failed to initialize bloom FBO - cannot create bloom renderer!\n";
@@ -195,17 +243,32 @@ bool BloomRenderer::Init(unsigned int windowWidth, unsigned int windowHeight)
 	// Shaders
 	mDownsampleShader = new Shader("6.new_downsample.vs", "6.new_downsample.fs");
     mUpsampleShader = new Shader("6.new_upsample.vs", "6.new_upsample.fs");
+	mDownsampleCompute = new ComputeShader("6.bloom_downsample.cs");
+	mUpsampleCompute = new ComputeShader("6.bloom_upsample.cs");
 
 	// Downsample
     mDownsampleShader->use();
     mDownsampleShader->setInt("srcTexture", 0);
+    mDownsampleCompute->use();
+    mDownsampleCompute->setInt("srcTexture", 0);
+    mDownsampleCompute->setInt("mipCount", num_bloom_mips);
     glUseProgram(0);
 
     // Upsample
     mUpsampleShader->use();
     mUpsampleShader->setInt("srcTexture", 0);
+    mUpsampleCompute->use();
+    mUpsampleCompute->setInt("bloomMips", 0);
     glUseProgram(0);
 
+	// the single dispatch downsample's count of finished work groups, it resets it itself
+	unsigned int zero = 0;
+	glGenBuffers(1, &mCounterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCounterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zero), &zero, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    mInit = true;
     return true;
 }
 
@@ -214,6 +277,10 @@ void BloomRenderer::Destroy()
 	mFBO.Destroy();
 	delete mDownsampleShader;
 	delete mUpsampleShader;
+	delete mDownsampleCompute;
+	delete mUpsampleCompute;
+	glDeleteBuffers(1, &mCounterBuffer);
+	mInit = false;
 }
 
 void BloomRenderer::RenderDownsamples(unsigned int srcTexture)
@@ -236,7 +303,7 @@ void BloomRenderer::RenderDownsamples(unsigned int srcTexture)
 		const bloomMip& mip = mipChain[i];
 		glViewport(0, 0, mip.size.x, mip.size.y);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-		                       GL_TEXTURE_2D, mip.texture, 0);
+		                       GL_TEXTURE_2D, mFBO.Texture(), mip.level);
 
 		// Render screen-filled quad of resolution of current mip
 		renderQuad();
@@ -244,7 +311,8 @@ void BloomRenderer::RenderDownsamples(unsigned int srcTexture)
 		// Set current mip resolution as srcResolution for next iteration
 		mDownsampleShader->setVec2("srcResolution", mip.size);
 		// Set current mip as texture input for next iteration
-		glBindTexture(GL_TEXTURE_2D, mip.texture);
+		glBindTexture(GL_TEXTURE_2D, mFBO.Texture());
+		mFBO.SampleOnlyLevel(mip.level);
 		// Disable Karis average for consequent downsamples
 		if (i == 0) { mDownsampleShader->setInt("mipLevel", 1); }
 	}
@@ -271,12 +339,13 @@ void BloomRenderer::RenderUpsamples(float filterRadius)
 
 		// Bind viewport and texture from where to read
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mip.texture);
+		glBindTexture(GL_TEXTURE_2D, mFBO.Texture());
+		mFBO.SampleOnlyLevel(mip.level);
 
 		// Set framebuffer render target (we write to this texture)
 		glViewport(0, 0, nextMip.size.x, nextMip.size.y);
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-		                       GL_TEXTURE_2D, nextMip.texture, 0);
+		                       GL_TEXTURE_2D, mFBO.Texture(), nextMip.level);
 
 		// Render screen-filled quad of resolution of current mip
 		renderQuad();
@@ -289,12 +358,70 @@ void BloomRenderer::RenderUpsamples(float filterRadius)
 	glUseProgram(0);
 }
 
+// The whole downsample chain in one dispatch: one work group per 32x32 texels of
+// mip 0, so each covers its 16x16 texels of mip 1 and 8x8 of mip 2 as well
+void BloomRenderer::RenderDownsamplesCompute(unsigned int srcTexture, float filterRadius)
+{
+	const std::vector<bloomMip>& mipChain = mFBO.MipChain();
+
+	mDownsampleCompute->use();
+	mDownsampleCompute->setFloat("filterRadius", filterRadius);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, srcTexture);
+	for (int i = 0; i < (int)mipChain.size(); i++)
+		glBindImageTexture(i, mFBO.Texture(), mipChain[i].level, GL_FALSE, 0, GL_READ_WRITE, GL_R11F_G11F_B10F);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mCounterBuffer);
+
+	// the size of every level is rounded down, so it takes the largest group count of the three
+	glm::ivec2 groups(0);
+	for (int i = 0; i < SPD_LOCAL_MIPS; i++)
+	{
+		const int tile = 32 >> i;
+		groups = glm::max(groups, (mipChain[i].intSize + tile - 1) / tile);
+	}
+	glDispatchCompute(groups.x, groups.y, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	glUseProgram(0);
+}
+
+// The downsample already upsampled the mips below SPD_LOCAL_MIPS; the rest take
+// a dispatch per level, each adding the level below to its own texels in place
+void BloomRenderer::RenderUpsamplesCompute(float filterRadius)
+{
+	const std::vector<bloomMip>& mipChain = mFBO.MipChain();
+
+	mUpsampleCompute->use();
+	mUpsampleCompute->setFloat("filterRadius", filterRadius);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, mFBO.Texture());
+
+	for (int i = glm::min(SPD_LOCAL_MIPS, (int)mipChain.size() - 1); i > 0; i--)
+	{
+		const bloomMip& nextMip = mipChain[i-1];
+		mUpsampleCompute->setInt("srcLevel", mipChain[i].level);
+		glBindImageTexture(0, mFBO.Texture(), nextMip.level, GL_FALSE, 0, GL_READ_WRITE, GL_R11F_G11F_B10F);
+		glDispatchCompute((nextMip.intSize.x + 7) / 8, (nextMip.intSize.y + 7) / 8, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	glUseProgram(0);
+}
+
 void BloomRenderer::RenderBloomTexture(unsigned int srcTexture, float filterRadius)
 {
+	if (mSingleDispatch)
+	{
+		this->RenderDownsamplesCompute(srcTexture, filterRadius);
+		this->RenderUpsamplesCompute(filterRadius);
+		return;
+	}
+
 	mFBO.BindForWriting();
 
 	this->RenderDownsamples(srcTexture);
 	this->RenderUpsamples(filterRadius);
+	mFBO.SampleAllLevels();
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	// Restore viewport
@@ -303,26 +430,25 @@ void BloomRenderer::RenderBloomTexture(unsigned int srcTexture, float filterRadi
 
 GLuint BloomRenderer::BloomTexture()
 {
-	return mFBO.MipChain()[0].texture;
+	return mFBO.Texture();
 }
 
-GLuint BloomRenderer::BloomMip_i(int index)
+void BloomRenderer::SetSingleDispatch(bool singleDispatch)
 {
-	const std::vector<bloomMip>& mipChain = mFBO.MipChain();
-	int size = (int)mipChain.size();
-	return mipChain[(index > size-1) ? size-1 : (index < 0) ? 0 : index].texture;
+	mSingleDispatch = singleDispatch;
 }
 
-
-
-
-
+bool BloomRenderer::SingleDispatch() const
+{
+	return mSingleDispatch;
+}
 int main()
 {
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // the single dispatch bloom requires OpenGL 4.3
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -449,12 +575,27 @@ int main()
     shaderBloomFinal.use();
     shaderBloomFinal.setInt("scene", 0);
     shaderBloomFinal.setInt("bloomBlur", 1);
+    glUniformBlockBinding(shaderBloomFinal.ID, glGetUniformBlockIndex(shaderBloomFinal.ID, "AutoExposure"), 0);
+
+    // auto exposure, measured on the scene before the bloom is added
+    AutoExposure exposureMeter("6.luminance_histogram.cs", "6.luminance_average.cs");
 
     // bloom renderer
     // --------------
     BloomRenderer bloomRenderer;
     bloomRenderer.Init(SCR_WIDTH, SCR_HEIGHT);
 
+    // timing of the bloom
+    unsigned int bloomQuery;
+    glGenQueries(1, &bloomQuery);
+    unsigned int frameCount = 0;
+    unsigned int timedFrames = 0;
+    double bloomTimeSum = 0.0;
+    bool bloomQueryPending = false;
+
+    std::cout << "Press 1-3 to select the bloom, C to switch between the single dispatch and per mip physically based bloom, "
+              << "T to time both at 1080p and 4K, X to toggle the auto exposure" << std::endl;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -589,9 +730,80 @@ int main()
         // -------------------------------------------------------------------
         else if (programChoice == 3)
         {
+	        // the previous frame's timing is read before its query is reused
+	        if (bloomQueryPending)
+	        {
+		        GLuint64 elapsed = 0;
+		        glGetQueryObjectui64v(bloomQuery, GL_QUERY_RESULT, &elapsed);
+		        bloomTimeSum += elapsed / 1000000.0;
+		        timedFrames++;
+	        }
+	        bloomRenderer.SetSingleDispatch(singleDispatch);
+	        glBeginQuery(GL_TIME_ELAPSED, bloomQuery);
 	        bloomRenderer.RenderBloomTexture(colorBuffers[1], bloomFilterRadius);
+	        glEndQuery(GL_TIME_ELAPSED);
+	        bloomQueryPending = true;
+        }
+
+        // benchmark: both mip chain paths at 1080p and 4K, on the bright color buffer scaled up to these resolutions
+        // ---------------------------------------------------------------------------------------------------------
+        if (benchmarkBloom)
+        {
+	        benchmarkBloom = false;
+	        const unsigned int resolutions[2][2] = { { 1920, 1080 }, { 3840, 2160 } };
+	        const unsigned int REPEATS = 10;
+	        const char *pathNames[2] = { "per mip", "single dispatch" };
+	        if (bloomQueryPending)
+	        {
+		        GLuint64 elapsed = 0;
+		        glGetQueryObjectui64v(bloomQuery, GL_QUERY_RESULT, &elapsed);
+		        bloomQueryPending = false;
+	        }
+	        for (unsigned int r = 0; r < 2; ++r)
+	        {
+		        BloomRenderer renderer;
+		        renderer.Init(resolutions[r][0], resolutions[r][1]);
+		        unsigned int brightTexture, brightFBO;
+		        glGenTextures(1, &brightTexture);
+		        glBindTexture(GL_TEXTURE_2D, brightTexture);
+		        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, resolutions[r][0], resolutions[r][1], 0, GL_RGBA, GL_FLOAT, NULL);
+		        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		        glGenFramebuffers(1, &brightFBO);
+		        glBindFramebuffer(GL_FRAMEBUFFER, brightFBO);
+		        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brightTexture, 0);
+		        glBindFramebuffer(GL_READ_FRAMEBUFFER, hdrFBO);
+		        glReadBuffer(GL_COLOR_ATTACHMENT1);
+		        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, resolutions[r][0], resolutions[r][1], GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		        glReadBuffer(GL_COLOR_ATTACHMENT0);
+		        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		        std::cout << resolutions[r][0] << "x" << resolutions[r][1] << ":";
+		        for (unsigned int path = 0; path < 2; ++path)
+		        {
+			        renderer.SetSingleDispatch(path == 1);
+			        renderer.RenderBloomTexture(brightTexture, bloomFilterRadius); // warm up
+			        glBeginQuery(GL_TIME_ELAPSED, bloomQuery);
+			        for (unsigned int i = 0; i < REPEATS; ++i)
+				        renderer.RenderBloomTexture(brightTexture, bloomFilterRadius);
+			        glEndQuery(GL_TIME_ELAPSED);
+			        GLuint64 elapsed = 0;
+			        glGetQueryObjectui64v(bloomQuery, GL_QUERY_RESULT, &elapsed);
+			        std::cout << " " << pathNames[path] << " " << elapsed / 1000000.0 / REPEATS << " ms";
+		        }
+		        std::cout << std::endl;
+		        renderer.Destroy();
+		        glDeleteFramebuffers(1, &brightFBO);
+		        glDeleteTextures(1, &brightTexture);
+	        }
+	        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
         }
 
+        // measure the scene's luminance and adapt the exposure, all on the GPU
+        if (autoExposure)
+            exposureMeter.Update(colorBuffers[0], SCR_WIDTH, SCR_HEIGHT, deltaTime);
+
         // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -608,11 +820,19 @@ int main()
         else if (programChoice == 3) {
 	        glBindTexture(GL_TEXTURE_2D, bloomRenderer.BloomTexture());
         }
+        exposureMeter.Bind(0);
         shaderBloomFinal.setInt("programChoice", programChoice);
+        shaderBloomFinal.setBool("useAutoExposure", autoExposure);
         shaderBloomFinal.setFloat("exposure", exposure);
         renderQuad();
 
         //std::cout << "bloom: " << (bloom ? "on" : "off") << "| exposure: " << exposure << std::endl;
+        if (++frameCount % 120 == 0 && timedFrames > 0)
+        {
+            std::cout << (singleDispatch ? "single dispatch" : "per mip") << " bloom: " << bloomTimeSum / timedFrames << " ms" << std::endl;
+            bloomTimeSum = 0.0;
+            timedFrames = 0;
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -621,6 +841,8 @@ int main()
     }
 
     bloomRenderer.Destroy();
+    exposureMeter.Delete();
+    glDeleteQueries(1, &bloomQuery);
     glfwTerminate();
     return 0;
 }
@@ -771,6 +993,38 @@ void processInput(GLFWwindow *window)
     {
 	    programChoice = 3;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !autoExposureKeyPressed)
+    {
+	    autoExposure = !autoExposure;
+	    std::cout << "auto exposure: " << (autoExposure ? "on" : "off") << std::endl;
+	    autoExposureKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE)
+    {
+	    autoExposureKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !singleDispatchKeyPressed)
+    {
+	    singleDispatch = !singleDispatch;
+	    std::cout << "physically based bloom: " << (singleDispatch ? "single dispatch" : "per mip") << std::endl;
+	    singleDispatchKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE)
+    {
+	    singleDispatchKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+	    benchmarkBloom = true;
+	    benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+	    benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -20,13 +20,13 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/ltc_tables.h>
 
 // STANDARD
 #include <iostream>
 #include <vector>
 
 // CUSTOM
-#include "../ltc_matrix.hpp"
 #include "../colors.hpp" // LOOK FOR DIFFERENT COLORS!
 
 // FUNCTION PROTOTYPES
@@ -162,49 +162,6 @@ void renderAreaLight()
 
 
 
-struct LTC_matrices {
-	GLuint mat1;
-	GLuint mat2;
-};
-
-GLuint loadMTexture()
-{
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64,
-	             0, GL_RGBA, GL_FLOAT, LTC1);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	return texture;
-}
-
-GLuint loadLUTTexture()
-{
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64,
-	             0, GL_RGBA, GL_FLOAT, LTC2);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	return texture;
-}
-
-
-
 void incrementRoughness(float step)
 {
 	static glm::vec3 color = Color::SlateGray;
@@ -285,9 +242,12 @@ int main()
     glEnable(GL_DEPTH_TEST);
 
     // LUT textures
-    LTC_matrices mLTC;
-    mLTC.mat1 = loadMTexture();
-    mLTC.mat2 = loadLUTTexture();
+    LTCTextures mLTC;
+    if (!LTCTables::Load(FileSystem::getPath("resources/textures/ltc/ltc_tables.bin"), mLTC))
+    {
+        glfwTerminate();
+        return -1;
+    }
 
     // SHADERS
     Shader shaderLTC("7.area_light.vs", "7.area_light.fs");
@@ -353,9 +313,9 @@ int main()
 		shaderLTC.setVec3("areaLightTranslate", areaLightTranslate);
 
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mLTC.mat1);
+		glBindTexture(GL_TEXTURE_2D, mLTC.LTC1);
 		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, mLTC.mat2);
+		glBindTexture(GL_TEXTURE_2D, mLTC.LTC2);
 		glActiveTexture(GL_TEXTURE2);
 		glBindTexture(GL_TEXTURE_2D, concreteTexture);
 		renderPlane();
@@ -376,6 +336,8 @@ int main()
     glDeleteBuffers(1, &planeVBO);
     glDeleteVertexArrays(1, &areaLightVAO);
     glDeleteBuffers(1, &areaLightVBO);
+    glDeleteTextures(1, &mLTC.LTC1);
+    glDeleteTextures(1, &mLTC.LTC2);
 
     glfwTerminate();
     return 0;
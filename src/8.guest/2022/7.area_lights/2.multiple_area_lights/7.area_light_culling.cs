@@ -0,0 +1,107 @@
+#version 430 core
+
+// Culls the area lights into 16x16 pixel screen tiles: every work group bounds
+// the depth of its tile from the depth pre-pass and keeps the lights whose
+// bounding spheres intersect the tile's frustum between those depths.
+layout (local_size_x = 16, local_size_y = 16) in;
+
+struct AreaLight
+{
+	vec4 points[4];
+	vec3 color;
+	float intensity;
+	vec3 center; // bounding sphere of the light's reach
+	float radius;
+	int twoSided;
+};
+
+layout (std430, binding = 0) readonly buffer AreaLights
+{
+	AreaLight areaLights[];
+};
+
+// per tile: the light count followed by MAX_AREA_LIGHTS light indices
+layout (std430, binding = 1) writeonly buffer TileLights
+{
+	uint tileLights[];
+};
+
+uniform sampler2D depthMap;
+uniform mat4 view;
+uniform mat4 inverseProjection;
+uniform int numAreaLights;
+
+const uint MAX_AREA_LIGHTS = 256;
+
+shared uint minDepthBits;
+shared uint maxDepthBits;
+shared uint tileLightCount;
+shared uint tileLightIndices[MAX_AREA_LIGHTS];
+
+vec3 viewPosition(vec2 ndc, float depth)
+{
+	vec4 position = inverseProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+	return position.xyz / position.w;
+}
+
+void main()
+{
+	if (gl_LocalInvocationIndex == 0)
+	{
+		minDepthBits = floatBitsToUint(1.0);
+		maxDepthBits = 0;
+		tileLightCount = 0;
+	}
+	barrier();
+
+	// depth bounds of the tile; non-negative floats compare like their bits
+	ivec2 size = textureSize(depthMap, 0);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (texel.x < size.x && texel.y < size.y)
+	{
+		float depth = texelFetch(depthMap, texel, 0).r;
+		if (depth < 1.0)
+		{
+			atomicMin(minDepthBits, floatBitsToUint(depth));
+			atomicMax(maxDepthBits, floatBitsToUint(depth));
+		}
+	}
+	barrier();
+
+	uint offset = (gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x) * (MAX_AREA_LIGHTS + 1);
+
+	// a tile that only shows the background keeps no lights
+	uint lightCount = maxDepthBits == 0u ? 0u : uint(numAreaLights);
+	float nearZ = viewPosition(vec2(0.0), uintBitsToFloat(minDepthBits)).z;
+	float farZ = viewPosition(vec2(0.0), uintBitsToFloat(maxDepthBits)).z;
+
+	// the tile's side planes through the eye, with outward normals
+	vec2 tileMin = vec2(gl_WorkGroupID.xy * gl_WorkGroupSize.xy) / vec2(size) * 2.0 - 1.0;
+	vec2 tileMax = min(vec2((gl_WorkGroupID.xy + 1) * gl_WorkGroupSize.xy) / vec2(size), vec2(1.0)) * 2.0 - 1.0;
+	vec3 corners[4];
+	corners[0] = viewPosition(tileMin, 1.0);
+	corners[1] = viewPosition(vec2(tileMax.x, tileMin.y), 1.0);
+	corners[2] = viewPosition(tileMax, 1.0);
+	corners[3] = viewPosition(vec2(tileMin.x, tileMax.y), 1.0);
+	vec3 planes[4];
+	for (int i = 0; i < 4; i++)
+		planes[i] = normalize(cross(corners[i], corners[(i + 1) % 4]));
+
+	// every invocation tests a share of the lights
+	for (uint i = gl_LocalInvocationIndex; i < lightCount; i += gl_WorkGroupSize.x * gl_WorkGroupSize.y)
+	{
+		vec3 center = vec3(view * vec4(areaLights[i].center, 1.0));
+		float radius = areaLights[i].radius;
+		bool visible = center.z - radius <= nearZ && center.z + radius >= farZ;
+		for (int j = 0; j < 4; j++)
+			visible = visible && dot(planes[j], center) <= radius;
+		if (visible)
+			tileLightIndices[atomicAdd(tileLightCount, 1u)] = i;
+	}
+	barrier();
+
+	for (uint i = gl_LocalInvocationIndex; i < tileLightCount; i += gl_WorkGroupSize.x * gl_WorkGroupSize.y)
+		tileLights[offset + 1 + i] = tileLightIndices[i];
+	if (gl_LocalInvocationIndex == 0)
+		tileLights[offset] = tileLightCount;
+}
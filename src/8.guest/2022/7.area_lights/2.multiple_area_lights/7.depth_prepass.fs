@@ -0,0 +1,6 @@
+#version 430 core
+
+// depth only, for the light culling
+void main()
+{
+}
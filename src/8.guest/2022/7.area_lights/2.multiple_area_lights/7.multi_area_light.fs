@@ -1,4 +1,4 @@
-#version 330 core
+#version 430 core
 
 out vec4 fragColor;
 
@@ -8,14 +8,32 @@ in vec2 texcoord;
 
 struct AreaLight
 {
-    float intensity;
+	vec4 points[4];
 	vec3 color;
-    vec3 points[4];
-	bool twoSided;
+	float intensity;
+	vec3 center; // bounding sphere of the light's reach
+	float radius;
+	int twoSided;
+};
+layout (std430, binding = 0) readonly buffer AreaLights
+{
+	AreaLight areaLights[];
 };
-uniform AreaLight areaLights[32];
 uniform int numAreaLights;
 
+// lights of each 16x16 pixel tile: the count followed by MAX_AREA_LIGHTS indices
+layout (std430, binding = 1) readonly buffer TileLights
+{
+	uint tileLights[];
+};
+uniform bool tiledCulling;
+uniform int tilesX;
+const int TILE_SIZE = 16;
+const int MAX_AREA_LIGHTS = 256;
+
+// distance past the light's rectangle over which its contribution fades out
+uniform float lightRange;
+
 struct Material
 {
 	sampler2D diffuse;
@@ -111,6 +129,16 @@ vec3 LTC_Evaluate(vec3 N, vec3 V, vec3 P, mat3 Minv, vec3 points[4], bool twoSid
     return Lo_i;
 }
 
+// Fades a light out towards the edge of its bounding sphere, so the lights
+// culled from a tile are the ones that don't contribute to it anyway
+float Window(AreaLight light, vec3 P)
+{
+    float extent = light.radius - lightRange;
+    float d = max(length(P - light.center) - extent, 0.0f) / lightRange;
+    float falloff = clamp(1.0f - d*d*d*d, 0.0f, 1.0f);
+    return falloff*falloff;
+}
+
 // PBR-maps for roughness (and metallic) are usually stored in non-linear
 // color space (sRGB), so we use these functions to convert into linear RGB.
 vec3 PowVec3(vec3 v, float p)
@@ -152,12 +180,28 @@ void main()
         vec3(t1.z, 0, t1.w)
     );
 
-	// iterate through all area lights
-	for (int i = 0; i < numAreaLights; i++)
+	// iterate through the lights of the fragment's tile or all area lights
+	int tileOffset = 0;
+	int lightCount = numAreaLights;
+	if (tiledCulling)
 	{
+		ivec2 tile = ivec2(gl_FragCoord.xy) / TILE_SIZE;
+		tileOffset = (tile.y * tilesX + tile.x) * (MAX_AREA_LIGHTS + 1);
+		lightCount = int(tileLights[tileOffset]);
+	}
+	for (int l = 0; l < lightCount; l++)
+	{
+		int i = tiledCulling ? int(tileLights[tileOffset + 1 + l]) : l;
+		float window = Window(areaLights[i], P);
+		if (window == 0.0f)
+			continue;
+
 		// Evaluate LTC shading
-		vec3 diffuse = LTC_Evaluate(N, V, P, mat3(1), areaLights[i].points, areaLights[i].twoSided);
-		vec3 specular = LTC_Evaluate(N, V, P, Minv, areaLights[i].points, areaLights[i].twoSided);
+		vec3 points[4] = vec3[4](areaLights[i].points[0].xyz, areaLights[i].points[1].xyz,
+		                         areaLights[i].points[2].xyz, areaLights[i].points[3].xyz);
+		bool twoSided = areaLights[i].twoSided != 0;
+		vec3 diffuse = LTC_Evaluate(N, V, P, mat3(1), points, twoSided);
+		vec3 specular = LTC_Evaluate(N, V, P, Minv, points, twoSided);
 
 		// GGX BRDF shadowing and Fresnel
 		// t2.x: shadowedF90 (F90 normally it should be 1.0)
@@ -165,7 +209,7 @@ void main()
 		specular *= mSpecular*t2.x + (1.0f - mSpecular) * t2.y;
 
 		// Add contribution
-		result += areaLights[i].color * areaLights[i].intensity * (specular + mDiffuse * diffuse);
+		result += areaLights[i].color * areaLights[i].intensity * window * (specular + mDiffuse * diffuse);
 		//result += vec3(0.5, 0.5, 0.5);
 	}
 
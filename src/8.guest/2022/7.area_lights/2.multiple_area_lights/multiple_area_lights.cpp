@@ -18,8 +18,10 @@
 // LEARNOPENGL
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/ltc_tables.h>
 
 // STANDARD
 #include <iostream>
@@ -27,9 +29,9 @@
 #include <functional>
 #include <chrono>
 #include <random>
+#include <algorithm>
 
 // CUSTOM
-#include "../ltc_matrix.hpp"
 #include "../colors.hpp" // LOOK FOR DIFFERENT COLORS!
 
 // FUNCTION PROTOTYPES
@@ -47,9 +49,17 @@ const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 const glm::vec3 LIGHT_COLOR = Color::BurlyWood; // CHANGE AREA LIGHT COLOR HERE!
 bool keys[1024]; // activated keys
-const int NUM_AREA_LIGHTS = 16;
+const int MAX_AREA_LIGHTS = 256;
+int numAreaLights = 16;
 Shader* ltcShaderPtr;
 
+// LIGHT CULLING
+// every light fades out over this distance past its rectangle, so its reach can be bounded by a sphere
+const float LIGHT_RANGE = 4.0f;
+const int TILE_SIZE = 16;
+bool tiledCulling = true;
+bool benchmarkLights = false;
+
 // camera
 Camera camera(glm::vec3(-0.224556, 10.4038, -18.9259), glm::vec3(0.0f, 1.0f, 0.0f), 89.3999, -34.3001);
 float lastX = (float)SCR_WIDTH / 2.0;
@@ -76,7 +86,18 @@ struct AreaLight {
 	bool twoSided = true;
 };
 
-AreaLight areaLights[NUM_AREA_LIGHTS];
+AreaLight areaLights[MAX_AREA_LIGHTS];
+
+// the area lights as the shaders' storage buffer holds them (std430)
+struct GPUAreaLight {
+	glm::vec4 points[4];
+	glm::vec3 color;
+	float intensity;
+	glm::vec3 center; // bounding sphere of the light's reach
+	float radius;
+	int twoSided;
+	int padding[3];
+};
 
 
 //
@@ -116,7 +137,7 @@ void configureAreaLights()
 	std::default_random_engine generator(seed);
 	std::function<float(void)> fn =
 		[&random_floats, &generator]{ return random_floats(generator); };
-	for (int i = 0; i < NUM_AREA_LIGHTS; i++)
+	for (int i = 0; i < MAX_AREA_LIGHTS; i++)
 	{
 		float x = fn(); x = (x > 0.5f) ? x : -x;
 		float z = fn(); z = (z > 0.5f) ? z : -z;
@@ -196,49 +217,6 @@ void renderAreaLight()
 
 
 
-struct LTC_matrices {
-	GLuint mat1;
-	GLuint mat2;
-};
-
-GLuint loadMTexture()
-{
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64,
-	             0, GL_RGBA, GL_FLOAT, LTC1);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	return texture;
-}
-
-GLuint loadLUTTexture()
-{
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64,
-	             0, GL_RGBA, GL_FLOAT, LTC2);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	glBindTexture(GL_TEXTURE_2D, 0);
-	return texture;
-}
-
-
-
 void incrementRoughness(float step)
 {
 	static glm::vec3 color = Color::SlateGray;
@@ -279,8 +257,8 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // the light culling requires OpenGL 4.3
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
 #ifdef __APPLE__
@@ -319,14 +297,19 @@ int main()
     glEnable(GL_DEPTH_TEST);
 
     // LUT textures
-    LTC_matrices mLTC;
-    mLTC.mat1 = loadMTexture();
-    mLTC.mat2 = loadLUTTexture();
+    LTCTextures mLTC;
+    if (!LTCTables::Load(FileSystem::getPath("resources/textures/ltc/ltc_tables.bin"), mLTC))
+    {
+        glfwTerminate();
+        return -1;
+    }
 
     // SHADERS
     Shader shaderLTC("7.multi_area_light.vs", "7.multi_area_light.fs");
     ltcShaderPtr = &shaderLTC;
     Shader shaderLightPlane("7.light_plane.vs", "7.light_plane.fs");
+    Shader shaderDepthPrepass("7.multi_area_light.vs", "7.depth_prepass.fs");
+    ComputeShader shaderLightCulling("7.area_light_culling.cs");
 
     // TEXTURES
     unsigned int concreteTexture = loadTexture(
@@ -337,31 +320,65 @@ int main()
 	configureAreaLights();
 
     // SHADER CONFIGURATION
-    shaderLTC.use();
-    for (int i = 0; i < NUM_AREA_LIGHTS; i++)
+    // all lights go to a storage buffer, the shaders use the first numAreaLights of them
+    std::vector<GPUAreaLight> gpuAreaLights(MAX_AREA_LIGHTS);
+    for (int i = 0; i < MAX_AREA_LIGHTS; i++)
 	{
 		glm::mat4 model(1.0f);
 		model = glm::translate(model, areaLights[i].offset);
 		model = glm::rotate(model, areaLights[i].yRotation, glm::vec3(0.0f, 1.0f, 0.0f));
 
-		glm::vec3 p0 = glm::vec3(model * glm::vec4(areaLightVertices[0].position, 1.0f));
-		glm::vec3 p1 = glm::vec3(model * glm::vec4(areaLightVertices[1].position, 1.0f));
-		glm::vec3 p2 = glm::vec3(model * glm::vec4(areaLightVertices[4].position, 1.0f));
-		glm::vec3 p3 = glm::vec3(model * glm::vec4(areaLightVertices[5].position, 1.0f));
-
-		std::string str_pos = "areaLights[" + std::to_string(i) + "].points";
-		std::string str_col = "areaLights[" + std::to_string(i) + "].color";
-		std::string str_int = "areaLights[" + std::to_string(i) + "].intensity";
-		std::string str_two = "areaLights[" + std::to_string(i) + "].twoSided";
-		shaderLTC.setVec3((str_pos + "[0]").c_str(), p0);
-		shaderLTC.setVec3((str_pos + "[1]").c_str(), p1);
-		shaderLTC.setVec3((str_pos + "[2]").c_str(), p2);
-		shaderLTC.setVec3((str_pos + "[3]").c_str(), p3);
-		shaderLTC.setVec3(str_col.c_str(), areaLights[i].color);
-		shaderLTC.setFloat(str_int.c_str(), 2.0f);
-		shaderLTC.setInt(str_two.c_str(), 1);
+		GPUAreaLight& light = gpuAreaLights[i];
+		light.points[0] = model * glm::vec4(areaLightVertices[0].position, 1.0f);
+		light.points[1] = model * glm::vec4(areaLightVertices[1].position, 1.0f);
+		light.points[2] = model * glm::vec4(areaLightVertices[4].position, 1.0f);
+		light.points[3] = model * glm::vec4(areaLightVertices[5].position, 1.0f);
+		light.color = areaLights[i].color;
+		light.intensity = 2.0f;
+		light.twoSided = 1;
+
+		// the sphere around the rectangle, grown by the range
+		light.center = glm::vec3(light.points[0] + light.points[1] + light.points[2] + light.points[3]) * 0.25f;
+		light.radius = glm::length(glm::vec3(light.points[0]) - light.center) + LIGHT_RANGE;
 	}
-	shaderLTC.setInt("numAreaLights", NUM_AREA_LIGHTS);
+	GLuint areaLightSSBO;
+	glGenBuffers(1, &areaLightSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, areaLightSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, gpuAreaLights.size() * sizeof(GPUAreaLight), gpuAreaLights.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, areaLightSSBO);
+
+	// the light list of every tile, filled by the culling
+	const int tilesX = (SCR_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+	const int tilesY = (SCR_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+	GLuint tileLightSSBO;
+	glGenBuffers(1, &tileLightSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileLightSSBO);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)tilesX * tilesY * (MAX_AREA_LIGHTS + 1) * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, tileLightSSBO);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// depth pre-pass framebuffer, the culling bounds every tile's depth with it
+	GLuint depthFBO, depthMap;
+	glGenFramebuffers(1, &depthFBO);
+	glGenTextures(1, &depthMap);
+	glBindTexture(GL_TEXTURE_2D, depthMap);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, SCR_WIDTH, SCR_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, depthFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthMap, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Depth pre-pass framebuffer is not complete!" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	shaderLightCulling.use();
+	shaderLightCulling.setInt("depthMap", 3);
+
+    shaderLTC.use();
+	shaderLTC.setInt("tilesX", tilesX);
+	shaderLTC.setFloat("lightRange", LIGHT_RANGE);
 	shaderLTC.setInt("LTC1", 0);
 	shaderLTC.setInt("LTC2", 1);
 	shaderLTC.setInt("material.diffuse", 2);
@@ -385,6 +402,14 @@ int main()
 	GLuint64 totalQueryTimeNs = 0;
 	GLuint64 numQueries = 0;
 
+	// culling time (depth pre-pass and culling dispatch), averaged with the shading time over 120 frames
+	GLuint cullingQuery;
+	glGenQueries(1, &cullingQuery);
+	GLuint64 cullingTimeNs = 0, shadingTimeNs = 0;
+
+	std::cout << "Press C to toggle the tiled light culling, Q/E to halve/double the lights, B to time both paths with 1 to "
+	          << MAX_AREA_LIGHTS << " lights" << std::endl;
+
 
     // RENDER LOOP
     while (!glfwWindowShouldClose(window))
@@ -396,31 +421,115 @@ int main()
         glfwPollEvents();
 		do_movement(deltaTime);
 
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        shaderLTC.use();
         glm::mat4 model(1.0f);
 		glm::mat3 normalMatrix = glm::mat3(model);
-		shaderLTC.setMat4("model", model);
-		shaderLTC.setMat3("normalMatrix", normalMatrix);
 		glm::mat4 view = camera.GetViewMatrix();
-		shaderLTC.setMat4("view", view);
 		glm::mat4 projection = glm::perspective(
 			glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		shaderLTC.setMat4("projection", projection);
-		shaderLTC.setVec3("viewPosition", camera.Position);
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mLTC.mat1);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, mLTC.mat2);
-		glActiveTexture(GL_TEXTURE2);
-		glBindTexture(GL_TEXTURE_2D, concreteTexture);
+		// depth pre-pass and tiled light culling
+		auto cullLights = [&](bool tiled) {
+			if (!tiled)
+				return;
+			glBindFramebuffer(GL_FRAMEBUFFER, depthFBO);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			shaderDepthPrepass.use();
+			shaderDepthPrepass.setMat4("model", model);
+			shaderDepthPrepass.setMat3("normalMatrix", normalMatrix);
+			shaderDepthPrepass.setMat4("view", view);
+			shaderDepthPrepass.setMat4("projection", projection);
+			renderPlane();
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+			shaderLightCulling.use();
+			shaderLightCulling.setMat4("view", view);
+			glUniformMatrix4fv(glGetUniformLocation(shaderLightCulling.ID, "inverseProjection"), 1, GL_FALSE, glm::value_ptr(glm::inverse(projection)));
+			shaderLightCulling.setInt("numAreaLights", numAreaLights);
+			glActiveTexture(GL_TEXTURE3);
+			glBindTexture(GL_TEXTURE_2D, depthMap);
+			glDispatchCompute(tilesX, tilesY, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		};
+		// shading of the plane by the lights of its tiles or all lights
+		auto shadePlane = [&](bool tiled) {
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			shaderLTC.use();
+			shaderLTC.setMat4("model", model);
+			shaderLTC.setMat3("normalMatrix", normalMatrix);
+			shaderLTC.setMat4("view", view);
+			shaderLTC.setMat4("projection", projection);
+			shaderLTC.setVec3("viewPosition", camera.Position);
+			shaderLTC.setInt("numAreaLights", numAreaLights);
+			shaderLTC.setBool("tiledCulling", tiled);
+
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, mLTC.LTC1);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, mLTC.LTC2);
+			glActiveTexture(GL_TEXTURE2);
+			glBindTexture(GL_TEXTURE_2D, concreteTexture);
+			renderPlane();
+		};
+
+		// benchmark: both paths with 1 to MAX_AREA_LIGHTS lights, on the current view
+		if (benchmarkLights)
+		{
+			benchmarkLights = false;
+			const int REPEATS = 20;
+			int lightCount = numAreaLights;
+			for (numAreaLights = 1; numAreaLights <= MAX_AREA_LIGHTS; numAreaLights *= 2)
+			{
+				double times[2][2];
+				for (int tiled = 0; tiled < 2; tiled++)
+				{
+					GLuint64 elapsed[2] = { 0, 0 };
+					for (int i = 0; i < REPEATS; i++)
+					{
+						glBeginQuery(GL_TIME_ELAPSED, cullingQuery);
+						cullLights(tiled);
+						glEndQuery(GL_TIME_ELAPSED);
+						glBeginQuery(GL_TIME_ELAPSED, timeQuery);
+						shadePlane(tiled);
+						glEndQuery(GL_TIME_ELAPSED);
+						GLuint64 culling = 0, shading = 0;
+						glGetQueryObjectui64v(cullingQuery, GL_QUERY_RESULT, &culling);
+						glGetQueryObjectui64v(timeQuery, GL_QUERY_RESULT, &shading);
+						elapsed[0] += culling;
+						elapsed[1] += shading;
+					}
+					times[tiled][0] = elapsed[0] * 1.0e-6 / REPEATS;
+					times[tiled][1] = elapsed[1] * 1.0e-6 / REPEATS;
+				}
+
+				// how many lights the tiles of the last culling kept
+				std::vector<GLuint> tileLights((size_t)tilesX * tilesY * (MAX_AREA_LIGHTS + 1));
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileLightSSBO);
+				glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, tileLights.size() * sizeof(GLuint), tileLights.data());
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+				GLuint maxTileLights = 0, sumTileLights = 0;
+				for (int tile = 0; tile < tilesX * tilesY; tile++)
+				{
+					GLuint count = tileLights[(size_t)tile * (MAX_AREA_LIGHTS + 1)];
+					maxTileLights = std::max(maxTileLights, count);
+					sumTileLights += count;
+				}
+
+				std::cout << numAreaLights << " lights: all lights " << times[0][1] << " ms, tiled " << times[1][0] << " ms culling + "
+				          << times[1][1] << " ms shading (" << (float)sumTileLights / (tilesX * tilesY) << " lights per tile on average, "
+				          << maxTileLights << " at most)" << std::endl;
+			}
+			numAreaLights = lightCount;
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED, cullingQuery);
+		cullLights(tiledCulling);
+		glEndQuery(GL_TIME_ELAPSED);
 
 		// measure time
 		glBeginQuery(GL_TIME_ELAPSED, timeQuery);
-		renderPlane();
+		shadePlane(tiledCulling);
 		glEndQuery(GL_TIME_ELAPSED);
 
 		glUseProgram(0);
@@ -430,7 +539,7 @@ int main()
 		shaderLightPlane.setMat4("view", view);
 		shaderLightPlane.setMat4("projection", projection);
 		float sinNowTime = glm::sin(currentFrame);
-		for (int i = 0; i < NUM_AREA_LIGHTS; i++)
+		for (int i = 0; i < numAreaLights; i++)
 		{
 			model = glm::mat4(1.0f);
 			model = glm::translate(model, areaLights[i].offset);
@@ -447,6 +556,17 @@ int main()
 		numQueries++;
 		totalQueryTimeNs += elapsed;
 
+		GLuint64 culling = 0;
+		glGetQueryObjectui64v(cullingQuery, GL_QUERY_RESULT, &culling);
+		cullingTimeNs += culling;
+		shadingTimeNs += elapsed;
+		if (numQueries % 120 == 0)
+		{
+			std::cout << numAreaLights << " lights, " << (tiledCulling ? "tiled" : "all lights") << ": culling "
+			          << cullingTimeNs * 1.0e-6 / 120 << " ms, shading " << shadingTimeNs * 1.0e-6 / 120 << " ms" << std::endl;
+			cullingTimeNs = shadingTimeNs = 0;
+		}
+
         glfwSwapBuffers(window);
     }
 
@@ -456,10 +576,17 @@ int main()
 	std::cout << "Total average time(ms) = " << measuredAverageMs << '\n';
 
 	glDeleteQueries(1, &timeQuery);
+	glDeleteQueries(1, &cullingQuery);
+	glDeleteBuffers(1, &areaLightSSBO);
+	glDeleteBuffers(1, &tileLightSSBO);
+	glDeleteFramebuffers(1, &depthFBO);
+	glDeleteTextures(1, &depthMap);
     glDeleteVertexArrays(1, &planeVAO);
     glDeleteBuffers(1, &planeVBO);
     glDeleteVertexArrays(1, &areaLightVAO);
     glDeleteBuffers(1, &areaLightVBO);
+    glDeleteTextures(1, &mLTC.LTC1);
+    glDeleteTextures(1, &mLTC.LTC2);
 
     glfwTerminate();
     return 0;
@@ -508,6 +635,20 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
         case GLFW_KEY_ESCAPE:
             glfwSetWindowShouldClose(window, GL_TRUE);
             return;
+        case GLFW_KEY_C:
+            tiledCulling = !tiledCulling;
+            break;
+        case GLFW_KEY_Q:
+            numAreaLights = std::max(numAreaLights / 2, 1);
+            std::cout << numAreaLights << " lights" << std::endl;
+            break;
+        case GLFW_KEY_E:
+            numAreaLights = std::min(numAreaLights * 2, MAX_AREA_LIGHTS);
+            std::cout << numAreaLights << " lights" << std::endl;
+            break;
+        case GLFW_KEY_B:
+            benchmarkLights = true;
+            break;
         // case GLFW_KEY_B:
 	    //     switchTwoSided(true);
 	    //     break;
@@ -0,0 +1,27 @@
+//
+// Packs the LTC tables of ltc_matrix.hpp into the binary file the area light
+// samples load at runtime, so only this tool compiles the 8000 lines of floats.
+//
+// usage: ltc_pack [output file]
+// by default writes resources/textures/ltc/ltc_tables.bin
+//
+
+// LEARNOPENGL
+#include <learnopengl/filesystem.h>
+#include <learnopengl/ltc_tables.h>
+
+// STANDARD
+#include <iostream>
+#include <string>
+
+// CUSTOM
+#include "../ltc_matrix.hpp"
+
+int main(int argc, char *argv[])
+{
+    std::string path = argc > 1 ? argv[1] : FileSystem::getPath("resources/textures/ltc/ltc_tables.bin");
+    if (!LTCTables::Save(path, LTC1, LTC2))
+        return -1;
+    std::cout << "wrote " << path << std::endl;
+    return 0;
+}
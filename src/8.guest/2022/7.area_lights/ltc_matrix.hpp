@@ -1,5 +1,7 @@
 #pragma once
 
+// only compiled by 3.ltc_pack, which writes these tables to resources/textures/ltc/ltc_tables.bin for the samples
+
 // LTC1 is the inverse M
 // LTC2 is for (GGX norm, fresnel, 0(unused), sphere for horizon-clipping)
 